@@ -12,6 +12,7 @@
 #   include <omp.h>
 #else
 #   define omp_get_thread_num() (0)
+#   define omp_in_parallel() (0)
 #endif
 
 /* Aliasing for compiler optimizations */
@@ -63,6 +64,7 @@ struct VectorConstructorArgs {
 };
 
 bool check_is_sorted(int* vec, size_t n);
+const int* find_col_in_row(const int *st, const int *end, const int col);
 bool check_is_seq(Rcpp::IntegerVector indices);
 void check_and_sort_single_row_inplace
 (
@@ -74,10 +76,38 @@ void check_and_sort_single_row_inplace
     const bool pre_check
 );
 SEXP SafeRcppVector(void *args_);
+bool check_indices_are_sorted(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, int nthreads);
+bool have_same_sparsity_pattern(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2,
+                                Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2);
 bool is_same_ngRMatrix(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2,
                        Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2);
 bool contains_any_nas_or_inf(Rcpp::NumericVector x);
 
+/* profile.cpp */
+class KernelProfiler {
+public:
+    KernelProfiler(const char *name);
+    ~KernelProfiler();
+private:
+    const char *name;
+    const bool active;
+    double bytes_start = 0;
+    std::chrono::steady_clock::time_point time_start;
+};
+void profile_count_bytes(const size_t bytes);
+void profile_count_allocation(SEXP x);
+#define profile_kernel(name) KernelProfiler kernel_profiler_(name)
+
+/* threads.cpp */
+/* Minimum amount of work per thread (number of multiply-adds) for each
+   type of kernel, below which they will use fewer threads or run serially.
+   See 'get_effective_nthreads' for more details. */
+constexpr const double min_work_per_thread_gemm = 65536;
+constexpr const double min_work_per_thread_sddmm = 65536;
+constexpr const double min_work_per_thread_matvec = 32768;
+constexpr const double min_work_per_thread_spgemm = 32768;
+int get_effective_nthreads(int nthreads, const double work, const double min_work_per_thread);
+
 /* rbind.cpp */
 enum RbindedType {dgRMatrix, lgRMatrix, ngRMatrix};
 
@@ -100,6 +130,26 @@ int extract_single_val_csr
     const bool is_sorted
 );
 
+/* mmap.cpp */
+enum MappedValuesType {MappedBinary = 0, MappedNumeric = 1, MappedLogical = 2};
+struct MappedCSR {
+    void *addr = nullptr;
+    size_t size = 0;
+    void *file_handle = nullptr;
+    void *map_handle = nullptr;
+    int nrows = 0;
+    int ncols = 0;
+    size_t nnz = 0;
+    MappedValuesType values_type = MappedBinary;
+    const int *indptr = nullptr;
+    const int *indices = nullptr;
+    const void *values = nullptr;
+    bool indices_checked = false;
+};
+MappedCSR* get_mapped_csr(SEXP ptr);
+void check_mapped_indices(const MappedCSR *mapped, const int *indices, const size_t n);
+void check_all_mapped_indices(MappedCSR *mapped);
+
 #if SIZE_MAX < MAX_UINT64
 #   define size_large uint64_t
 #else
@@ -250,8 +250,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // set_arbitrary_cols_to_zero
-Rcpp::List set_arbitrary_cols_to_zero(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector cols_set, const int ncols);
-RcppExport SEXP _MatrixExtra_set_arbitrary_cols_to_zero(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP cols_setSEXP, SEXP ncolsSEXP) {
+Rcpp::List set_arbitrary_cols_to_zero(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector cols_set, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_set_arbitrary_cols_to_zero(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP cols_setSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
@@ -259,13 +259,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type cols_set(cols_setSEXP);
     Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
-    rcpp_result_gen = Rcpp::wrap(set_arbitrary_cols_to_zero(indptr, indices, values, cols_set, ncols));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_arbitrary_cols_to_zero(indptr, indices, values, cols_set, ncols, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // set_arbitrary_cols_to_const
-Rcpp::List set_arbitrary_cols_to_const(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector cols_set, const int ncols, const double val_set);
-RcppExport SEXP _MatrixExtra_set_arbitrary_cols_to_const(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP cols_setSEXP, SEXP ncolsSEXP, SEXP val_setSEXP) {
+Rcpp::List set_arbitrary_cols_to_const(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector cols_set, const int ncols, const double val_set, int nthreads);
+RcppExport SEXP _MatrixExtra_set_arbitrary_cols_to_const(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP cols_setSEXP, SEXP ncolsSEXP, SEXP val_setSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
@@ -274,7 +275,8 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type cols_set(cols_setSEXP);
     Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
     Rcpp::traits::input_parameter< const double >::type val_set(val_setSEXP);
-    rcpp_result_gen = Rcpp::wrap(set_arbitrary_cols_to_const(indptr, indices, values, cols_set, ncols, val_set));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_arbitrary_cols_to_const(indptr, indices, values, cols_set, ncols, val_set, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -341,8 +343,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // set_arbitrary_rows_arbitrary_cols_to_zero
-Rcpp::List set_arbitrary_rows_arbitrary_cols_to_zero(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector rows_set, Rcpp::IntegerVector cols_set, const int ncols);
-RcppExport SEXP _MatrixExtra_set_arbitrary_rows_arbitrary_cols_to_zero(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_setSEXP, SEXP cols_setSEXP, SEXP ncolsSEXP) {
+Rcpp::List set_arbitrary_rows_arbitrary_cols_to_zero(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector rows_set, Rcpp::IntegerVector cols_set, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_set_arbitrary_rows_arbitrary_cols_to_zero(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_setSEXP, SEXP cols_setSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
@@ -351,13 +353,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type rows_set(rows_setSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type cols_set(cols_setSEXP);
     Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
-    rcpp_result_gen = Rcpp::wrap(set_arbitrary_rows_arbitrary_cols_to_zero(indptr, indices, values, rows_set, cols_set, ncols));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_arbitrary_rows_arbitrary_cols_to_zero(indptr, indices, values, rows_set, cols_set, ncols, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // set_arbitrary_rows_arbitrary_cols_to_const
-Rcpp::List set_arbitrary_rows_arbitrary_cols_to_const(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector rows_set, Rcpp::IntegerVector cols_set, const int ncols, const double val_set);
-RcppExport SEXP _MatrixExtra_set_arbitrary_rows_arbitrary_cols_to_const(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_setSEXP, SEXP cols_setSEXP, SEXP ncolsSEXP, SEXP val_setSEXP) {
+Rcpp::List set_arbitrary_rows_arbitrary_cols_to_const(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector rows_set, Rcpp::IntegerVector cols_set, const int ncols, const double val_set, int nthreads);
+RcppExport SEXP _MatrixExtra_set_arbitrary_rows_arbitrary_cols_to_const(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_setSEXP, SEXP cols_setSEXP, SEXP ncolsSEXP, SEXP val_setSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
@@ -367,7 +370,8 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type cols_set(cols_setSEXP);
     Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
     Rcpp::traits::input_parameter< const double >::type val_set(val_setSEXP);
-    rcpp_result_gen = Rcpp::wrap(set_arbitrary_rows_arbitrary_cols_to_const(indptr, indices, values, rows_set, cols_set, ncols, val_set));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_arbitrary_rows_arbitrary_cols_to_const(indptr, indices, values, rows_set, cols_set, ncols, val_set, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -404,6 +408,37 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// set_csr_entries_from_csr
+Rcpp::List set_csr_entries_from_csr(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector indptr_upd, Rcpp::IntegerVector indices_upd, Rcpp::NumericVector values_upd, int nthreads);
+RcppExport SEXP _MatrixExtra_set_csr_entries_from_csr(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP indptr_updSEXP, SEXP indices_updSEXP, SEXP values_updSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr_upd(indptr_updSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices_upd(indices_updSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values_upd(values_updSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_csr_entries_from_csr(indptr, indices, values, indptr_upd, indices_upd, values_upd, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// set_diag_csr_existing
+SEXP set_diag_csr_existing(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::NumericVector diag_values, const int ndiag, int nthreads);
+RcppExport SEXP _MatrixExtra_set_diag_csr_existing(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP diag_valuesSEXP, SEXP ndiagSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type diag_values(diag_valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ndiag(ndiagSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_diag_csr_existing(indptr, indices, values, diag_values, ndiag, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // check_shapes_are_assignable_2d
 bool check_shapes_are_assignable_2d(double x1, double x2, double y1, double y2);
 RcppExport SEXP _MatrixExtra_check_shapes_are_assignable_2d(SEXP x1SEXP, SEXP x2SEXP, SEXP y1SEXP, SEXP y2SEXP) {
@@ -484,6 +519,18 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// concat_csr_batch_cols
+Rcpp::S4 concat_csr_batch_cols(Rcpp::ListOf<Rcpp::S4> objects, Rcpp::S4 out, int nthreads);
+RcppExport SEXP _MatrixExtra_concat_csr_batch_cols(SEXP objectsSEXP, SEXP outSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::ListOf<Rcpp::S4> >::type objects(objectsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::S4 >::type out(outSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(concat_csr_batch_cols(objects, out, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // matmul_dense_csc_numeric
 Rcpp::NumericMatrix matmul_dense_csc_numeric(Rcpp::NumericMatrix X_colmajor, Rcpp::IntegerVector Y_csc_indptr, Rcpp::IntegerVector Y_csc_indices, Rcpp::NumericVector Y_csc_values, int nthreads);
 RcppExport SEXP _MatrixExtra_matmul_dense_csc_numeric(SEXP X_colmajorSEXP, SEXP Y_csc_indptrSEXP, SEXP Y_csc_indicesSEXP, SEXP Y_csc_valuesSEXP, SEXP nthreadsSEXP) {
@@ -570,6 +617,34 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// sddmm_csr_numeric
+Rcpp::NumericVector sddmm_csr_numeric(Rcpp::IntegerVector mask_csr_indptr, Rcpp::IntegerVector mask_csr_indices, Rcpp::NumericMatrix At_colmajor, Rcpp::NumericMatrix Bt_colmajor, int nthreads);
+RcppExport SEXP _MatrixExtra_sddmm_csr_numeric(SEXP mask_csr_indptrSEXP, SEXP mask_csr_indicesSEXP, SEXP At_colmajorSEXP, SEXP Bt_colmajorSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type mask_csr_indptr(mask_csr_indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type mask_csr_indices(mask_csr_indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type At_colmajor(At_colmajorSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type Bt_colmajor(Bt_colmajorSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(sddmm_csr_numeric(mask_csr_indptr, mask_csr_indices, At_colmajor, Bt_colmajor, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// sddmm_csr_float32
+Rcpp::NumericVector sddmm_csr_float32(Rcpp::IntegerVector mask_csr_indptr, Rcpp::IntegerVector mask_csr_indices, Rcpp::IntegerMatrix At_colmajor, Rcpp::IntegerMatrix Bt_colmajor, int nthreads);
+RcppExport SEXP _MatrixExtra_sddmm_csr_float32(SEXP mask_csr_indptrSEXP, SEXP mask_csr_indicesSEXP, SEXP At_colmajorSEXP, SEXP Bt_colmajorSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type mask_csr_indptr(mask_csr_indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type mask_csr_indices(mask_csr_indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerMatrix >::type At_colmajor(At_colmajorSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerMatrix >::type Bt_colmajor(Bt_colmajorSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(sddmm_csr_float32(mask_csr_indptr, mask_csr_indices, At_colmajor, Bt_colmajor, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // matmul_csr_dvec_numeric
 Rcpp::NumericVector matmul_csr_dvec_numeric(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, Rcpp::NumericVector X_csr_values, Rcpp::NumericVector y_dense, int nthreads);
 RcppExport SEXP _MatrixExtra_matmul_csr_dvec_numeric(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_denseSEXP, SEXP nthreadsSEXP) {
@@ -626,9 +701,21 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// matmul_csr_dvec_mmap
+Rcpp::NumericVector matmul_csr_dvec_mmap(SEXP mapped_ptr, Rcpp::NumericVector y_dense, int nthreads);
+RcppExport SEXP _MatrixExtra_matmul_csr_dvec_mmap(SEXP mapped_ptrSEXP, SEXP y_denseSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type mapped_ptr(mapped_ptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type y_dense(y_denseSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(matmul_csr_dvec_mmap(mapped_ptr, y_dense, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // matmul_csr_svec_numeric
-Rcpp::NumericVector matmul_csr_svec_numeric(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, Rcpp::NumericVector X_csr_values, Rcpp::IntegerVector y_indices_base1, Rcpp::NumericVector y_values, int nthreads);
-RcppExport SEXP _MatrixExtra_matmul_csr_svec_numeric(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP y_valuesSEXP, SEXP nthreadsSEXP) {
+Rcpp::NumericVector matmul_csr_svec_numeric(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, Rcpp::NumericVector X_csr_values, Rcpp::IntegerVector y_indices_base1, Rcpp::NumericVector y_values, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_matmul_csr_svec_numeric(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP y_valuesSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indptr(X_csr_indptrSEXP);
@@ -636,14 +723,15 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type X_csr_values(X_csr_valuesSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type y_indices_base1(y_indices_base1SEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type y_values(y_valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
     Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
-    rcpp_result_gen = Rcpp::wrap(matmul_csr_svec_numeric(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, y_values, nthreads));
+    rcpp_result_gen = Rcpp::wrap(matmul_csr_svec_numeric(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, y_values, ncols, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // matmul_csr_svec_integer
-Rcpp::NumericVector matmul_csr_svec_integer(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, Rcpp::NumericVector X_csr_values, Rcpp::IntegerVector y_indices_base1, Rcpp::IntegerVector y_values, int nthreads);
-RcppExport SEXP _MatrixExtra_matmul_csr_svec_integer(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP y_valuesSEXP, SEXP nthreadsSEXP) {
+Rcpp::NumericVector matmul_csr_svec_integer(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, Rcpp::NumericVector X_csr_values, Rcpp::IntegerVector y_indices_base1, Rcpp::IntegerVector y_values, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_matmul_csr_svec_integer(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP y_valuesSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indptr(X_csr_indptrSEXP);
@@ -651,14 +739,15 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type X_csr_values(X_csr_valuesSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type y_indices_base1(y_indices_base1SEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type y_values(y_valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
     Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
-    rcpp_result_gen = Rcpp::wrap(matmul_csr_svec_integer(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, y_values, nthreads));
+    rcpp_result_gen = Rcpp::wrap(matmul_csr_svec_integer(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, y_values, ncols, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // matmul_csr_svec_logical
-Rcpp::NumericVector matmul_csr_svec_logical(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, Rcpp::NumericVector X_csr_values, Rcpp::IntegerVector y_indices_base1, Rcpp::LogicalVector y_values, int nthreads);
-RcppExport SEXP _MatrixExtra_matmul_csr_svec_logical(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP y_valuesSEXP, SEXP nthreadsSEXP) {
+Rcpp::NumericVector matmul_csr_svec_logical(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, Rcpp::NumericVector X_csr_values, Rcpp::IntegerVector y_indices_base1, Rcpp::LogicalVector y_values, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_matmul_csr_svec_logical(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP y_valuesSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indptr(X_csr_indptrSEXP);
@@ -666,28 +755,30 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type X_csr_values(X_csr_valuesSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type y_indices_base1(y_indices_base1SEXP);
     Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type y_values(y_valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
     Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
-    rcpp_result_gen = Rcpp::wrap(matmul_csr_svec_logical(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, y_values, nthreads));
+    rcpp_result_gen = Rcpp::wrap(matmul_csr_svec_logical(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, y_values, ncols, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // matmul_csr_svec_binary
-Rcpp::NumericVector matmul_csr_svec_binary(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, Rcpp::NumericVector X_csr_values, Rcpp::IntegerVector y_indices_base1, int nthreads);
-RcppExport SEXP _MatrixExtra_matmul_csr_svec_binary(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP nthreadsSEXP) {
+Rcpp::NumericVector matmul_csr_svec_binary(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, Rcpp::NumericVector X_csr_values, Rcpp::IntegerVector y_indices_base1, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_matmul_csr_svec_binary(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indptr(X_csr_indptrSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indices(X_csr_indicesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type X_csr_values(X_csr_valuesSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type y_indices_base1(y_indices_base1SEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
     Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
-    rcpp_result_gen = Rcpp::wrap(matmul_csr_svec_binary(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, nthreads));
+    rcpp_result_gen = Rcpp::wrap(matmul_csr_svec_binary(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, ncols, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // matmul_csr_svec_float32
-Rcpp::NumericVector matmul_csr_svec_float32(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, Rcpp::NumericVector X_csr_values, Rcpp::IntegerVector y_indices_base1, Rcpp::IntegerVector y_values, int nthreads);
-RcppExport SEXP _MatrixExtra_matmul_csr_svec_float32(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP y_valuesSEXP, SEXP nthreadsSEXP) {
+Rcpp::NumericVector matmul_csr_svec_float32(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, Rcpp::NumericVector X_csr_values, Rcpp::IntegerVector y_indices_base1, Rcpp::IntegerVector y_values, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_matmul_csr_svec_float32(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP y_valuesSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indptr(X_csr_indptrSEXP);
@@ -695,8 +786,68 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type X_csr_values(X_csr_valuesSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type y_indices_base1(y_indices_base1SEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type y_values(y_valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
     Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
-    rcpp_result_gen = Rcpp::wrap(matmul_csr_svec_float32(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, y_values, nthreads));
+    rcpp_result_gen = Rcpp::wrap(matmul_csr_svec_float32(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, y_values, ncols, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// crossprod_csr_svec_numeric
+Rcpp::List crossprod_csr_svec_numeric(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, SEXP X_csr_values, Rcpp::IntegerVector y_indices_base1, Rcpp::NumericVector y_values, const int ncols);
+RcppExport SEXP _MatrixExtra_crossprod_csr_svec_numeric(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP y_valuesSEXP, SEXP ncolsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indptr(X_csr_indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indices(X_csr_indicesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type X_csr_values(X_csr_valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type y_indices_base1(y_indices_base1SEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type y_values(y_valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    rcpp_result_gen = Rcpp::wrap(crossprod_csr_svec_numeric(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, y_values, ncols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// crossprod_csr_svec_integer
+Rcpp::List crossprod_csr_svec_integer(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, SEXP X_csr_values, Rcpp::IntegerVector y_indices_base1, Rcpp::IntegerVector y_values, const int ncols);
+RcppExport SEXP _MatrixExtra_crossprod_csr_svec_integer(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP y_valuesSEXP, SEXP ncolsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indptr(X_csr_indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indices(X_csr_indicesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type X_csr_values(X_csr_valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type y_indices_base1(y_indices_base1SEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type y_values(y_valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    rcpp_result_gen = Rcpp::wrap(crossprod_csr_svec_integer(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, y_values, ncols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// crossprod_csr_svec_logical
+Rcpp::List crossprod_csr_svec_logical(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, SEXP X_csr_values, Rcpp::IntegerVector y_indices_base1, Rcpp::LogicalVector y_values, const int ncols);
+RcppExport SEXP _MatrixExtra_crossprod_csr_svec_logical(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP y_valuesSEXP, SEXP ncolsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indptr(X_csr_indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indices(X_csr_indicesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type X_csr_values(X_csr_valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type y_indices_base1(y_indices_base1SEXP);
+    Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type y_values(y_valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    rcpp_result_gen = Rcpp::wrap(crossprod_csr_svec_logical(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, y_values, ncols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// crossprod_csr_svec_binary
+Rcpp::List crossprod_csr_svec_binary(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, SEXP X_csr_values, Rcpp::IntegerVector y_indices_base1, const int ncols);
+RcppExport SEXP _MatrixExtra_crossprod_csr_svec_binary(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP y_indices_base1SEXP, SEXP ncolsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indptr(X_csr_indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indices(X_csr_indicesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type X_csr_values(X_csr_valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type y_indices_base1(y_indices_base1SEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    rcpp_result_gen = Rcpp::wrap(crossprod_csr_svec_binary(X_csr_indptr, X_csr_indices, X_csr_values, y_indices_base1, ncols));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -810,6 +961,38 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// matmul_csr_csr_numeric
+Rcpp::List matmul_csr_csr_numeric(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, Rcpp::NumericVector X_csr_values, Rcpp::IntegerVector Y_csr_indptr, Rcpp::IntegerVector Y_csr_indices, Rcpp::NumericVector Y_csr_values, const int ncols_Y, int nthreads);
+RcppExport SEXP _MatrixExtra_matmul_csr_csr_numeric(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP X_csr_valuesSEXP, SEXP Y_csr_indptrSEXP, SEXP Y_csr_indicesSEXP, SEXP Y_csr_valuesSEXP, SEXP ncols_YSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indptr(X_csr_indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indices(X_csr_indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type X_csr_values(X_csr_valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type Y_csr_indptr(Y_csr_indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type Y_csr_indices(Y_csr_indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type Y_csr_values(Y_csr_valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols_Y(ncols_YSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(matmul_csr_csr_numeric(X_csr_indptr, X_csr_indices, X_csr_values, Y_csr_indptr, Y_csr_indices, Y_csr_values, ncols_Y, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// matmul_csr_csr_binary
+Rcpp::List matmul_csr_csr_binary(Rcpp::IntegerVector X_csr_indptr, Rcpp::IntegerVector X_csr_indices, Rcpp::IntegerVector Y_csr_indptr, Rcpp::IntegerVector Y_csr_indices, const int ncols_Y, int nthreads);
+RcppExport SEXP _MatrixExtra_matmul_csr_csr_binary(SEXP X_csr_indptrSEXP, SEXP X_csr_indicesSEXP, SEXP Y_csr_indptrSEXP, SEXP Y_csr_indicesSEXP, SEXP ncols_YSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indptr(X_csr_indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indices(X_csr_indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type Y_csr_indptr(Y_csr_indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type Y_csr_indices(Y_csr_indicesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols_Y(ncols_YSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(matmul_csr_csr_binary(X_csr_indptr, X_csr_indices, Y_csr_indptr, Y_csr_indices, ncols_Y, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // contains_any_zero
 bool contains_any_zero(Rcpp::NumericVector x);
 RcppExport SEXP _MatrixExtra_contains_any_zero(SEXP xSEXP) {
@@ -873,70 +1056,76 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
-// check_indices_are_unsorted
-bool check_indices_are_unsorted(Rcpp::IntegerVector indptr, Rcpp::NumericVector indices);
-RcppExport SEXP _MatrixExtra_check_indices_are_unsorted(SEXP indptrSEXP, SEXP indicesSEXP) {
+// check_indices_are_sorted
+bool check_indices_are_sorted(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, int nthreads);
+RcppExport SEXP _MatrixExtra_check_indices_are_sorted(SEXP indptrSEXP, SEXP indicesSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
-    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type indices(indicesSEXP);
-    rcpp_result_gen = Rcpp::wrap(check_indices_are_unsorted(indptr, indices));
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(check_indices_are_sorted(indptr, indices, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // sort_sparse_indices_numeric
-void sort_sparse_indices_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values);
-RcppExport SEXP _MatrixExtra_sort_sparse_indices_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP) {
+void sort_sparse_indices_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, int nthreads);
+RcppExport SEXP _MatrixExtra_sort_sparse_indices_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
-    sort_sparse_indices_numeric(indptr, indices, values);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    sort_sparse_indices_numeric(indptr, indices, values, nthreads);
     return R_NilValue;
 END_RCPP
 }
 // sort_sparse_indices_logical
-void sort_sparse_indices_logical(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values);
-RcppExport SEXP _MatrixExtra_sort_sparse_indices_logical(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP) {
+void sort_sparse_indices_logical(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, int nthreads);
+RcppExport SEXP _MatrixExtra_sort_sparse_indices_logical(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
     Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values(valuesSEXP);
-    sort_sparse_indices_logical(indptr, indices, values);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    sort_sparse_indices_logical(indptr, indices, values, nthreads);
     return R_NilValue;
 END_RCPP
 }
 // sort_sparse_indices_numeric_known_ncol
-void sort_sparse_indices_numeric_known_ncol(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, int ncol);
-RcppExport SEXP _MatrixExtra_sort_sparse_indices_numeric_known_ncol(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP ncolSEXP) {
+void sort_sparse_indices_numeric_known_ncol(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, int ncol, int nthreads);
+RcppExport SEXP _MatrixExtra_sort_sparse_indices_numeric_known_ncol(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP ncolSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
     Rcpp::traits::input_parameter< int >::type ncol(ncolSEXP);
-    sort_sparse_indices_numeric_known_ncol(indptr, indices, values, ncol);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    sort_sparse_indices_numeric_known_ncol(indptr, indices, values, ncol, nthreads);
     return R_NilValue;
 END_RCPP
 }
 // sort_sparse_indices_logical_known_ncol
-void sort_sparse_indices_logical_known_ncol(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, int ncol);
-RcppExport SEXP _MatrixExtra_sort_sparse_indices_logical_known_ncol(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP ncolSEXP) {
+void sort_sparse_indices_logical_known_ncol(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, int ncol, int nthreads);
+RcppExport SEXP _MatrixExtra_sort_sparse_indices_logical_known_ncol(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP ncolSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
     Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values(valuesSEXP);
     Rcpp::traits::input_parameter< int >::type ncol(ncolSEXP);
-    sort_sparse_indices_logical_known_ncol(indptr, indices, values, ncol);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    sort_sparse_indices_logical_known_ncol(indptr, indices, values, ncol, nthreads);
     return R_NilValue;
 END_RCPP
 }
 // sort_sparse_indices_binary
-void sort_sparse_indices_binary(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices);
-RcppExport SEXP _MatrixExtra_sort_sparse_indices_binary(SEXP indptrSEXP, SEXP indicesSEXP) {
+void sort_sparse_indices_binary(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, int nthreads);
+RcppExport SEXP _MatrixExtra_sort_sparse_indices_binary(SEXP indptrSEXP, SEXP indicesSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
-    sort_sparse_indices_binary(indptr, indices);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    sort_sparse_indices_binary(indptr, indices, nthreads);
     return R_NilValue;
 END_RCPP
 }
@@ -1187,9 +1376,38 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// mmap_csr_open_file
+SEXP mmap_csr_open_file(std::string fname);
+RcppExport SEXP _MatrixExtra_mmap_csr_open_file(SEXP fnameSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< std::string >::type fname(fnameSEXP);
+    rcpp_result_gen = Rcpp::wrap(mmap_csr_open_file(fname));
+    return rcpp_result_gen;
+END_RCPP
+}
+// mmap_csr_close_file
+void mmap_csr_close_file(SEXP ptr);
+RcppExport SEXP _MatrixExtra_mmap_csr_close_file(SEXP ptrSEXP) {
+BEGIN_RCPP
+    Rcpp::traits::input_parameter< SEXP >::type ptr(ptrSEXP);
+    mmap_csr_close_file(ptr);
+    return R_NilValue;
+END_RCPP
+}
+// mmap_csr_get_info
+Rcpp::List mmap_csr_get_info(SEXP ptr);
+RcppExport SEXP _MatrixExtra_mmap_csr_get_info(SEXP ptrSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type ptr(ptrSEXP);
+    rcpp_result_gen = Rcpp::wrap(mmap_csr_get_info(ptr));
+    return rcpp_result_gen;
+END_RCPP
+}
 // multiply_csr_elemwise
-Rcpp::List multiply_csr_elemwise(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2, Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2, Rcpp::NumericVector values1, Rcpp::NumericVector values2);
-RcppExport SEXP _MatrixExtra_multiply_csr_elemwise(SEXP indptr1SEXP, SEXP indptr2SEXP, SEXP indices1SEXP, SEXP indices2SEXP, SEXP values1SEXP, SEXP values2SEXP) {
+Rcpp::List multiply_csr_elemwise(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2, Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2, Rcpp::NumericVector values1, Rcpp::NumericVector values2, int nthreads);
+RcppExport SEXP _MatrixExtra_multiply_csr_elemwise(SEXP indptr1SEXP, SEXP indptr2SEXP, SEXP indices1SEXP, SEXP indices2SEXP, SEXP values1SEXP, SEXP values2SEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr1(indptr1SEXP);
@@ -1198,13 +1416,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices2(indices2SEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values1(values1SEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values2(values2SEXP);
-    rcpp_result_gen = Rcpp::wrap(multiply_csr_elemwise(indptr1, indptr2, indices1, indices2, values1, values2));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(multiply_csr_elemwise(indptr1, indptr2, indices1, indices2, values1, values2, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // logicaland_csr_elemwise
-Rcpp::List logicaland_csr_elemwise(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2, Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2, Rcpp::LogicalVector values1, Rcpp::LogicalVector values2);
-RcppExport SEXP _MatrixExtra_logicaland_csr_elemwise(SEXP indptr1SEXP, SEXP indptr2SEXP, SEXP indices1SEXP, SEXP indices2SEXP, SEXP values1SEXP, SEXP values2SEXP) {
+Rcpp::List logicaland_csr_elemwise(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2, Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2, Rcpp::LogicalVector values1, Rcpp::LogicalVector values2, int nthreads);
+RcppExport SEXP _MatrixExtra_logicaland_csr_elemwise(SEXP indptr1SEXP, SEXP indptr2SEXP, SEXP indices1SEXP, SEXP indices2SEXP, SEXP values1SEXP, SEXP values2SEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr1(indptr1SEXP);
@@ -1213,7 +1432,8 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices2(indices2SEXP);
     Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values1(values1SEXP);
     Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values2(values2SEXP);
-    rcpp_result_gen = Rcpp::wrap(logicaland_csr_elemwise(indptr1, indptr2, indices1, indices2, values1, values2));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(logicaland_csr_elemwise(indptr1, indptr2, indices1, indices2, values1, values2, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -1283,8 +1503,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // add_csr_elemwise
-Rcpp::List add_csr_elemwise(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2, Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2, Rcpp::NumericVector values1, Rcpp::NumericVector values2, const bool substract);
-RcppExport SEXP _MatrixExtra_add_csr_elemwise(SEXP indptr1SEXP, SEXP indptr2SEXP, SEXP indices1SEXP, SEXP indices2SEXP, SEXP values1SEXP, SEXP values2SEXP, SEXP substractSEXP) {
+Rcpp::List add_csr_elemwise(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2, Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2, Rcpp::NumericVector values1, Rcpp::NumericVector values2, const bool substract, int nthreads);
+RcppExport SEXP _MatrixExtra_add_csr_elemwise(SEXP indptr1SEXP, SEXP indptr2SEXP, SEXP indices1SEXP, SEXP indices2SEXP, SEXP values1SEXP, SEXP values2SEXP, SEXP substractSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr1(indptr1SEXP);
@@ -1294,13 +1514,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values1(values1SEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values2(values2SEXP);
     Rcpp::traits::input_parameter< const bool >::type substract(substractSEXP);
-    rcpp_result_gen = Rcpp::wrap(add_csr_elemwise(indptr1, indptr2, indices1, indices2, values1, values2, substract));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(add_csr_elemwise(indptr1, indptr2, indices1, indices2, values1, values2, substract, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // logicalor_csr_elemwise
-Rcpp::List logicalor_csr_elemwise(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2, Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2, Rcpp::LogicalVector values1, Rcpp::LogicalVector values2, const bool xor_op);
-RcppExport SEXP _MatrixExtra_logicalor_csr_elemwise(SEXP indptr1SEXP, SEXP indptr2SEXP, SEXP indices1SEXP, SEXP indices2SEXP, SEXP values1SEXP, SEXP values2SEXP, SEXP xor_opSEXP) {
+Rcpp::List logicalor_csr_elemwise(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2, Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2, Rcpp::LogicalVector values1, Rcpp::LogicalVector values2, const bool xor_op, int nthreads);
+RcppExport SEXP _MatrixExtra_logicalor_csr_elemwise(SEXP indptr1SEXP, SEXP indptr2SEXP, SEXP indices1SEXP, SEXP indices2SEXP, SEXP values1SEXP, SEXP values2SEXP, SEXP xor_opSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr1(indptr1SEXP);
@@ -1310,13 +1531,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values1(values1SEXP);
     Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values2(values2SEXP);
     Rcpp::traits::input_parameter< const bool >::type xor_op(xor_opSEXP);
-    rcpp_result_gen = Rcpp::wrap(logicalor_csr_elemwise(indptr1, indptr2, indices1, indices2, values1, values2, xor_op));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(logicalor_csr_elemwise(indptr1, indptr2, indices1, indices2, values1, values2, xor_op, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // multiply_csr_by_coo_elemwise
-Rcpp::List multiply_csr_by_coo_elemwise(Rcpp::IntegerVector X_csr_indptr_, Rcpp::IntegerVector X_csr_indices_, Rcpp::NumericVector X_csr_values_, Rcpp::IntegerVector Y_coo_row, Rcpp::IntegerVector Y_coo_col, Rcpp::NumericVector Y_coo_val, int max_row_X, int max_col_X);
-RcppExport SEXP _MatrixExtra_multiply_csr_by_coo_elemwise(SEXP X_csr_indptr_SEXP, SEXP X_csr_indices_SEXP, SEXP X_csr_values_SEXP, SEXP Y_coo_rowSEXP, SEXP Y_coo_colSEXP, SEXP Y_coo_valSEXP, SEXP max_row_XSEXP, SEXP max_col_XSEXP) {
+Rcpp::List multiply_csr_by_coo_elemwise(Rcpp::IntegerVector X_csr_indptr_, Rcpp::IntegerVector X_csr_indices_, Rcpp::NumericVector X_csr_values_, Rcpp::IntegerVector Y_coo_row, Rcpp::IntegerVector Y_coo_col, Rcpp::NumericVector Y_coo_val, int max_row_X, int max_col_X, int nthreads);
+RcppExport SEXP _MatrixExtra_multiply_csr_by_coo_elemwise(SEXP X_csr_indptr_SEXP, SEXP X_csr_indices_SEXP, SEXP X_csr_values_SEXP, SEXP Y_coo_rowSEXP, SEXP Y_coo_colSEXP, SEXP Y_coo_valSEXP, SEXP max_row_XSEXP, SEXP max_col_XSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indptr_(X_csr_indptr_SEXP);
@@ -1327,13 +1549,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type Y_coo_val(Y_coo_valSEXP);
     Rcpp::traits::input_parameter< int >::type max_row_X(max_row_XSEXP);
     Rcpp::traits::input_parameter< int >::type max_col_X(max_col_XSEXP);
-    rcpp_result_gen = Rcpp::wrap(multiply_csr_by_coo_elemwise(X_csr_indptr_, X_csr_indices_, X_csr_values_, Y_coo_row, Y_coo_col, Y_coo_val, max_row_X, max_col_X));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(multiply_csr_by_coo_elemwise(X_csr_indptr_, X_csr_indices_, X_csr_values_, Y_coo_row, Y_coo_col, Y_coo_val, max_row_X, max_col_X, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // logicaland_csr_by_coo_elemwise
-Rcpp::List logicaland_csr_by_coo_elemwise(Rcpp::IntegerVector X_csr_indptr_, Rcpp::IntegerVector X_csr_indices_, Rcpp::LogicalVector X_csr_values_, Rcpp::IntegerVector Y_coo_row, Rcpp::IntegerVector Y_coo_col, Rcpp::LogicalVector Y_coo_val, int max_row_X, int max_col_X);
-RcppExport SEXP _MatrixExtra_logicaland_csr_by_coo_elemwise(SEXP X_csr_indptr_SEXP, SEXP X_csr_indices_SEXP, SEXP X_csr_values_SEXP, SEXP Y_coo_rowSEXP, SEXP Y_coo_colSEXP, SEXP Y_coo_valSEXP, SEXP max_row_XSEXP, SEXP max_col_XSEXP) {
+Rcpp::List logicaland_csr_by_coo_elemwise(Rcpp::IntegerVector X_csr_indptr_, Rcpp::IntegerVector X_csr_indices_, Rcpp::LogicalVector X_csr_values_, Rcpp::IntegerVector Y_coo_row, Rcpp::IntegerVector Y_coo_col, Rcpp::LogicalVector Y_coo_val, int max_row_X, int max_col_X, int nthreads);
+RcppExport SEXP _MatrixExtra_logicaland_csr_by_coo_elemwise(SEXP X_csr_indptr_SEXP, SEXP X_csr_indices_SEXP, SEXP X_csr_values_SEXP, SEXP Y_coo_rowSEXP, SEXP Y_coo_colSEXP, SEXP Y_coo_valSEXP, SEXP max_row_XSEXP, SEXP max_col_XSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type X_csr_indptr_(X_csr_indptr_SEXP);
@@ -1344,7 +1567,8 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type Y_coo_val(Y_coo_valSEXP);
     Rcpp::traits::input_parameter< int >::type max_row_X(max_row_XSEXP);
     Rcpp::traits::input_parameter< int >::type max_col_X(max_col_XSEXP);
-    rcpp_result_gen = Rcpp::wrap(logicaland_csr_by_coo_elemwise(X_csr_indptr_, X_csr_indices_, X_csr_values_, Y_coo_row, Y_coo_col, Y_coo_val, max_row_X, max_col_X));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(logicaland_csr_by_coo_elemwise(X_csr_indptr_, X_csr_indices_, X_csr_values_, Y_coo_row, Y_coo_col, Y_coo_val, max_row_X, max_col_X, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -1592,8 +1816,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // multiply_csr_by_dvec_no_NAs_numeric
-Rcpp::NumericVector multiply_csr_by_dvec_no_NAs_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::NumericVector dvec, const int ncols, const bool multiply, const bool powerto, const bool divide, const bool divrest, const bool intdiv, const bool X_is_LHS);
-RcppExport SEXP _MatrixExtra_multiply_csr_by_dvec_no_NAs_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP dvecSEXP, SEXP ncolsSEXP, SEXP multiplySEXP, SEXP powertoSEXP, SEXP divideSEXP, SEXP divrestSEXP, SEXP intdivSEXP, SEXP X_is_LHSSEXP) {
+Rcpp::NumericVector multiply_csr_by_dvec_no_NAs_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::NumericVector dvec, const int ncols, const bool multiply, const bool powerto, const bool divide, const bool divrest, const bool intdiv, const bool X_is_LHS, int nthreads);
+RcppExport SEXP _MatrixExtra_multiply_csr_by_dvec_no_NAs_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP dvecSEXP, SEXP ncolsSEXP, SEXP multiplySEXP, SEXP powertoSEXP, SEXP divideSEXP, SEXP divrestSEXP, SEXP intdivSEXP, SEXP X_is_LHSSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
@@ -1607,13 +1831,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< const bool >::type divrest(divrestSEXP);
     Rcpp::traits::input_parameter< const bool >::type intdiv(intdivSEXP);
     Rcpp::traits::input_parameter< const bool >::type X_is_LHS(X_is_LHSSEXP);
-    rcpp_result_gen = Rcpp::wrap(multiply_csr_by_dvec_no_NAs_numeric(indptr, indices, values, dvec, ncols, multiply, powerto, divide, divrest, intdiv, X_is_LHS));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(multiply_csr_by_dvec_no_NAs_numeric(indptr, indices, values, dvec, ncols, multiply, powerto, divide, divrest, intdiv, X_is_LHS, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // logicaland_csr_by_dvec_internal
-Rcpp::LogicalVector logicaland_csr_by_dvec_internal(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, Rcpp::LogicalVector dvec, const int ncols);
-RcppExport SEXP _MatrixExtra_logicaland_csr_by_dvec_internal(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP dvecSEXP, SEXP ncolsSEXP) {
+Rcpp::LogicalVector logicaland_csr_by_dvec_internal(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, Rcpp::LogicalVector dvec, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_logicaland_csr_by_dvec_internal(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP dvecSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
@@ -1621,13 +1846,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values(valuesSEXP);
     Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type dvec(dvecSEXP);
     Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
-    rcpp_result_gen = Rcpp::wrap(logicaland_csr_by_dvec_internal(indptr, indices, values, dvec, ncols));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(logicaland_csr_by_dvec_internal(indptr, indices, values, dvec, ncols, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // multiply_csr_by_dvec_with_NAs
-Rcpp::List multiply_csr_by_dvec_with_NAs(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::NumericVector dvec, const int ncols, const bool multiply, const bool powerto, const bool divide, const bool divrest, const bool intdiv, const bool X_is_LHS);
-RcppExport SEXP _MatrixExtra_multiply_csr_by_dvec_with_NAs(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP dvecSEXP, SEXP ncolsSEXP, SEXP multiplySEXP, SEXP powertoSEXP, SEXP divideSEXP, SEXP divrestSEXP, SEXP intdivSEXP, SEXP X_is_LHSSEXP) {
+Rcpp::List multiply_csr_by_dvec_with_NAs(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::NumericVector dvec, const int ncols, const bool multiply, const bool powerto, const bool divide, const bool divrest, const bool intdiv, const bool X_is_LHS, int nthreads);
+RcppExport SEXP _MatrixExtra_multiply_csr_by_dvec_with_NAs(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP dvecSEXP, SEXP ncolsSEXP, SEXP multiplySEXP, SEXP powertoSEXP, SEXP divideSEXP, SEXP divrestSEXP, SEXP intdivSEXP, SEXP X_is_LHSSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
@@ -1641,7 +1867,8 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< const bool >::type divrest(divrestSEXP);
     Rcpp::traits::input_parameter< const bool >::type intdiv(intdivSEXP);
     Rcpp::traits::input_parameter< const bool >::type X_is_LHS(X_is_LHSSEXP);
-    rcpp_result_gen = Rcpp::wrap(multiply_csr_by_dvec_with_NAs(indptr, indices, values, dvec, ncols, multiply, powerto, divide, divrest, intdiv, X_is_LHS));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(multiply_csr_by_dvec_with_NAs(indptr, indices, values, dvec, ncols, multiply, powerto, divide, divrest, intdiv, X_is_LHS, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -1768,6 +1995,23 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// get_kernel_timings_cpp
+Rcpp::List get_kernel_timings_cpp();
+RcppExport SEXP _MatrixExtra_get_kernel_timings_cpp() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    rcpp_result_gen = Rcpp::wrap(get_kernel_timings_cpp());
+    return rcpp_result_gen;
+END_RCPP
+}
+// reset_kernel_timings_cpp
+void reset_kernel_timings_cpp();
+RcppExport SEXP _MatrixExtra_reset_kernel_timings_cpp() {
+BEGIN_RCPP
+    reset_kernel_timings_cpp();
+    return R_NilValue;
+END_RCPP
+}
 // concat_indptr2
 Rcpp::IntegerVector concat_indptr2(Rcpp::IntegerVector ptr1, Rcpp::IntegerVector ptr2);
 RcppExport SEXP _MatrixExtra_concat_indptr2(SEXP ptr1SEXP, SEXP ptr2SEXP) {
@@ -1780,13 +2024,246 @@ BEGIN_RCPP
 END_RCPP
 }
 // concat_csr_batch
-Rcpp::S4 concat_csr_batch(Rcpp::ListOf<Rcpp::S4> objects, Rcpp::S4 out);
-RcppExport SEXP _MatrixExtra_concat_csr_batch(SEXP objectsSEXP, SEXP outSEXP) {
+Rcpp::S4 concat_csr_batch(Rcpp::ListOf<Rcpp::S4> objects, Rcpp::S4 out, int nthreads);
+RcppExport SEXP _MatrixExtra_concat_csr_batch(SEXP objectsSEXP, SEXP outSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::ListOf<Rcpp::S4> >::type objects(objectsSEXP);
     Rcpp::traits::input_parameter< Rcpp::S4 >::type out(outSEXP);
-    rcpp_result_gen = Rcpp::wrap(concat_csr_batch(objects, out));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(concat_csr_batch(objects, out, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// csr_builder_create
+SEXP csr_builder_create(int ncols, bool logical, bool binary);
+RcppExport SEXP _MatrixExtra_csr_builder_create(SEXP ncolsSEXP, SEXP logicalSEXP, SEXP binarySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< bool >::type logical(logicalSEXP);
+    Rcpp::traits::input_parameter< bool >::type binary(binarySEXP);
+    rcpp_result_gen = Rcpp::wrap(csr_builder_create(ncols, logical, binary));
+    return rcpp_result_gen;
+END_RCPP
+}
+// csr_builder_append
+void csr_builder_append(SEXP builder_ptr, Rcpp::S4 batch, int ncols_batch);
+RcppExport SEXP _MatrixExtra_csr_builder_append(SEXP builder_ptrSEXP, SEXP batchSEXP, SEXP ncols_batchSEXP) {
+BEGIN_RCPP
+    Rcpp::traits::input_parameter< SEXP >::type builder_ptr(builder_ptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::S4 >::type batch(batchSEXP);
+    Rcpp::traits::input_parameter< int >::type ncols_batch(ncols_batchSEXP);
+    csr_builder_append(builder_ptr, batch, ncols_batch);
+    return R_NilValue;
+END_RCPP
+}
+// csr_builder_info
+Rcpp::List csr_builder_info(SEXP builder_ptr);
+RcppExport SEXP _MatrixExtra_csr_builder_info(SEXP builder_ptrSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type builder_ptr(builder_ptrSEXP);
+    rcpp_result_gen = Rcpp::wrap(csr_builder_info(builder_ptr));
+    return rcpp_result_gen;
+END_RCPP
+}
+// csr_builder_finalize
+Rcpp::List csr_builder_finalize(SEXP builder_ptr);
+RcppExport SEXP _MatrixExtra_csr_builder_finalize(SEXP builder_ptrSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type builder_ptr(builder_ptrSEXP);
+    rcpp_result_gen = Rcpp::wrap(csr_builder_finalize(builder_ptr));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rowsums_csr_numeric
+Rcpp::NumericVector rowsums_csr_numeric(Rcpp::IntegerVector indptr, Rcpp::NumericVector values, const int ncols, const bool na_rm, const bool mean, int nthreads);
+RcppExport SEXP _MatrixExtra_rowsums_csr_numeric(SEXP indptrSEXP, SEXP valuesSEXP, SEXP ncolsSEXP, SEXP na_rmSEXP, SEXP meanSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< const bool >::type mean(meanSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rowsums_csr_numeric(indptr, values, ncols, na_rm, mean, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rowsums_csr_logical
+Rcpp::NumericVector rowsums_csr_logical(Rcpp::IntegerVector indptr, Rcpp::LogicalVector values, const int ncols, const bool na_rm, const bool mean, int nthreads);
+RcppExport SEXP _MatrixExtra_rowsums_csr_logical(SEXP indptrSEXP, SEXP valuesSEXP, SEXP ncolsSEXP, SEXP na_rmSEXP, SEXP meanSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< const bool >::type mean(meanSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rowsums_csr_logical(indptr, values, ncols, na_rm, mean, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rowsums_csr_binary
+Rcpp::NumericVector rowsums_csr_binary(Rcpp::IntegerVector indptr, const int ncols, const bool mean, int nthreads);
+RcppExport SEXP _MatrixExtra_rowsums_csr_binary(SEXP indptrSEXP, SEXP ncolsSEXP, SEXP meanSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type mean(meanSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rowsums_csr_binary(indptr, ncols, mean, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// colsums_csr_numeric
+Rcpp::NumericVector colsums_csr_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, const int ncols, const bool na_rm, const bool mean, int nthreads);
+RcppExport SEXP _MatrixExtra_colsums_csr_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP ncolsSEXP, SEXP na_rmSEXP, SEXP meanSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< const bool >::type mean(meanSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(colsums_csr_numeric(indptr, indices, values, ncols, na_rm, mean, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// colsums_csr_logical
+Rcpp::NumericVector colsums_csr_logical(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, const int ncols, const bool na_rm, const bool mean, int nthreads);
+RcppExport SEXP _MatrixExtra_colsums_csr_logical(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP ncolsSEXP, SEXP na_rmSEXP, SEXP meanSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< const bool >::type mean(meanSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(colsums_csr_logical(indptr, indices, values, ncols, na_rm, mean, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// colsums_csr_binary
+Rcpp::NumericVector colsums_csr_binary(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, const int ncols, const bool mean, int nthreads);
+RcppExport SEXP _MatrixExtra_colsums_csr_binary(SEXP indptrSEXP, SEXP indicesSEXP, SEXP ncolsSEXP, SEXP meanSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type mean(meanSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(colsums_csr_binary(indptr, indices, ncols, mean, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// norm_csr_numeric
+double norm_csr_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, const int ncols, const int norm_type, int nthreads);
+RcppExport SEXP _MatrixExtra_norm_csr_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP ncolsSEXP, SEXP norm_typeSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< const int >::type norm_type(norm_typeSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(norm_csr_numeric(indptr, indices, values, ncols, norm_type, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// norm_csr_logical
+double norm_csr_logical(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, const int ncols, const int norm_type, int nthreads);
+RcppExport SEXP _MatrixExtra_norm_csr_logical(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP ncolsSEXP, SEXP norm_typeSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< const int >::type norm_type(norm_typeSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(norm_csr_logical(indptr, indices, values, ncols, norm_type, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// norm_csr_binary
+double norm_csr_binary(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, const int ncols, const int norm_type, int nthreads);
+RcppExport SEXP _MatrixExtra_norm_csr_binary(SEXP indptrSEXP, SEXP indicesSEXP, SEXP ncolsSEXP, SEXP norm_typeSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< const int >::type norm_type(norm_typeSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(norm_csr_binary(indptr, indices, ncols, norm_type, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// scale_csr_rows
+Rcpp::NumericVector scale_csr_rows(Rcpp::IntegerVector indptr, Rcpp::NumericVector values, Rcpp::NumericVector scaling, const bool inplace, int nthreads);
+RcppExport SEXP _MatrixExtra_scale_csr_rows(SEXP indptrSEXP, SEXP valuesSEXP, SEXP scalingSEXP, SEXP inplaceSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type scaling(scalingSEXP);
+    Rcpp::traits::input_parameter< const bool >::type inplace(inplaceSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(scale_csr_rows(indptr, values, scaling, inplace, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// scale_csr_cols
+Rcpp::NumericVector scale_csr_cols(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::NumericVector scaling, const bool inplace, int nthreads);
+RcppExport SEXP _MatrixExtra_scale_csr_cols(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP scalingSEXP, SEXP inplaceSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type scaling(scalingSEXP);
+    Rcpp::traits::input_parameter< const bool >::type inplace(inplaceSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(scale_csr_cols(indptr, indices, values, scaling, inplace, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// normalize_csr_rows
+Rcpp::NumericVector normalize_csr_rows(Rcpp::IntegerVector indptr, Rcpp::NumericVector values, const int norm_type, const bool inplace, int nthreads);
+RcppExport SEXP _MatrixExtra_normalize_csr_rows(SEXP indptrSEXP, SEXP valuesSEXP, SEXP norm_typeSEXP, SEXP inplaceSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type norm_type(norm_typeSEXP);
+    Rcpp::traits::input_parameter< const bool >::type inplace(inplaceSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(normalize_csr_rows(indptr, values, norm_type, inplace, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// apply_scalar_functions
+Rcpp::List apply_scalar_functions(Rcpp::NumericVector values, Rcpp::IntegerVector functions, const bool inplace, int nthreads);
+RcppExport SEXP _MatrixExtra_apply_scalar_functions(SEXP valuesSEXP, SEXP functionsSEXP, SEXP inplaceSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type functions(functionsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type inplace(inplaceSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(apply_scalar_functions(values, functions, inplace, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -1881,47 +2358,62 @@ BEGIN_RCPP
     return R_NilValue;
 END_RCPP
 }
+// copy_csr_rows_mmap
+Rcpp::List copy_csr_rows_mmap(SEXP mapped_ptr, Rcpp::IntegerVector rows_take, int nthreads);
+RcppExport SEXP _MatrixExtra_copy_csr_rows_mmap(SEXP mapped_ptrSEXP, SEXP rows_takeSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type mapped_ptr(mapped_ptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type rows_take(rows_takeSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(copy_csr_rows_mmap(mapped_ptr, rows_take, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // copy_csr_rows_numeric
-Rcpp::List copy_csr_rows_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector rows_take);
-RcppExport SEXP _MatrixExtra_copy_csr_rows_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_takeSEXP) {
+Rcpp::List copy_csr_rows_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector rows_take, int nthreads);
+RcppExport SEXP _MatrixExtra_copy_csr_rows_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_takeSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type rows_take(rows_takeSEXP);
-    rcpp_result_gen = Rcpp::wrap(copy_csr_rows_numeric(indptr, indices, values, rows_take));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(copy_csr_rows_numeric(indptr, indices, values, rows_take, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // copy_csr_rows_logical
-Rcpp::List copy_csr_rows_logical(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, Rcpp::IntegerVector rows_take);
-RcppExport SEXP _MatrixExtra_copy_csr_rows_logical(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_takeSEXP) {
+Rcpp::List copy_csr_rows_logical(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, Rcpp::IntegerVector rows_take, int nthreads);
+RcppExport SEXP _MatrixExtra_copy_csr_rows_logical(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_takeSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
     Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values(valuesSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type rows_take(rows_takeSEXP);
-    rcpp_result_gen = Rcpp::wrap(copy_csr_rows_logical(indptr, indices, values, rows_take));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(copy_csr_rows_logical(indptr, indices, values, rows_take, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // copy_csr_rows_binary
-Rcpp::List copy_csr_rows_binary(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::IntegerVector rows_take);
-RcppExport SEXP _MatrixExtra_copy_csr_rows_binary(SEXP indptrSEXP, SEXP indicesSEXP, SEXP rows_takeSEXP) {
+Rcpp::List copy_csr_rows_binary(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::IntegerVector rows_take, int nthreads);
+RcppExport SEXP _MatrixExtra_copy_csr_rows_binary(SEXP indptrSEXP, SEXP indicesSEXP, SEXP rows_takeSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type rows_take(rows_takeSEXP);
-    rcpp_result_gen = Rcpp::wrap(copy_csr_rows_binary(indptr, indices, rows_take));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(copy_csr_rows_binary(indptr, indices, rows_take, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // copy_csr_rows_col_seq_numeric
-Rcpp::List copy_csr_rows_col_seq_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector rows_take, Rcpp::IntegerVector cols_take, const bool index1);
-RcppExport SEXP _MatrixExtra_copy_csr_rows_col_seq_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_takeSEXP, SEXP cols_takeSEXP, SEXP index1SEXP) {
+Rcpp::List copy_csr_rows_col_seq_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector rows_take, Rcpp::IntegerVector cols_take, const bool index1, int nthreads);
+RcppExport SEXP _MatrixExtra_copy_csr_rows_col_seq_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_takeSEXP, SEXP cols_takeSEXP, SEXP index1SEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
@@ -1930,13 +2422,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type rows_take(rows_takeSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type cols_take(cols_takeSEXP);
     Rcpp::traits::input_parameter< const bool >::type index1(index1SEXP);
-    rcpp_result_gen = Rcpp::wrap(copy_csr_rows_col_seq_numeric(indptr, indices, values, rows_take, cols_take, index1));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(copy_csr_rows_col_seq_numeric(indptr, indices, values, rows_take, cols_take, index1, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // copy_csr_rows_col_seq_logical
-Rcpp::List copy_csr_rows_col_seq_logical(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, Rcpp::IntegerVector rows_take, Rcpp::IntegerVector cols_take, const bool index1);
-RcppExport SEXP _MatrixExtra_copy_csr_rows_col_seq_logical(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_takeSEXP, SEXP cols_takeSEXP, SEXP index1SEXP) {
+Rcpp::List copy_csr_rows_col_seq_logical(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, Rcpp::IntegerVector rows_take, Rcpp::IntegerVector cols_take, const bool index1, int nthreads);
+RcppExport SEXP _MatrixExtra_copy_csr_rows_col_seq_logical(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_takeSEXP, SEXP cols_takeSEXP, SEXP index1SEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
@@ -1945,13 +2438,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type rows_take(rows_takeSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type cols_take(cols_takeSEXP);
     Rcpp::traits::input_parameter< const bool >::type index1(index1SEXP);
-    rcpp_result_gen = Rcpp::wrap(copy_csr_rows_col_seq_logical(indptr, indices, values, rows_take, cols_take, index1));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(copy_csr_rows_col_seq_logical(indptr, indices, values, rows_take, cols_take, index1, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // copy_csr_rows_col_seq_binary
-Rcpp::List copy_csr_rows_col_seq_binary(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::IntegerVector rows_take, Rcpp::IntegerVector cols_take, const bool index1);
-RcppExport SEXP _MatrixExtra_copy_csr_rows_col_seq_binary(SEXP indptrSEXP, SEXP indicesSEXP, SEXP rows_takeSEXP, SEXP cols_takeSEXP, SEXP index1SEXP) {
+Rcpp::List copy_csr_rows_col_seq_binary(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::IntegerVector rows_take, Rcpp::IntegerVector cols_take, const bool index1, int nthreads);
+RcppExport SEXP _MatrixExtra_copy_csr_rows_col_seq_binary(SEXP indptrSEXP, SEXP indicesSEXP, SEXP rows_takeSEXP, SEXP cols_takeSEXP, SEXP index1SEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
@@ -1959,13 +2453,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type rows_take(rows_takeSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type cols_take(cols_takeSEXP);
     Rcpp::traits::input_parameter< const bool >::type index1(index1SEXP);
-    rcpp_result_gen = Rcpp::wrap(copy_csr_rows_col_seq_binary(indptr, indices, rows_take, cols_take, index1));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(copy_csr_rows_col_seq_binary(indptr, indices, rows_take, cols_take, index1, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // copy_csr_arbitrary_numeric
-Rcpp::List copy_csr_arbitrary_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector rows_take, Rcpp::IntegerVector cols_take);
-RcppExport SEXP _MatrixExtra_copy_csr_arbitrary_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_takeSEXP, SEXP cols_takeSEXP) {
+Rcpp::List copy_csr_arbitrary_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, Rcpp::IntegerVector rows_take, Rcpp::IntegerVector cols_take, int nthreads);
+RcppExport SEXP _MatrixExtra_copy_csr_arbitrary_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_takeSEXP, SEXP cols_takeSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
@@ -1973,13 +2468,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type rows_take(rows_takeSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type cols_take(cols_takeSEXP);
-    rcpp_result_gen = Rcpp::wrap(copy_csr_arbitrary_numeric(indptr, indices, values, rows_take, cols_take));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(copy_csr_arbitrary_numeric(indptr, indices, values, rows_take, cols_take, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // copy_csr_arbitrary_logical
-Rcpp::List copy_csr_arbitrary_logical(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, Rcpp::IntegerVector rows_take, Rcpp::IntegerVector cols_take);
-RcppExport SEXP _MatrixExtra_copy_csr_arbitrary_logical(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_takeSEXP, SEXP cols_takeSEXP) {
+Rcpp::List copy_csr_arbitrary_logical(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, Rcpp::IntegerVector rows_take, Rcpp::IntegerVector cols_take, int nthreads);
+RcppExport SEXP _MatrixExtra_copy_csr_arbitrary_logical(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP rows_takeSEXP, SEXP cols_takeSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
@@ -1987,20 +2483,22 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values(valuesSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type rows_take(rows_takeSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type cols_take(cols_takeSEXP);
-    rcpp_result_gen = Rcpp::wrap(copy_csr_arbitrary_logical(indptr, indices, values, rows_take, cols_take));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(copy_csr_arbitrary_logical(indptr, indices, values, rows_take, cols_take, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // copy_csr_arbitrary_binary
-Rcpp::List copy_csr_arbitrary_binary(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::IntegerVector rows_take, Rcpp::IntegerVector cols_take);
-RcppExport SEXP _MatrixExtra_copy_csr_arbitrary_binary(SEXP indptrSEXP, SEXP indicesSEXP, SEXP rows_takeSEXP, SEXP cols_takeSEXP) {
+Rcpp::List copy_csr_arbitrary_binary(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::IntegerVector rows_take, Rcpp::IntegerVector cols_take, int nthreads);
+RcppExport SEXP _MatrixExtra_copy_csr_arbitrary_binary(SEXP indptrSEXP, SEXP indicesSEXP, SEXP rows_takeSEXP, SEXP cols_takeSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type rows_take(rows_takeSEXP);
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type cols_take(cols_takeSEXP);
-    rcpp_result_gen = Rcpp::wrap(copy_csr_arbitrary_binary(indptr, indices, rows_take, cols_take));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(copy_csr_arbitrary_binary(indptr, indices, rows_take, cols_take, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -2058,6 +2556,47 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// extract_diag_csr_numeric
+Rcpp::NumericVector extract_diag_csr_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, const int ndiag, int nthreads);
+RcppExport SEXP _MatrixExtra_extract_diag_csr_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP ndiagSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ndiag(ndiagSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(extract_diag_csr_numeric(indptr, indices, values, ndiag, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// extract_diag_csr_logical
+Rcpp::LogicalVector extract_diag_csr_logical(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, const int ndiag, int nthreads);
+RcppExport SEXP _MatrixExtra_extract_diag_csr_logical(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP ndiagSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ndiag(ndiagSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(extract_diag_csr_logical(indptr, indices, values, ndiag, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// extract_diag_csr_binary
+Rcpp::LogicalVector extract_diag_csr_binary(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, const int ndiag, int nthreads);
+RcppExport SEXP _MatrixExtra_extract_diag_csr_binary(SEXP indptrSEXP, SEXP indicesSEXP, SEXP ndiagSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ndiag(ndiagSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(extract_diag_csr_binary(indptr, indices, ndiag, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // slice_coo_single_numeric
 double slice_coo_single_numeric(Rcpp::IntegerVector ii, Rcpp::IntegerVector jj, Rcpp::NumericVector xx, int i, int j);
 RcppExport SEXP _MatrixExtra_slice_coo_single_numeric(SEXP iiSEXP, SEXP jjSEXP, SEXP xxSEXP, SEXP iSEXP, SEXP jSEXP) {
@@ -2100,8 +2639,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // slice_coo_arbitrary_numeric
-Rcpp::List slice_coo_arbitrary_numeric(Rcpp::IntegerVector ii, Rcpp::IntegerVector jj, Rcpp::NumericVector xx, Rcpp::IntegerVector rows_take_base1, Rcpp::IntegerVector cols_take_base1, bool all_i, bool all_j, bool i_is_seq, bool j_is_seq, bool i_is_rev_seq, bool j_is_rev_seq, int nrows, int ncols);
-RcppExport SEXP _MatrixExtra_slice_coo_arbitrary_numeric(SEXP iiSEXP, SEXP jjSEXP, SEXP xxSEXP, SEXP rows_take_base1SEXP, SEXP cols_take_base1SEXP, SEXP all_iSEXP, SEXP all_jSEXP, SEXP i_is_seqSEXP, SEXP j_is_seqSEXP, SEXP i_is_rev_seqSEXP, SEXP j_is_rev_seqSEXP, SEXP nrowsSEXP, SEXP ncolsSEXP) {
+Rcpp::List slice_coo_arbitrary_numeric(Rcpp::IntegerVector ii, Rcpp::IntegerVector jj, Rcpp::NumericVector xx, Rcpp::IntegerVector rows_take_base1, Rcpp::IntegerVector cols_take_base1, bool all_i, bool all_j, bool i_is_seq, bool j_is_seq, bool i_is_rev_seq, bool j_is_rev_seq, int nrows, int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_slice_coo_arbitrary_numeric(SEXP iiSEXP, SEXP jjSEXP, SEXP xxSEXP, SEXP rows_take_base1SEXP, SEXP cols_take_base1SEXP, SEXP all_iSEXP, SEXP all_jSEXP, SEXP i_is_seqSEXP, SEXP j_is_seqSEXP, SEXP i_is_rev_seqSEXP, SEXP j_is_rev_seqSEXP, SEXP nrowsSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ii(iiSEXP);
@@ -2117,13 +2656,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< bool >::type j_is_rev_seq(j_is_rev_seqSEXP);
     Rcpp::traits::input_parameter< int >::type nrows(nrowsSEXP);
     Rcpp::traits::input_parameter< int >::type ncols(ncolsSEXP);
-    rcpp_result_gen = Rcpp::wrap(slice_coo_arbitrary_numeric(ii, jj, xx, rows_take_base1, cols_take_base1, all_i, all_j, i_is_seq, j_is_seq, i_is_rev_seq, j_is_rev_seq, nrows, ncols));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(slice_coo_arbitrary_numeric(ii, jj, xx, rows_take_base1, cols_take_base1, all_i, all_j, i_is_seq, j_is_seq, i_is_rev_seq, j_is_rev_seq, nrows, ncols, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // slice_coo_arbitrary_logical
-Rcpp::List slice_coo_arbitrary_logical(Rcpp::IntegerVector ii, Rcpp::IntegerVector jj, Rcpp::LogicalVector xx, Rcpp::IntegerVector rows_take_base1, Rcpp::IntegerVector cols_take_base1, bool all_i, bool all_j, bool i_is_seq, bool j_is_seq, bool i_is_rev_seq, bool j_is_rev_seq, int nrows, int ncols);
-RcppExport SEXP _MatrixExtra_slice_coo_arbitrary_logical(SEXP iiSEXP, SEXP jjSEXP, SEXP xxSEXP, SEXP rows_take_base1SEXP, SEXP cols_take_base1SEXP, SEXP all_iSEXP, SEXP all_jSEXP, SEXP i_is_seqSEXP, SEXP j_is_seqSEXP, SEXP i_is_rev_seqSEXP, SEXP j_is_rev_seqSEXP, SEXP nrowsSEXP, SEXP ncolsSEXP) {
+Rcpp::List slice_coo_arbitrary_logical(Rcpp::IntegerVector ii, Rcpp::IntegerVector jj, Rcpp::LogicalVector xx, Rcpp::IntegerVector rows_take_base1, Rcpp::IntegerVector cols_take_base1, bool all_i, bool all_j, bool i_is_seq, bool j_is_seq, bool i_is_rev_seq, bool j_is_rev_seq, int nrows, int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_slice_coo_arbitrary_logical(SEXP iiSEXP, SEXP jjSEXP, SEXP xxSEXP, SEXP rows_take_base1SEXP, SEXP cols_take_base1SEXP, SEXP all_iSEXP, SEXP all_jSEXP, SEXP i_is_seqSEXP, SEXP j_is_seqSEXP, SEXP i_is_rev_seqSEXP, SEXP j_is_rev_seqSEXP, SEXP nrowsSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ii(iiSEXP);
@@ -2139,13 +2679,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< bool >::type j_is_rev_seq(j_is_rev_seqSEXP);
     Rcpp::traits::input_parameter< int >::type nrows(nrowsSEXP);
     Rcpp::traits::input_parameter< int >::type ncols(ncolsSEXP);
-    rcpp_result_gen = Rcpp::wrap(slice_coo_arbitrary_logical(ii, jj, xx, rows_take_base1, cols_take_base1, all_i, all_j, i_is_seq, j_is_seq, i_is_rev_seq, j_is_rev_seq, nrows, ncols));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(slice_coo_arbitrary_logical(ii, jj, xx, rows_take_base1, cols_take_base1, all_i, all_j, i_is_seq, j_is_seq, i_is_rev_seq, j_is_rev_seq, nrows, ncols, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // slice_coo_arbitrary_binary
-Rcpp::List slice_coo_arbitrary_binary(Rcpp::IntegerVector ii, Rcpp::IntegerVector jj, Rcpp::IntegerVector rows_take_base1, Rcpp::IntegerVector cols_take_base1, bool all_i, bool all_j, bool i_is_seq, bool j_is_seq, bool i_is_rev_seq, bool j_is_rev_seq, int nrows, int ncols);
-RcppExport SEXP _MatrixExtra_slice_coo_arbitrary_binary(SEXP iiSEXP, SEXP jjSEXP, SEXP rows_take_base1SEXP, SEXP cols_take_base1SEXP, SEXP all_iSEXP, SEXP all_jSEXP, SEXP i_is_seqSEXP, SEXP j_is_seqSEXP, SEXP i_is_rev_seqSEXP, SEXP j_is_rev_seqSEXP, SEXP nrowsSEXP, SEXP ncolsSEXP) {
+Rcpp::List slice_coo_arbitrary_binary(Rcpp::IntegerVector ii, Rcpp::IntegerVector jj, Rcpp::IntegerVector rows_take_base1, Rcpp::IntegerVector cols_take_base1, bool all_i, bool all_j, bool i_is_seq, bool j_is_seq, bool i_is_rev_seq, bool j_is_rev_seq, int nrows, int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_slice_coo_arbitrary_binary(SEXP iiSEXP, SEXP jjSEXP, SEXP rows_take_base1SEXP, SEXP cols_take_base1SEXP, SEXP all_iSEXP, SEXP all_jSEXP, SEXP i_is_seqSEXP, SEXP j_is_seqSEXP, SEXP i_is_rev_seqSEXP, SEXP j_is_rev_seqSEXP, SEXP nrowsSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ii(iiSEXP);
@@ -2160,7 +2701,8 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< bool >::type j_is_rev_seq(j_is_rev_seqSEXP);
     Rcpp::traits::input_parameter< int >::type nrows(nrowsSEXP);
     Rcpp::traits::input_parameter< int >::type ncols(ncolsSEXP);
-    rcpp_result_gen = Rcpp::wrap(slice_coo_arbitrary_binary(ii, jj, rows_take_base1, cols_take_base1, all_i, all_j, i_is_seq, j_is_seq, i_is_rev_seq, j_is_rev_seq, nrows, ncols));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(slice_coo_arbitrary_binary(ii, jj, rows_take_base1, cols_take_base1, all_i, all_j, i_is_seq, j_is_seq, i_is_rev_seq, j_is_rev_seq, nrows, ncols, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -2196,6 +2738,161 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// restrict_nthreads
+int restrict_nthreads(int nthreads, double work, double min_work_per_thread);
+RcppExport SEXP _MatrixExtra_restrict_nthreads(SEXP nthreadsSEXP, SEXP workSEXP, SEXP min_work_per_threadSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    Rcpp::traits::input_parameter< double >::type work(workSEXP);
+    Rcpp::traits::input_parameter< double >::type min_work_per_thread(min_work_per_threadSEXP);
+    rcpp_result_gen = Rcpp::wrap(restrict_nthreads(nthreads, work, min_work_per_thread));
+    return rcpp_result_gen;
+END_RCPP
+}
+// get_serial_cutoffs_cpp
+Rcpp::List get_serial_cutoffs_cpp();
+RcppExport SEXP _MatrixExtra_get_serial_cutoffs_cpp() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    rcpp_result_gen = Rcpp::wrap(get_serial_cutoffs_cpp());
+    return rcpp_result_gen;
+END_RCPP
+}
+// set_serial_cutoff_scale_cpp
+void set_serial_cutoff_scale_cpp(double scale);
+RcppExport SEXP _MatrixExtra_set_serial_cutoff_scale_cpp(SEXP scaleSEXP) {
+BEGIN_RCPP
+    Rcpp::traits::input_parameter< double >::type scale(scaleSEXP);
+    set_serial_cutoff_scale_cpp(scale);
+    return R_NilValue;
+END_RCPP
+}
+// transpose_csr_numeric
+Rcpp::List transpose_csr_numeric(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::NumericVector values, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_transpose_csr_numeric(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(transpose_csr_numeric(indptr, indices, values, ncols, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// transpose_csr_logical
+Rcpp::List transpose_csr_logical(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, Rcpp::LogicalVector values, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_transpose_csr_logical(SEXP indptrSEXP, SEXP indicesSEXP, SEXP valuesSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(transpose_csr_logical(indptr, indices, values, ncols, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// transpose_csr_binary
+Rcpp::List transpose_csr_binary(Rcpp::IntegerVector indptr, Rcpp::IntegerVector indices, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_transpose_csr_binary(SEXP indptrSEXP, SEXP indicesSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indptr(indptrSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type indices(indicesSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(transpose_csr_binary(indptr, indices, ncols, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// coo_to_csr_numeric
+Rcpp::List coo_to_csr_numeric(Rcpp::IntegerVector ii, Rcpp::IntegerVector jj, Rcpp::NumericVector values, const int nrows, const bool sum_duplicates, const bool drop_zeros, int nthreads);
+RcppExport SEXP _MatrixExtra_coo_to_csr_numeric(SEXP iiSEXP, SEXP jjSEXP, SEXP valuesSEXP, SEXP nrowsSEXP, SEXP sum_duplicatesSEXP, SEXP drop_zerosSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ii(iiSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type jj(jjSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type nrows(nrowsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type sum_duplicates(sum_duplicatesSEXP);
+    Rcpp::traits::input_parameter< const bool >::type drop_zeros(drop_zerosSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(coo_to_csr_numeric(ii, jj, values, nrows, sum_duplicates, drop_zeros, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// coo_to_csr_logical
+Rcpp::List coo_to_csr_logical(Rcpp::IntegerVector ii, Rcpp::IntegerVector jj, Rcpp::LogicalVector values, const int nrows, const bool sum_duplicates, const bool drop_zeros, int nthreads);
+RcppExport SEXP _MatrixExtra_coo_to_csr_logical(SEXP iiSEXP, SEXP jjSEXP, SEXP valuesSEXP, SEXP nrowsSEXP, SEXP sum_duplicatesSEXP, SEXP drop_zerosSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ii(iiSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type jj(jjSEXP);
+    Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const int >::type nrows(nrowsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type sum_duplicates(sum_duplicatesSEXP);
+    Rcpp::traits::input_parameter< const bool >::type drop_zeros(drop_zerosSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(coo_to_csr_logical(ii, jj, values, nrows, sum_duplicates, drop_zeros, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// coo_to_csr_binary
+Rcpp::List coo_to_csr_binary(Rcpp::IntegerVector ii, Rcpp::IntegerVector jj, const int nrows, int nthreads);
+RcppExport SEXP _MatrixExtra_coo_to_csr_binary(SEXP iiSEXP, SEXP jjSEXP, SEXP nrowsSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ii(iiSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type jj(jjSEXP);
+    Rcpp::traits::input_parameter< const int >::type nrows(nrowsSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(coo_to_csr_binary(ii, jj, nrows, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dense_to_csr_numeric
+Rcpp::List dense_to_csr_numeric(SEXP X, const int nrows, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_dense_to_csr_numeric(SEXP XSEXP, SEXP nrowsSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type X(XSEXP);
+    Rcpp::traits::input_parameter< const int >::type nrows(nrowsSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dense_to_csr_numeric(X, nrows, ncols, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dense_to_csr_logical
+Rcpp::List dense_to_csr_logical(SEXP X, const int nrows, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_dense_to_csr_logical(SEXP XSEXP, SEXP nrowsSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type X(XSEXP);
+    Rcpp::traits::input_parameter< const int >::type nrows(nrowsSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dense_to_csr_logical(X, nrows, ncols, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dense_to_csr_binary
+Rcpp::List dense_to_csr_binary(SEXP X, const int nrows, const int ncols, int nthreads);
+RcppExport SEXP _MatrixExtra_dense_to_csr_binary(SEXP XSEXP, SEXP nrowsSEXP, SEXP ncolsSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type X(XSEXP);
+    Rcpp::traits::input_parameter< const int >::type nrows(nrowsSEXP);
+    Rcpp::traits::input_parameter< const int >::type ncols(ncolsSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dense_to_csr_binary(X, nrows, ncols, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
 
 static const R_CallMethodDef CallEntries[] = {
     {"_MatrixExtra_set_single_row_to_zero", (DL_FUNC) &_MatrixExtra_set_single_row_to_zero, 4},
@@ -2214,37 +2911,47 @@ static const R_CallMethodDef CallEntries[] = {
     {"_MatrixExtra_set_colseq_to_const", (DL_FUNC) &_MatrixExtra_set_colseq_to_const, 7},
     {"_MatrixExtra_set_arbitrary_rows_to_zero", (DL_FUNC) &_MatrixExtra_set_arbitrary_rows_to_zero, 4},
     {"_MatrixExtra_set_arbitrary_rows_to_const", (DL_FUNC) &_MatrixExtra_set_arbitrary_rows_to_const, 6},
-    {"_MatrixExtra_set_arbitrary_cols_to_zero", (DL_FUNC) &_MatrixExtra_set_arbitrary_cols_to_zero, 5},
-    {"_MatrixExtra_set_arbitrary_cols_to_const", (DL_FUNC) &_MatrixExtra_set_arbitrary_cols_to_const, 6},
+    {"_MatrixExtra_set_arbitrary_cols_to_zero", (DL_FUNC) &_MatrixExtra_set_arbitrary_cols_to_zero, 6},
+    {"_MatrixExtra_set_arbitrary_cols_to_const", (DL_FUNC) &_MatrixExtra_set_arbitrary_cols_to_const, 7},
     {"_MatrixExtra_set_arbitrary_rows_single_col_to_zero", (DL_FUNC) &_MatrixExtra_set_arbitrary_rows_single_col_to_zero, 6},
     {"_MatrixExtra_set_arbitrary_rows_single_col_to_const", (DL_FUNC) &_MatrixExtra_set_arbitrary_rows_single_col_to_const, 7},
     {"_MatrixExtra_set_single_row_arbitrary_cols_to_zero", (DL_FUNC) &_MatrixExtra_set_single_row_arbitrary_cols_to_zero, 6},
     {"_MatrixExtra_set_single_row_arbitrary_cols_to_const", (DL_FUNC) &_MatrixExtra_set_single_row_arbitrary_cols_to_const, 7},
-    {"_MatrixExtra_set_arbitrary_rows_arbitrary_cols_to_zero", (DL_FUNC) &_MatrixExtra_set_arbitrary_rows_arbitrary_cols_to_zero, 6},
-    {"_MatrixExtra_set_arbitrary_rows_arbitrary_cols_to_const", (DL_FUNC) &_MatrixExtra_set_arbitrary_rows_arbitrary_cols_to_const, 7},
+    {"_MatrixExtra_set_arbitrary_rows_arbitrary_cols_to_zero", (DL_FUNC) &_MatrixExtra_set_arbitrary_rows_arbitrary_cols_to_zero, 7},
+    {"_MatrixExtra_set_arbitrary_rows_arbitrary_cols_to_const", (DL_FUNC) &_MatrixExtra_set_arbitrary_rows_arbitrary_cols_to_const, 8},
     {"_MatrixExtra_set_rowseq_to_smat", (DL_FUNC) &_MatrixExtra_set_rowseq_to_smat, 8},
     {"_MatrixExtra_set_arbitrary_rows_to_smat", (DL_FUNC) &_MatrixExtra_set_arbitrary_rows_to_smat, 7},
+    {"_MatrixExtra_set_csr_entries_from_csr", (DL_FUNC) &_MatrixExtra_set_csr_entries_from_csr, 7},
+    {"_MatrixExtra_set_diag_csr_existing", (DL_FUNC) &_MatrixExtra_set_diag_csr_existing, 6},
     {"_MatrixExtra_check_shapes_are_assignable_2d", (DL_FUNC) &_MatrixExtra_check_shapes_are_assignable_2d, 4},
     {"_MatrixExtra_check_shapes_are_assignable_1d", (DL_FUNC) &_MatrixExtra_check_shapes_are_assignable_1d, 3},
     {"_MatrixExtra_check_shapes_are_assignable_1d_v2", (DL_FUNC) &_MatrixExtra_check_shapes_are_assignable_1d_v2, 3},
     {"_MatrixExtra_cbind_csr_numeric", (DL_FUNC) &_MatrixExtra_cbind_csr_numeric, 6},
     {"_MatrixExtra_cbind_csr_logical", (DL_FUNC) &_MatrixExtra_cbind_csr_logical, 6},
     {"_MatrixExtra_cbind_csr_binary", (DL_FUNC) &_MatrixExtra_cbind_csr_binary, 4},
+    {"_MatrixExtra_concat_csr_batch_cols", (DL_FUNC) &_MatrixExtra_concat_csr_batch_cols, 3},
     {"_MatrixExtra_matmul_dense_csc_numeric", (DL_FUNC) &_MatrixExtra_matmul_dense_csc_numeric, 5},
     {"_MatrixExtra_matmul_dense_csc_float32", (DL_FUNC) &_MatrixExtra_matmul_dense_csc_float32, 5},
     {"_MatrixExtra_tcrossprod_dense_csr_numeric", (DL_FUNC) &_MatrixExtra_tcrossprod_dense_csr_numeric, 6},
     {"_MatrixExtra_tcrossprod_dense_csr_float32", (DL_FUNC) &_MatrixExtra_tcrossprod_dense_csr_float32, 6},
     {"_MatrixExtra_tcrossprod_csr_dense_numeric", (DL_FUNC) &_MatrixExtra_tcrossprod_csr_dense_numeric, 5},
     {"_MatrixExtra_tcrossprod_csr_dense_float32", (DL_FUNC) &_MatrixExtra_tcrossprod_csr_dense_float32, 5},
+    {"_MatrixExtra_sddmm_csr_numeric", (DL_FUNC) &_MatrixExtra_sddmm_csr_numeric, 5},
+    {"_MatrixExtra_sddmm_csr_float32", (DL_FUNC) &_MatrixExtra_sddmm_csr_float32, 5},
     {"_MatrixExtra_matmul_csr_dvec_numeric", (DL_FUNC) &_MatrixExtra_matmul_csr_dvec_numeric, 5},
     {"_MatrixExtra_matmul_csr_dvec_integer", (DL_FUNC) &_MatrixExtra_matmul_csr_dvec_integer, 5},
     {"_MatrixExtra_matmul_csr_dvec_logical", (DL_FUNC) &_MatrixExtra_matmul_csr_dvec_logical, 5},
     {"_MatrixExtra_matmul_csr_dvec_float32", (DL_FUNC) &_MatrixExtra_matmul_csr_dvec_float32, 5},
-    {"_MatrixExtra_matmul_csr_svec_numeric", (DL_FUNC) &_MatrixExtra_matmul_csr_svec_numeric, 6},
-    {"_MatrixExtra_matmul_csr_svec_integer", (DL_FUNC) &_MatrixExtra_matmul_csr_svec_integer, 6},
-    {"_MatrixExtra_matmul_csr_svec_logical", (DL_FUNC) &_MatrixExtra_matmul_csr_svec_logical, 6},
-    {"_MatrixExtra_matmul_csr_svec_binary", (DL_FUNC) &_MatrixExtra_matmul_csr_svec_binary, 5},
-    {"_MatrixExtra_matmul_csr_svec_float32", (DL_FUNC) &_MatrixExtra_matmul_csr_svec_float32, 6},
+    {"_MatrixExtra_matmul_csr_dvec_mmap", (DL_FUNC) &_MatrixExtra_matmul_csr_dvec_mmap, 3},
+    {"_MatrixExtra_matmul_csr_svec_numeric", (DL_FUNC) &_MatrixExtra_matmul_csr_svec_numeric, 7},
+    {"_MatrixExtra_matmul_csr_svec_integer", (DL_FUNC) &_MatrixExtra_matmul_csr_svec_integer, 7},
+    {"_MatrixExtra_matmul_csr_svec_logical", (DL_FUNC) &_MatrixExtra_matmul_csr_svec_logical, 7},
+    {"_MatrixExtra_matmul_csr_svec_binary", (DL_FUNC) &_MatrixExtra_matmul_csr_svec_binary, 6},
+    {"_MatrixExtra_matmul_csr_svec_float32", (DL_FUNC) &_MatrixExtra_matmul_csr_svec_float32, 7},
+    {"_MatrixExtra_crossprod_csr_svec_numeric", (DL_FUNC) &_MatrixExtra_crossprod_csr_svec_numeric, 6},
+    {"_MatrixExtra_crossprod_csr_svec_integer", (DL_FUNC) &_MatrixExtra_crossprod_csr_svec_integer, 6},
+    {"_MatrixExtra_crossprod_csr_svec_logical", (DL_FUNC) &_MatrixExtra_crossprod_csr_svec_logical, 6},
+    {"_MatrixExtra_crossprod_csr_svec_binary", (DL_FUNC) &_MatrixExtra_crossprod_csr_svec_binary, 5},
     {"_MatrixExtra_matmul_rowvec_by_csc", (DL_FUNC) &_MatrixExtra_matmul_rowvec_by_csc, 4},
     {"_MatrixExtra_matmul_rowvec_by_cscbin", (DL_FUNC) &_MatrixExtra_matmul_rowvec_by_cscbin, 3},
     {"_MatrixExtra_matmul_colvec_by_scolvecascsr_f32", (DL_FUNC) &_MatrixExtra_matmul_colvec_by_scolvecascsr_f32, 4},
@@ -2253,18 +2960,20 @@ static const R_CallMethodDef CallEntries[] = {
     {"_MatrixExtra_matmul_spcolvec_by_scolvecascsr_integer", (DL_FUNC) &_MatrixExtra_matmul_spcolvec_by_scolvecascsr_integer, 6},
     {"_MatrixExtra_matmul_spcolvec_by_scolvecascsr_logical", (DL_FUNC) &_MatrixExtra_matmul_spcolvec_by_scolvecascsr_logical, 6},
     {"_MatrixExtra_matmul_spcolvec_by_scolvecascsr_binary", (DL_FUNC) &_MatrixExtra_matmul_spcolvec_by_scolvecascsr_binary, 5},
+    {"_MatrixExtra_matmul_csr_csr_numeric", (DL_FUNC) &_MatrixExtra_matmul_csr_csr_numeric, 8},
+    {"_MatrixExtra_matmul_csr_csr_binary", (DL_FUNC) &_MatrixExtra_matmul_csr_csr_binary, 6},
     {"_MatrixExtra_contains_any_zero", (DL_FUNC) &_MatrixExtra_contains_any_zero, 1},
     {"_MatrixExtra_contains_any_inf", (DL_FUNC) &_MatrixExtra_contains_any_inf, 1},
     {"_MatrixExtra_contains_any_neg", (DL_FUNC) &_MatrixExtra_contains_any_neg, 1},
     {"_MatrixExtra_find_first_non_na", (DL_FUNC) &_MatrixExtra_find_first_non_na, 1},
     {"_MatrixExtra_is_same_ngRMatrix", (DL_FUNC) &_MatrixExtra_is_same_ngRMatrix, 4},
     {"_MatrixExtra_check_is_sorted", (DL_FUNC) &_MatrixExtra_check_is_sorted, 1},
-    {"_MatrixExtra_check_indices_are_unsorted", (DL_FUNC) &_MatrixExtra_check_indices_are_unsorted, 2},
-    {"_MatrixExtra_sort_sparse_indices_numeric", (DL_FUNC) &_MatrixExtra_sort_sparse_indices_numeric, 3},
-    {"_MatrixExtra_sort_sparse_indices_logical", (DL_FUNC) &_MatrixExtra_sort_sparse_indices_logical, 3},
-    {"_MatrixExtra_sort_sparse_indices_numeric_known_ncol", (DL_FUNC) &_MatrixExtra_sort_sparse_indices_numeric_known_ncol, 4},
-    {"_MatrixExtra_sort_sparse_indices_logical_known_ncol", (DL_FUNC) &_MatrixExtra_sort_sparse_indices_logical_known_ncol, 4},
-    {"_MatrixExtra_sort_sparse_indices_binary", (DL_FUNC) &_MatrixExtra_sort_sparse_indices_binary, 2},
+    {"_MatrixExtra_check_indices_are_sorted", (DL_FUNC) &_MatrixExtra_check_indices_are_sorted, 3},
+    {"_MatrixExtra_sort_sparse_indices_numeric", (DL_FUNC) &_MatrixExtra_sort_sparse_indices_numeric, 4},
+    {"_MatrixExtra_sort_sparse_indices_logical", (DL_FUNC) &_MatrixExtra_sort_sparse_indices_logical, 4},
+    {"_MatrixExtra_sort_sparse_indices_numeric_known_ncol", (DL_FUNC) &_MatrixExtra_sort_sparse_indices_numeric_known_ncol, 5},
+    {"_MatrixExtra_sort_sparse_indices_logical_known_ncol", (DL_FUNC) &_MatrixExtra_sort_sparse_indices_logical_known_ncol, 5},
+    {"_MatrixExtra_sort_sparse_indices_binary", (DL_FUNC) &_MatrixExtra_sort_sparse_indices_binary, 3},
     {"_MatrixExtra_sort_coo_indices_numeric", (DL_FUNC) &_MatrixExtra_sort_coo_indices_numeric, 3},
     {"_MatrixExtra_sort_coo_indices_logical", (DL_FUNC) &_MatrixExtra_sort_coo_indices_logical, 3},
     {"_MatrixExtra_sort_coo_indices_binary", (DL_FUNC) &_MatrixExtra_sort_coo_indices_binary, 2},
@@ -2287,17 +2996,20 @@ static const R_CallMethodDef CallEntries[] = {
     {"_MatrixExtra_check_valid_coo_matrix", (DL_FUNC) &_MatrixExtra_check_valid_coo_matrix, 4},
     {"_MatrixExtra_check_valid_svec", (DL_FUNC) &_MatrixExtra_check_valid_svec, 2},
     {"_MatrixExtra_rebuild_indptr_after_filter", (DL_FUNC) &_MatrixExtra_rebuild_indptr_after_filter, 2},
-    {"_MatrixExtra_multiply_csr_elemwise", (DL_FUNC) &_MatrixExtra_multiply_csr_elemwise, 6},
-    {"_MatrixExtra_logicaland_csr_elemwise", (DL_FUNC) &_MatrixExtra_logicaland_csr_elemwise, 6},
+    {"_MatrixExtra_mmap_csr_open_file", (DL_FUNC) &_MatrixExtra_mmap_csr_open_file, 1},
+    {"_MatrixExtra_mmap_csr_close_file", (DL_FUNC) &_MatrixExtra_mmap_csr_close_file, 1},
+    {"_MatrixExtra_mmap_csr_get_info", (DL_FUNC) &_MatrixExtra_mmap_csr_get_info, 1},
+    {"_MatrixExtra_multiply_csr_elemwise", (DL_FUNC) &_MatrixExtra_multiply_csr_elemwise, 7},
+    {"_MatrixExtra_logicaland_csr_elemwise", (DL_FUNC) &_MatrixExtra_logicaland_csr_elemwise, 7},
     {"_MatrixExtra_multiply_csr_by_dense_elemwise_double", (DL_FUNC) &_MatrixExtra_multiply_csr_by_dense_elemwise_double, 4},
     {"_MatrixExtra_multiply_csr_by_dense_elemwise_float32", (DL_FUNC) &_MatrixExtra_multiply_csr_by_dense_elemwise_float32, 4},
     {"_MatrixExtra_multiply_csr_by_dense_elemwise_int", (DL_FUNC) &_MatrixExtra_multiply_csr_by_dense_elemwise_int, 4},
     {"_MatrixExtra_multiply_csr_by_dense_elemwise_bool", (DL_FUNC) &_MatrixExtra_multiply_csr_by_dense_elemwise_bool, 4},
     {"_MatrixExtra_logicaland_csr_by_dense_cpp", (DL_FUNC) &_MatrixExtra_logicaland_csr_by_dense_cpp, 4},
-    {"_MatrixExtra_add_csr_elemwise", (DL_FUNC) &_MatrixExtra_add_csr_elemwise, 7},
-    {"_MatrixExtra_logicalor_csr_elemwise", (DL_FUNC) &_MatrixExtra_logicalor_csr_elemwise, 7},
-    {"_MatrixExtra_multiply_csr_by_coo_elemwise", (DL_FUNC) &_MatrixExtra_multiply_csr_by_coo_elemwise, 8},
-    {"_MatrixExtra_logicaland_csr_by_coo_elemwise", (DL_FUNC) &_MatrixExtra_logicaland_csr_by_coo_elemwise, 8},
+    {"_MatrixExtra_add_csr_elemwise", (DL_FUNC) &_MatrixExtra_add_csr_elemwise, 8},
+    {"_MatrixExtra_logicalor_csr_elemwise", (DL_FUNC) &_MatrixExtra_logicalor_csr_elemwise, 8},
+    {"_MatrixExtra_multiply_csr_by_coo_elemwise", (DL_FUNC) &_MatrixExtra_multiply_csr_by_coo_elemwise, 9},
+    {"_MatrixExtra_logicaland_csr_by_coo_elemwise", (DL_FUNC) &_MatrixExtra_logicaland_csr_by_coo_elemwise, 9},
     {"_MatrixExtra_multiply_coo_by_dense_numeric", (DL_FUNC) &_MatrixExtra_multiply_coo_by_dense_numeric, 4},
     {"_MatrixExtra_multiply_coo_by_dense_integer", (DL_FUNC) &_MatrixExtra_multiply_coo_by_dense_integer, 4},
     {"_MatrixExtra_multiply_coo_by_dense_logical", (DL_FUNC) &_MatrixExtra_multiply_coo_by_dense_logical, 4},
@@ -2317,9 +3029,9 @@ static const R_CallMethodDef CallEntries[] = {
     {"_MatrixExtra_multiply_csc_by_dense_keep_NAs_logical", (DL_FUNC) &_MatrixExtra_multiply_csc_by_dense_keep_NAs_logical, 4},
     {"_MatrixExtra_multiply_csc_by_dense_keep_NAs_float32", (DL_FUNC) &_MatrixExtra_multiply_csc_by_dense_keep_NAs_float32, 4},
     {"_MatrixExtra_logicaland_csc_by_dense_keep_NAs", (DL_FUNC) &_MatrixExtra_logicaland_csc_by_dense_keep_NAs, 4},
-    {"_MatrixExtra_multiply_csr_by_dvec_no_NAs_numeric", (DL_FUNC) &_MatrixExtra_multiply_csr_by_dvec_no_NAs_numeric, 11},
-    {"_MatrixExtra_logicaland_csr_by_dvec_internal", (DL_FUNC) &_MatrixExtra_logicaland_csr_by_dvec_internal, 5},
-    {"_MatrixExtra_multiply_csr_by_dvec_with_NAs", (DL_FUNC) &_MatrixExtra_multiply_csr_by_dvec_with_NAs, 11},
+    {"_MatrixExtra_multiply_csr_by_dvec_no_NAs_numeric", (DL_FUNC) &_MatrixExtra_multiply_csr_by_dvec_no_NAs_numeric, 12},
+    {"_MatrixExtra_logicaland_csr_by_dvec_internal", (DL_FUNC) &_MatrixExtra_logicaland_csr_by_dvec_internal, 6},
+    {"_MatrixExtra_multiply_csr_by_dvec_with_NAs", (DL_FUNC) &_MatrixExtra_multiply_csr_by_dvec_with_NAs, 12},
     {"_MatrixExtra_multiply_coo_by_dense_ignore_NAs_numeric", (DL_FUNC) &_MatrixExtra_multiply_coo_by_dense_ignore_NAs_numeric, 12},
     {"_MatrixExtra_multiply_coo_by_dense_ignore_NAs_logical", (DL_FUNC) &_MatrixExtra_multiply_coo_by_dense_ignore_NAs_logical, 6},
     {"_MatrixExtra_multiply_csr_by_svec_no_NAs", (DL_FUNC) &_MatrixExtra_multiply_csr_by_svec_no_NAs, 6},
@@ -2328,8 +3040,27 @@ static const R_CallMethodDef CallEntries[] = {
     {"_MatrixExtra_multiply_elemwise_dense_by_svec_integer", (DL_FUNC) &_MatrixExtra_multiply_elemwise_dense_by_svec_integer, 5},
     {"_MatrixExtra_multiply_elemwise_dense_by_svec_logical", (DL_FUNC) &_MatrixExtra_multiply_elemwise_dense_by_svec_logical, 5},
     {"_MatrixExtra_multiply_elemwise_dense_by_svec_float32", (DL_FUNC) &_MatrixExtra_multiply_elemwise_dense_by_svec_float32, 5},
+    {"_MatrixExtra_get_kernel_timings_cpp", (DL_FUNC) &_MatrixExtra_get_kernel_timings_cpp, 0},
+    {"_MatrixExtra_reset_kernel_timings_cpp", (DL_FUNC) &_MatrixExtra_reset_kernel_timings_cpp, 0},
     {"_MatrixExtra_concat_indptr2", (DL_FUNC) &_MatrixExtra_concat_indptr2, 2},
-    {"_MatrixExtra_concat_csr_batch", (DL_FUNC) &_MatrixExtra_concat_csr_batch, 2},
+    {"_MatrixExtra_concat_csr_batch", (DL_FUNC) &_MatrixExtra_concat_csr_batch, 3},
+    {"_MatrixExtra_csr_builder_create", (DL_FUNC) &_MatrixExtra_csr_builder_create, 3},
+    {"_MatrixExtra_csr_builder_append", (DL_FUNC) &_MatrixExtra_csr_builder_append, 3},
+    {"_MatrixExtra_csr_builder_info", (DL_FUNC) &_MatrixExtra_csr_builder_info, 1},
+    {"_MatrixExtra_csr_builder_finalize", (DL_FUNC) &_MatrixExtra_csr_builder_finalize, 1},
+    {"_MatrixExtra_rowsums_csr_numeric", (DL_FUNC) &_MatrixExtra_rowsums_csr_numeric, 6},
+    {"_MatrixExtra_rowsums_csr_logical", (DL_FUNC) &_MatrixExtra_rowsums_csr_logical, 6},
+    {"_MatrixExtra_rowsums_csr_binary", (DL_FUNC) &_MatrixExtra_rowsums_csr_binary, 4},
+    {"_MatrixExtra_colsums_csr_numeric", (DL_FUNC) &_MatrixExtra_colsums_csr_numeric, 7},
+    {"_MatrixExtra_colsums_csr_logical", (DL_FUNC) &_MatrixExtra_colsums_csr_logical, 7},
+    {"_MatrixExtra_colsums_csr_binary", (DL_FUNC) &_MatrixExtra_colsums_csr_binary, 5},
+    {"_MatrixExtra_norm_csr_numeric", (DL_FUNC) &_MatrixExtra_norm_csr_numeric, 6},
+    {"_MatrixExtra_norm_csr_logical", (DL_FUNC) &_MatrixExtra_norm_csr_logical, 6},
+    {"_MatrixExtra_norm_csr_binary", (DL_FUNC) &_MatrixExtra_norm_csr_binary, 5},
+    {"_MatrixExtra_scale_csr_rows", (DL_FUNC) &_MatrixExtra_scale_csr_rows, 5},
+    {"_MatrixExtra_scale_csr_cols", (DL_FUNC) &_MatrixExtra_scale_csr_cols, 6},
+    {"_MatrixExtra_normalize_csr_rows", (DL_FUNC) &_MatrixExtra_normalize_csr_rows, 5},
+    {"_MatrixExtra_apply_scalar_functions", (DL_FUNC) &_MatrixExtra_apply_scalar_functions, 4},
     {"_MatrixExtra_check_is_seq", (DL_FUNC) &_MatrixExtra_check_is_seq, 1},
     {"_MatrixExtra_check_is_rev_seq", (DL_FUNC) &_MatrixExtra_check_is_rev_seq, 1},
     {"_MatrixExtra_reverse_rows_numeric", (DL_FUNC) &_MatrixExtra_reverse_rows_numeric, 3},
@@ -2338,27 +3069,43 @@ static const R_CallMethodDef CallEntries[] = {
     {"_MatrixExtra_reverse_columns_inplace_numeric", (DL_FUNC) &_MatrixExtra_reverse_columns_inplace_numeric, 4},
     {"_MatrixExtra_reverse_columns_inplace_logical", (DL_FUNC) &_MatrixExtra_reverse_columns_inplace_logical, 4},
     {"_MatrixExtra_reverse_columns_inplace_binary", (DL_FUNC) &_MatrixExtra_reverse_columns_inplace_binary, 4},
-    {"_MatrixExtra_copy_csr_rows_numeric", (DL_FUNC) &_MatrixExtra_copy_csr_rows_numeric, 4},
-    {"_MatrixExtra_copy_csr_rows_logical", (DL_FUNC) &_MatrixExtra_copy_csr_rows_logical, 4},
-    {"_MatrixExtra_copy_csr_rows_binary", (DL_FUNC) &_MatrixExtra_copy_csr_rows_binary, 3},
-    {"_MatrixExtra_copy_csr_rows_col_seq_numeric", (DL_FUNC) &_MatrixExtra_copy_csr_rows_col_seq_numeric, 6},
-    {"_MatrixExtra_copy_csr_rows_col_seq_logical", (DL_FUNC) &_MatrixExtra_copy_csr_rows_col_seq_logical, 6},
-    {"_MatrixExtra_copy_csr_rows_col_seq_binary", (DL_FUNC) &_MatrixExtra_copy_csr_rows_col_seq_binary, 5},
-    {"_MatrixExtra_copy_csr_arbitrary_numeric", (DL_FUNC) &_MatrixExtra_copy_csr_arbitrary_numeric, 5},
-    {"_MatrixExtra_copy_csr_arbitrary_logical", (DL_FUNC) &_MatrixExtra_copy_csr_arbitrary_logical, 5},
-    {"_MatrixExtra_copy_csr_arbitrary_binary", (DL_FUNC) &_MatrixExtra_copy_csr_arbitrary_binary, 4},
+    {"_MatrixExtra_copy_csr_rows_mmap", (DL_FUNC) &_MatrixExtra_copy_csr_rows_mmap, 3},
+    {"_MatrixExtra_copy_csr_rows_numeric", (DL_FUNC) &_MatrixExtra_copy_csr_rows_numeric, 5},
+    {"_MatrixExtra_copy_csr_rows_logical", (DL_FUNC) &_MatrixExtra_copy_csr_rows_logical, 5},
+    {"_MatrixExtra_copy_csr_rows_binary", (DL_FUNC) &_MatrixExtra_copy_csr_rows_binary, 4},
+    {"_MatrixExtra_copy_csr_rows_col_seq_numeric", (DL_FUNC) &_MatrixExtra_copy_csr_rows_col_seq_numeric, 7},
+    {"_MatrixExtra_copy_csr_rows_col_seq_logical", (DL_FUNC) &_MatrixExtra_copy_csr_rows_col_seq_logical, 7},
+    {"_MatrixExtra_copy_csr_rows_col_seq_binary", (DL_FUNC) &_MatrixExtra_copy_csr_rows_col_seq_binary, 6},
+    {"_MatrixExtra_copy_csr_arbitrary_numeric", (DL_FUNC) &_MatrixExtra_copy_csr_arbitrary_numeric, 6},
+    {"_MatrixExtra_copy_csr_arbitrary_logical", (DL_FUNC) &_MatrixExtra_copy_csr_arbitrary_logical, 6},
+    {"_MatrixExtra_copy_csr_arbitrary_binary", (DL_FUNC) &_MatrixExtra_copy_csr_arbitrary_binary, 5},
     {"_MatrixExtra_repeat_indices_n_times", (DL_FUNC) &_MatrixExtra_repeat_indices_n_times, 4},
     {"_MatrixExtra_extract_single_val_csr_numeric", (DL_FUNC) &_MatrixExtra_extract_single_val_csr_numeric, 5},
     {"_MatrixExtra_extract_single_val_csr_logical", (DL_FUNC) &_MatrixExtra_extract_single_val_csr_logical, 5},
     {"_MatrixExtra_extract_single_val_csr_binary", (DL_FUNC) &_MatrixExtra_extract_single_val_csr_binary, 4},
+    {"_MatrixExtra_extract_diag_csr_numeric", (DL_FUNC) &_MatrixExtra_extract_diag_csr_numeric, 5},
+    {"_MatrixExtra_extract_diag_csr_logical", (DL_FUNC) &_MatrixExtra_extract_diag_csr_logical, 5},
+    {"_MatrixExtra_extract_diag_csr_binary", (DL_FUNC) &_MatrixExtra_extract_diag_csr_binary, 4},
     {"_MatrixExtra_slice_coo_single_numeric", (DL_FUNC) &_MatrixExtra_slice_coo_single_numeric, 5},
     {"_MatrixExtra_slice_coo_single_logical", (DL_FUNC) &_MatrixExtra_slice_coo_single_logical, 5},
     {"_MatrixExtra_slice_coo_single_binary", (DL_FUNC) &_MatrixExtra_slice_coo_single_binary, 4},
-    {"_MatrixExtra_slice_coo_arbitrary_numeric", (DL_FUNC) &_MatrixExtra_slice_coo_arbitrary_numeric, 13},
-    {"_MatrixExtra_slice_coo_arbitrary_logical", (DL_FUNC) &_MatrixExtra_slice_coo_arbitrary_logical, 13},
-    {"_MatrixExtra_slice_coo_arbitrary_binary", (DL_FUNC) &_MatrixExtra_slice_coo_arbitrary_binary, 12},
+    {"_MatrixExtra_slice_coo_arbitrary_numeric", (DL_FUNC) &_MatrixExtra_slice_coo_arbitrary_numeric, 14},
+    {"_MatrixExtra_slice_coo_arbitrary_logical", (DL_FUNC) &_MatrixExtra_slice_coo_arbitrary_logical, 14},
+    {"_MatrixExtra_slice_coo_arbitrary_binary", (DL_FUNC) &_MatrixExtra_slice_coo_arbitrary_binary, 13},
     {"_MatrixExtra_inject_NAs_inplace_coo_numeric", (DL_FUNC) &_MatrixExtra_inject_NAs_inplace_coo_numeric, 7},
     {"_MatrixExtra_inject_NAs_inplace_coo_logical", (DL_FUNC) &_MatrixExtra_inject_NAs_inplace_coo_logical, 7},
+    {"_MatrixExtra_restrict_nthreads", (DL_FUNC) &_MatrixExtra_restrict_nthreads, 3},
+    {"_MatrixExtra_get_serial_cutoffs_cpp", (DL_FUNC) &_MatrixExtra_get_serial_cutoffs_cpp, 0},
+    {"_MatrixExtra_set_serial_cutoff_scale_cpp", (DL_FUNC) &_MatrixExtra_set_serial_cutoff_scale_cpp, 1},
+    {"_MatrixExtra_transpose_csr_numeric", (DL_FUNC) &_MatrixExtra_transpose_csr_numeric, 5},
+    {"_MatrixExtra_transpose_csr_logical", (DL_FUNC) &_MatrixExtra_transpose_csr_logical, 5},
+    {"_MatrixExtra_transpose_csr_binary", (DL_FUNC) &_MatrixExtra_transpose_csr_binary, 4},
+    {"_MatrixExtra_coo_to_csr_numeric", (DL_FUNC) &_MatrixExtra_coo_to_csr_numeric, 7},
+    {"_MatrixExtra_coo_to_csr_logical", (DL_FUNC) &_MatrixExtra_coo_to_csr_logical, 7},
+    {"_MatrixExtra_coo_to_csr_binary", (DL_FUNC) &_MatrixExtra_coo_to_csr_binary, 4},
+    {"_MatrixExtra_dense_to_csr_numeric", (DL_FUNC) &_MatrixExtra_dense_to_csr_numeric, 4},
+    {"_MatrixExtra_dense_to_csr_logical", (DL_FUNC) &_MatrixExtra_dense_to_csr_logical, 4},
+    {"_MatrixExtra_dense_to_csr_binary", (DL_FUNC) &_MatrixExtra_dense_to_csr_binary, 4},
     {NULL, NULL, 0}
 };
 
@@ -377,6 +377,16 @@ static inline int set_cols_in_row_to_const_value
     return n_tot;
 }
 
+/* When an assignment doesn't change the sparsity pattern, the new values are
+   written into a copy of the input array, keeping the same indptr and indices. */
+static Rcpp::NumericVector get_values_for_overwrite(Rcpp::NumericVector values)
+{
+    VectorConstructorArgs args;
+    args.size = values.size(); args.from_pointer = true;
+    args.num_pointer_from = (void*)REAL(values);
+    return Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+}
+
 #define check_max_size(diff, indices) \
     if ((diff) >= INT_MAX - (indices).size()) \
         Rcpp::stop("Error: resulting matrix would be larger than INT_MAX limit.\n")
@@ -511,7 +521,7 @@ Rcpp::List set_single_row_to_const
 
     if (diff == 0)
     {
-        Rcpp::NumericVector values_new(values.begin(), values.end());
+        Rcpp::NumericVector values_new = get_values_for_overwrite(values);
         std::fill_n(values_new.begin() + indptr[row_set], ncols, val_set);
 
         return Rcpp::List::create(
@@ -577,7 +587,7 @@ Rcpp::List set_single_col_to_const
 
     if (diff == 0)
     {
-        Rcpp::NumericVector values_new(values.begin(), values.end());
+        Rcpp::NumericVector values_new = get_values_for_overwrite(values);
         const int nnz = indices.size();
         for (int ix = 0; ix < nnz; ix++)
             values_new[ix] = (indices[ix] == col_set)? val_set : values[ix];
@@ -708,7 +718,7 @@ Rcpp::List set_single_val_to_const
 
     if (has_val)
     {
-        Rcpp::NumericVector values_new(values.begin(), values.end());
+        Rcpp::NumericVector values_new = get_values_for_overwrite(values);
         values_new[ix] = val_set;
         return Rcpp::List::create(
             Rcpp::_["indptr"] = indptr,
@@ -784,7 +794,7 @@ Rcpp::List set_single_row_to_rowvec
 
     if (diff == 0)
     {
-        Rcpp::NumericVector values_new(values.begin(), values.end());
+        Rcpp::NumericVector values_new = get_values_for_overwrite(values);
         for (int repetition = 0; repetition < n_repeats; repetition++)
             std::copy(vec_set.begin(), vec_set.end(),
                       values_new.begin() + indptr[row_set] + repetition*vec_set.size());
@@ -855,7 +865,7 @@ Rcpp::List set_single_col_to_colvec
 
     if (diff == 0)
     {
-        Rcpp::NumericVector values_new(values.begin(), values.end());
+        Rcpp::NumericVector values_new = get_values_for_overwrite(values);
         for (int row = 0; row < nrows; row++)
         {
             for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
@@ -954,7 +964,7 @@ Rcpp::List set_single_row_to_svec
         }
 
         /* If reaching here, it's the same indices */
-        Rcpp::NumericVector values_new(values.begin(), values.end());
+        Rcpp::NumericVector values_new = get_values_for_overwrite(values);
         for (int repetition = 0; repetition < n_repeats; repetition++)
             std::copy(xx.begin(), xx.end(), values_new.begin() + indptr[row_set] + repetition*nnz);
 
@@ -1189,7 +1199,7 @@ Rcpp::List set_rowseq_to_const
 
     if (diff == 0)
     {
-        Rcpp::NumericVector values_new(values.begin(), values.end());
+        Rcpp::NumericVector values_new = get_values_for_overwrite(values);
         std::fill(values_new.begin() + indptr[row_set_st], values_new.begin() + indptr[row_set_end+1], val_set);
         return Rcpp::List::create(
             Rcpp::_["indptr"] = indptr,
@@ -1463,7 +1473,7 @@ Rcpp::List set_arbitrary_rows_to_const
 
     if (diff == 0)
     {
-        Rcpp::NumericVector values_new(values.begin(), values.end());
+        Rcpp::NumericVector values_new = get_values_for_overwrite(values);
         for (int row : rows_set)
             std::fill(values_new.begin() + indptr[row], values_new.begin() + indptr[row+1], val_set);
 
@@ -1603,20 +1613,42 @@ Rcpp::List set_arbitrary_cols_to_zero
     Rcpp::IntegerVector indices,
     Rcpp::NumericVector values,
     Rcpp::IntegerVector cols_set,
-    const int ncols
+    const int ncols,
+    int nthreads
 )
 {
     const int nrows = indptr.size() - 1;
-    hashed_set<int> cols_set_(cols_set.begin(), cols_set.end());
-    const int col_min = *std::min_element(cols_set.begin(), cols_set.end());
-    const int col_max = *std::max_element(cols_set.begin(), cols_set.end());
+    const int *restrict indptr_ = INTEGER(indptr);
+    const int *restrict indices_ = INTEGER(indices);
+    const double *restrict values_ = REAL(values);
+    std::unique_ptr<char[]> is_set(new char[ncols]());
+    for (int col : cols_set)
+        is_set[col] = 1;
+    const char *restrict is_set_ = is_set.get();
+    nthreads = std::max(1, std::min(nthreads, nrows));
 
-    const int ncurr = std::accumulate(indices.begin(), indices.end(), 0,
-                                      [&cols_set_, &col_min, &col_max](const int tot, const int el)
-                                      {return tot + (el >= col_min &&
-                                                     el <= col_max &&
-                                                     cols_set_.find(el) != cols_set_.end());});
-    if (ncurr == 0)
+    VectorConstructorArgs args;
+    args.as_integer = true; args.size = indptr.size();
+    Rcpp::IntegerVector indptr_new = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    int *restrict indptr_new_ = INTEGER(indptr_new);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+            shared(indptr_, indices_, is_set_, indptr_new_)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        int n_this = 0;
+        for (int ix = indptr_[row]; ix < indptr_[row+1]; ix++)
+            n_this += !is_set_[indices_[ix]];
+        indptr_new_[row+1] = n_this;
+    }
+
+    indptr_new_[0] = 0;
+    for (int row = 0; row < nrows; row++)
+        indptr_new_[row+1] += indptr_new_[row];
+
+    if (indptr_new_[nrows] == indptr_[nrows])
     {
         return Rcpp::List::create(
             Rcpp::_["indptr"] = indptr,
@@ -1625,32 +1657,29 @@ Rcpp::List set_arbitrary_cols_to_zero
         );
     }
 
-    VectorConstructorArgs args;
-    args.as_integer = true; args.size = indptr.size();
-    Rcpp::IntegerVector indptr_new = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    args.size = indices.size() - ncurr;
+    args.size = indptr_new_[nrows];
     Rcpp::IntegerVector indices_new = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
     args.as_integer = false;
     Rcpp::NumericVector values_new = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    int *restrict indices_new_ = INTEGER(indices_new);
+    double *restrict values_new_ = REAL(values_new);
 
-    std::unique_ptr<int[]> ix_take(new int[ncols]);
-    int n_this;
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+            shared(indptr_, indices_, values_, is_set_, indptr_new_, indices_new_, values_new_)
+    #endif
     for (int row = 0; row < nrows; row++)
     {
-        n_this = 0;
-        for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-        {
-            if (indices[ix] < col_min || indices[ix] > col_max || cols_set_.find(indices[ix]) == cols_set_.end())
-                ix_take[n_this++] = ix;
-        }
-        if (n_this)
+        int curr = indptr_new_[row];
+        for (int ix = indptr_[row]; ix < indptr_[row+1]; ix++)
         {
-            for (int ix = 0; ix < n_this; ix++)
-                indices_new[indptr_new[row] + ix] = indices[ix_take[ix]];
-            for (int ix = 0; ix < n_this; ix++)
-                values_new[indptr_new[row] + ix] = values[ix_take[ix]];
+            if (!is_set_[indices_[ix]])
+            {
+                indices_new_[curr] = indices_[ix];
+                values_new_[curr] = values_[ix];
+                curr++;
+            }
         }
-        indptr_new[row+1] = indptr_new[row] + n_this;
     }
 
     return Rcpp::List::create(
@@ -1668,40 +1697,64 @@ Rcpp::List set_arbitrary_cols_to_const
     Rcpp::NumericVector values,
     Rcpp::IntegerVector cols_set,
     const int ncols,
-    const double val_set
+    const double val_set,
+    int nthreads
 )
 {
     const int nrows = indptr.size() - 1;
     std::sort(cols_set.begin(), cols_set.end());
-    hashed_set<int> cols_set_(cols_set.begin(), cols_set.end());
-    const int col_min = *std::min_element(cols_set.begin(), cols_set.end());
-    const int col_max = *std::max_element(cols_set.begin(), cols_set.end());
-
-    const int ncurr = std::accumulate(indices.begin(), indices.end(), 0,
-                                      [&cols_set_, &col_min, &col_max](const int tot, const int el)
-                                      {return tot + (el >= col_min &&
-                                                     el <= col_max &&
-                                                     cols_set_.find(el) != cols_set_.end());});
-    const int diff = nrows*cols_set.size() - ncurr;
     const int n_fill = cols_set.size();
+    int *restrict indptr_ = INTEGER(indptr);
+    int *restrict indices_ = INTEGER(indices);
+    double *restrict values_ = REAL(values);
+    int *restrict cols_set_ = INTEGER(cols_set);
+    std::unique_ptr<char[]> is_set(new char[ncols]());
+    for (int col : cols_set)
+        is_set[col] = 1;
+    const char *restrict is_set_ = is_set.get();
+    nthreads = std::max(1, std::min(nthreads, nrows));
 
     VectorConstructorArgs args;
+    args.as_integer = true; args.size = indptr.size();
+    Rcpp::IntegerVector indptr_new = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    int *restrict indptr_new_ = INTEGER(indptr_new);
 
-    if (diff == 0)
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+            shared(indptr_, indices_, is_set_, indptr_new_)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        int n_this = 0;
+        for (int ix = indptr_[row]; ix < indptr_[row+1]; ix++)
+            n_this += !is_set_[indices_[ix]];
+        indptr_new_[row+1] = n_this + n_fill;
+    }
+
+    size_large nnz_new = 0;
+    for (int row = 0; row < nrows; row++)
+        nnz_new += indptr_new_[row+1];
+    if (nnz_new >= INT_MAX)
+        Rcpp::stop("Error: resulting matrix would be larger than INT_MAX limit.\n");
+    indptr_new_[0] = 0;
+    for (int row = 0; row < nrows; row++)
+        indptr_new_[row+1] += indptr_new_[row];
+
+    if (indptr_new_[nrows] == indptr_[nrows])
     {
-        args.as_integer = false; args.size = values.size(); args.from_pointer = true;
-        args.num_pointer_from = (void*)((double*)(values.begin()));
-        Rcpp::NumericVector values_new = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+        Rcpp::NumericVector values_new = get_values_for_overwrite(values);
+        double *restrict values_new_ = REAL(values_new);
 
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+                shared(indptr_, indices_, is_set_, values_new_)
+        #endif
         for (int row = 0; row < nrows; row++)
         {
-            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
+            for (int ix = indptr_[row]; ix < indptr_[row+1]; ix++)
             {
-                if (indices[ix] >= col_min && indices[ix] <= col_max &&
-                    cols_set_.find(indices[ix]) != cols_set_.end())
-                {
-                    values_new[ix] = val_set;
-                }
+                if (is_set_[indices_[ix]])
+                    values_new_[ix] = val_set;
             }
         }
 
@@ -1712,77 +1765,64 @@ Rcpp::List set_arbitrary_cols_to_const
         );
     }
 
-    check_max_size(diff, indices);
-
-    args.as_integer = true; args.size = indptr.size();
-    Rcpp::IntegerVector indptr_new = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    args.size = indices.size() + diff;
+    args.size = indptr_new_[nrows];
     Rcpp::IntegerVector indices_new = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
     args.as_integer = false;
     Rcpp::NumericVector values_new = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    int *restrict indices_new_ = INTEGER(indices_new);
+    double *restrict values_new_ = REAL(values_new);
 
-    std::unique_ptr<int[]> ix_take(new int[ncols]);
-    std::unique_ptr<int[]> buffer(new int[size_times_ratio_dbl(ncols)]);
-
-    if (ncurr == 0)
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads) \
+            shared(indptr_, indices_, values_, cols_set_, is_set_, indptr_new_, indices_new_, values_new_)
+    #endif
     {
+        std::unique_ptr<int[]> argsorted(new int[ncols]);
+        std::unique_ptr<int[]> buffer(new int[size_times_ratio_dbl(ncols)]);
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 256)
+        #endif
         for (int row = 0; row < nrows; row++)
         {
-            std::copy(cols_set.begin(),
-                      cols_set.end(),
-                      indices_new.begin() + indptr_new[row]);
-            std::copy(indices.begin() + indptr[row],
-                      indices.begin() + indptr[row+1],
-                      indices_new.begin() + indptr_new[row] + n_fill);
-            std::fill_n(values_new.begin() + indptr_new[row], n_fill, val_set);
-            std::copy(values.begin() + indptr[row],
-                      values.begin() + indptr[row+1],
-                      values_new.begin() + indptr_new[row] + n_fill);
+            const int n_before = indptr_[row+1] - indptr_[row];
+            if (check_is_sorted(indices_ + indptr_[row], n_before))
+            {
+                set_cols_in_row_to_const_value(
+                    indices_ + indptr_[row],
+                    values_ + indptr_[row],
+                    n_before,
+                    cols_set_,
+                    n_fill,
+                    val_set,
+                    indices_new_ + indptr_new_[row],
+                    values_new_ + indptr_new_[row]
+                );
+                continue;
+            }
+
+            int curr = indptr_new_[row];
+            for (int ix = indptr_[row]; ix < indptr_[row+1]; ix++)
+            {
+                if (!is_set_[indices_[ix]])
+                {
+                    indices_new_[curr] = indices_[ix];
+                    values_new_[curr] = values_[ix];
+                    curr++;
+                }
+            }
+            std::copy(cols_set_, cols_set_ + n_fill, indices_new_ + curr);
+            std::fill_n(values_new_ + curr, n_fill, val_set);
+
             check_and_sort_single_row_inplace(
-                indices_new.begin() + indptr_new[row],
-                values_new.begin() + indptr_new[row],
-                ix_take.get(),
+                indices_new_ + indptr_new_[row],
+                values_new_ + indptr_new_[row],
+                argsorted.get(),
                 buffer.get(),
-                n_fill + indptr[row+1] - indptr[row],
-                indptr[row] == indptr[row+1]
+                indptr_new_[row+1] - indptr_new_[row],
+                false
             );
-            indptr_new[row+1] = indptr_new[row] + n_fill + indptr[row+1] - indptr[row];
-        }
-
-        return Rcpp::List::create(
-            Rcpp::_["indptr"] = indptr_new,
-            Rcpp::_["indices"] = indices_new,
-            Rcpp::_["values"] = values_new
-        );
-    }
-
-    int n_this;
-    
-    for (int row = 0; row < nrows; row++)
-    {
-        n_this = 0;
-        for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-        {
-            if (indices[ix] < col_min || indices[ix] > col_max || cols_set_.find(indices[ix]) == cols_set_.end())
-                ix_take[n_this++] = ix;
         }
-        for (int ix = 0; ix < n_this; ix++)
-            indices_new[indptr_new[row] + ix] = indices[ix_take[ix]];
-        std::copy(cols_set.begin(), cols_set.end(), indices_new.begin() + indptr_new[row] + n_this);
-        for (int ix = 0; ix < n_this; ix++)
-            values_new[indptr_new[row] + ix] = values[ix_take[ix]];
-        std::fill_n(values_new.begin() + indptr_new[row] + n_this, n_fill, val_set);
-
-        check_and_sort_single_row_inplace(
-            indices_new.begin() + indptr_new[row],
-            values_new.begin() + indptr_new[row],
-            ix_take.get(),
-            buffer.get(),
-            n_fill + n_this,
-            indptr[row] == indptr[row+1]
-        );
-
-        indptr_new[row+1] = indptr_new[row] + n_fill + n_this;
     }
 
     return Rcpp::List::create(
@@ -1930,7 +1970,7 @@ Rcpp::List set_arbitrary_rows_single_col_to_const
 
     if (diff == 0)
     {
-        Rcpp::NumericVector values_new(values.begin(), values.end());
+        Rcpp::NumericVector values_new = get_values_for_overwrite(values);
 
         for (int row : rows_set)
             for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
@@ -2194,18 +2234,13 @@ Rcpp::List set_single_row_arbitrary_cols_to_const
 
     if (new_size == size_before)
     {
-        Rcpp::NumericVector values_new(values.begin(), values.end());
-
-        set_cols_in_row_to_const_value(
-            indices.begin() + indptr[row_set],
-            values.begin() + indptr[row_set],
-            size_before,
-            cols_set.begin(),
-            cols_set.size(),
-            val_set,
-            indices.begin() + indptr[row_set],
-            values_new.begin() + indptr[row_set]
-        );
+        Rcpp::NumericVector values_new = get_values_for_overwrite(values);
+
+        for (int ix = indptr[row_set]; ix < indptr[row_set+1]; ix++)
+        {
+            if (std::binary_search(cols_set.begin(), cols_set.end(), indices[ix]))
+                values_new[ix] = val_set;
+        }
 
         return Rcpp::List::create(
             Rcpp::_["indptr"] = indptr,
@@ -2258,36 +2293,59 @@ Rcpp::List set_arbitrary_rows_arbitrary_cols_to_zero
     Rcpp::NumericVector values,
     Rcpp::IntegerVector rows_set,
     Rcpp::IntegerVector cols_set,
-    const int ncols
+    const int ncols,
+    int nthreads
 )
 {
-    std::unique_ptr<int[]> argsorted(new int[ncols]);
-    std::unique_ptr<int[]> buffer(new int[size_times_ratio_dbl(ncols)]);
-    Rcpp::IntegerVector indptr_new(indptr.size());
+    const int nrows = indptr.size() - 1;
+    const int n_rows_set = rows_set.size();
+    const int n_cols_set = cols_set.size();
     std::sort(cols_set.begin(), cols_set.end());
-
+    int *restrict indptr_ = INTEGER(indptr);
+    int *restrict indices_ = INTEGER(indices);
+    double *restrict values_ = REAL(values);
+    int *restrict rows_set_ = INTEGER(rows_set);
+    int *restrict cols_set_ = INTEGER(cols_set);
+    Rcpp::IntegerVector indptr_new(indptr.size());
+    int *restrict indptr_new_ = INTEGER(indptr_new);
     int ncurr = 0;
-    int n_this;
-    for (int row : rows_set)
+
+    /* Note: the rows are unique (duplicates are handled on the R side),
+       so each thread sorts a different part of the input. */
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(std::max(1, std::min(nthreads, n_rows_set))) \
+            shared(indptr_, indices_, values_, rows_set_, cols_set_, indptr_new_) \
+            reduction(+:ncurr)
+    #endif
     {
-        n_this = indptr[row+1] - indptr[row];
-        if (n_this)
+        std::unique_ptr<int[]> argsorted(new int[ncols]);
+        std::unique_ptr<int[]> buffer(new int[size_times_ratio_dbl(ncols)]);
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 64)
+        #endif
+        for (int ix = 0; ix < n_rows_set; ix++)
         {
-            check_and_sort_single_row_inplace(
-                indices.begin() + indptr[row],
-                values.begin() + indptr[row],
-                argsorted.get(),
-                buffer.get(),
-                n_this,
-                true
-            );
-            indptr_new[row+1] = sizeof_setdiff(
-                indices.begin() + indptr[row],
-                cols_set.begin(),
-                n_this,
-                cols_set.size()
-            ) - n_this;
-            ncurr += -indptr_new[row+1];
+            const int row = rows_set_[ix];
+            const int n_this = indptr_[row+1] - indptr_[row];
+            if (n_this)
+            {
+                check_and_sort_single_row_inplace(
+                    indices_ + indptr_[row],
+                    values_ + indptr_[row],
+                    argsorted.get(),
+                    buffer.get(),
+                    n_this,
+                    true
+                );
+                indptr_new_[row+1] = sizeof_setdiff(
+                    indices_ + indptr_[row],
+                    cols_set_,
+                    n_this,
+                    n_cols_set
+                ) - n_this;
+                ncurr += -indptr_new_[row+1];
+            }
         }
     }
 
@@ -2300,56 +2358,45 @@ Rcpp::List set_arbitrary_rows_arbitrary_cols_to_zero
         );
     }
 
-    argsorted.reset();
-    buffer.reset();
-
-    const int nrows = indptr.size()-1;
     Rcpp::IntegerVector indices_new(indices.size() - ncurr);
     Rcpp::NumericVector values_new(indices.size() - ncurr);
-    std::sort(rows_set.begin(), rows_set.end());
+    int *restrict indices_new_ = INTEGER(indices_new);
+    double *restrict values_new_ = REAL(values_new);
+    std::unique_ptr<char[]> row_is_set(new char[nrows]());
+    for (int row : rows_set)
+        row_is_set[row] = 1;
+    const char *restrict row_is_set_ = row_is_set.get();
 
     for (int row = 0; row < nrows; row++)
-        indptr_new[row+1] += indptr_new[row] + indptr[row+1] - indptr[row];
+        indptr_new_[row+1] += indptr_new_[row] + indptr_[row+1] - indptr_[row];
 
-    int row = 0;
-    auto curr_ix = rows_set.begin();
-    const auto end_ix = rows_set.end();
-    while (true)
+    nthreads = std::max(1, std::min(nthreads, nrows));
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+            shared(indptr_, indices_, values_, row_is_set_, cols_set_, indptr_new_, indices_new_, values_new_)
+    #endif
+    for (int row = 0; row < nrows; row++)
     {
-        if (curr_ix >= end_ix || row >= nrows) {
-            if (row < nrows) {
-                std::copy(indices.begin() + indptr[row], indices.end(), indices_new.begin() + indptr_new[row]);
-                std::copy(values.begin() + indptr[row], values.end(), values_new.begin() + indptr_new[row]);
-            }
-            break;
-        }
-
-        else if (*curr_ix == row) {
+        if (row_is_set_[row])
+        {
             remove_cols_from_row(
-                indices.begin() + indptr[row],
-                values.begin() + indptr[row],
-                indptr[row+1] - indptr[row],
-                cols_set.begin(),
-                cols_set.size(),
-                indices_new.begin() + indptr_new[row],
-                values_new.begin() + indptr_new[row]
+                indices_ + indptr_[row],
+                values_ + indptr_[row],
+                indptr_[row+1] - indptr_[row],
+                cols_set_,
+                n_cols_set,
+                indices_new_ + indptr_new_[row],
+                values_new_ + indptr_new_[row]
             );
-            curr_ix++;
-            row++;
         }
 
-        else {
-            std::copy(indices.begin() + indptr[row],
-                      indices.begin() + indptr[*curr_ix],
-                      indices_new.begin() + indptr_new[row]);
-            std::copy(values.begin() + indptr[row],
-                      values.begin() + indptr[*curr_ix],
-                      values_new.begin() + indptr_new[row]);
-            row = *curr_ix;
+        else
+        {
+            std::copy(indices_ + indptr_[row], indices_ + indptr_[row+1], indices_new_ + indptr_new_[row]);
+            std::copy(values_ + indptr_[row], values_ + indptr_[row+1], values_new_ + indptr_new_[row]);
         }
     }
 
-
     return Rcpp::List::create(
         Rcpp::_["indptr"] = indptr_new,
         Rcpp::_["indices"] = indices_new,
@@ -2366,52 +2413,81 @@ Rcpp::List set_arbitrary_rows_arbitrary_cols_to_const
     Rcpp::IntegerVector rows_set,
     Rcpp::IntegerVector cols_set,
     const int ncols,
-    const double val_set
+    const double val_set,
+    int nthreads
 )
 {
-    std::unique_ptr<int[]> argsorted(new int[ncols]);
-    std::unique_ptr<int[]> buffer(new int[size_times_ratio_dbl(ncols)]);
-    Rcpp::IntegerVector indptr_new(indptr.size());
-    std::sort(cols_set.begin(), cols_set.end());
+    const int nrows = indptr.size() - 1;
+    const int n_rows_set = rows_set.size();
     const int n_fill = cols_set.size();
+    std::sort(cols_set.begin(), cols_set.end());
+    int *restrict indptr_ = INTEGER(indptr);
+    int *restrict indices_ = INTEGER(indices);
+    double *restrict values_ = REAL(values);
+    int *restrict rows_set_ = INTEGER(rows_set);
+    int *restrict cols_set_ = INTEGER(cols_set);
+    Rcpp::IntegerVector indptr_new(indptr.size());
+    int *restrict indptr_new_ = INTEGER(indptr_new);
+    size_large diff = 0;
 
-    int diff = 0;
-    int n_this;
-    for (int row : rows_set)
+    /* Note: the rows are unique (duplicates are handled on the R side),
+       so each thread sorts a different part of the input. */
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(std::max(1, std::min(nthreads, n_rows_set))) \
+            shared(indptr_, indices_, values_, rows_set_, cols_set_, indptr_new_) \
+            reduction(+:diff)
+    #endif
     {
-        n_this = indptr[row+1] - indptr[row];
-        check_and_sort_single_row_inplace(
-            indices.begin() + indptr[row],
-            values.begin() + indptr[row],
-            argsorted.get(),
-            buffer.get(),
-            n_this,
-            true
-        );
-        indptr_new[row+1] = -sizeof_setintersect(
-            indices.begin() + indptr[row],
-            cols_set.begin(),
-            n_this, n_fill
-        ) + n_fill;
-        diff += indptr_new[row+1];
+        std::unique_ptr<int[]> argsorted(new int[ncols]);
+        std::unique_ptr<int[]> buffer(new int[size_times_ratio_dbl(ncols)]);
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 64)
+        #endif
+        for (int ix = 0; ix < n_rows_set; ix++)
+        {
+            const int row = rows_set_[ix];
+            const int n_this = indptr_[row+1] - indptr_[row];
+            check_and_sort_single_row_inplace(
+                indices_ + indptr_[row],
+                values_ + indptr_[row],
+                argsorted.get(),
+                buffer.get(),
+                n_this,
+                true
+            );
+            indptr_new_[row+1] = -sizeof_setintersect(
+                indices_ + indptr_[row],
+                cols_set_,
+                n_this, n_fill
+            ) + n_fill;
+            diff += indptr_new_[row+1];
+        }
     }
 
+    nthreads = std::max(1, std::min(nthreads, nrows));
+
     if (diff == 0)
     {
-        Rcpp::NumericVector values_new(values.begin(), values.end());
-
-        for (int row : rows_set)
+        Rcpp::NumericVector values_new = get_values_for_overwrite(values);
+        double *restrict values_new_ = REAL(values_new);
+        std::unique_ptr<char[]> col_is_set(new char[ncols]());
+        for (int col : cols_set)
+            col_is_set[col] = 1;
+        const char *restrict col_is_set_ = col_is_set.get();
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 64) num_threads(std::max(1, std::min(nthreads, n_rows_set))) \
+                shared(indptr_, indices_, rows_set_, col_is_set_, values_new_)
+        #endif
+        for (int ix = 0; ix < n_rows_set; ix++)
         {
-            set_cols_in_row_to_const_value(
-                indices.begin() + indptr[row],
-                values.begin() + indptr[row],
-                indptr[row+1] - indptr[row],
-                cols_set.begin(),
-                n_fill,
-                val_set,
-                indices.begin() + indptr[row],
-                values_new.begin() + indptr[row]
-            );
+            const int row = rows_set_[ix];
+            for (int jx = indptr_[row]; jx < indptr_[row+1]; jx++)
+            {
+                if (col_is_set_[indices_[jx]])
+                    values_new_[jx] = val_set;
+            }
         }
 
         return Rcpp::List::create(
@@ -2421,50 +2497,44 @@ Rcpp::List set_arbitrary_rows_arbitrary_cols_to_const
         );
     }
 
-    const int nrows = indptr.size()-1;
+    if (diff >= (size_large)INT_MAX - (size_large)indices.size())
+        Rcpp::stop("Error: resulting matrix would be larger than INT_MAX limit.\n");
     Rcpp::IntegerVector indices_new(indices.size() + diff);
     Rcpp::NumericVector values_new(indices.size() + diff);
-    std::sort(rows_set.begin(), rows_set.end());
+    int *restrict indices_new_ = INTEGER(indices_new);
+    double *restrict values_new_ = REAL(values_new);
+    std::unique_ptr<char[]> row_is_set(new char[nrows]());
+    for (int row : rows_set)
+        row_is_set[row] = 1;
+    const char *restrict row_is_set_ = row_is_set.get();
 
     for (int row = 0; row < nrows; row++)
-        indptr_new[row+1] += indptr_new[row] + indptr[row+1] - indptr[row];
+        indptr_new_[row+1] += indptr_new_[row] + indptr_[row+1] - indptr_[row];
 
-    int row = 0;
-    auto curr_ix = rows_set.begin();
-    const auto end_ix = rows_set.end();
-    while (true)
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+            shared(indptr_, indices_, values_, row_is_set_, cols_set_, indptr_new_, indices_new_, values_new_)
+    #endif
+    for (int row = 0; row < nrows; row++)
     {
-        if (curr_ix >= end_ix || row >= nrows) {
-            if (row < nrows) {
-                std::copy(indices.begin() + indptr[row], indices.end(), indices_new.begin() + indptr_new[row]);
-                std::copy(values.begin() + indptr[row], values.end(), values_new.begin() + indptr_new[row]);
-            }
-            break;
-        }
-
-        else if (*curr_ix == row) {
+        if (row_is_set_[row])
+        {
             set_cols_in_row_to_const_value(
-                indices.begin() + indptr[row],
-                values.begin() + indptr[row],
-                indptr[row+1] - indptr[row],
-                cols_set.begin(),
+                indices_ + indptr_[row],
+                values_ + indptr_[row],
+                indptr_[row+1] - indptr_[row],
+                cols_set_,
                 n_fill,
                 val_set,
-                indices_new.begin() + indptr_new[row],
-                values_new.begin() + indptr_new[row]
+                indices_new_ + indptr_new_[row],
+                values_new_ + indptr_new_[row]
             );
-            curr_ix++;
-            row++;
         }
 
-        else {
-            std::copy(indices.begin() + indptr[row],
-                      indices.begin() + indptr[*curr_ix],
-                      indices_new.begin() + indptr_new[row]);
-            std::copy(values.begin() + indptr[row],
-                      values.begin() + indptr[*curr_ix],
-                      values_new.begin() + indptr_new[row]);
-            row = *curr_ix;
+        else
+        {
+            std::copy(indices_ + indptr_[row], indices_ + indptr_[row+1], indices_new_ + indptr_new_[row]);
+            std::copy(values_ + indptr_[row], values_ + indptr_[row+1], values_new_ + indptr_new_[row]);
         }
     }
 
@@ -2601,6 +2671,197 @@ Rcpp::List set_arbitrary_rows_to_smat
 #   pragma clang diagnostic pop
 #endif
 
+/* Merges the entries of a row with those of an update for the same row, both
+   sorted by column, with the update taking precedence when both have the same
+   column. Entries that the update sets to zero are removed. If 'indices_new'
+   is passed as NULL, will only count the number of resulting entries. */
+static inline int merge_row_with_update
+(
+    const int *restrict indices,
+    const double *restrict values,
+    const int n,
+    const int *restrict indices_upd,
+    const double *restrict values_upd,
+    const int n_upd,
+    int *restrict indices_new,
+    double *restrict values_new
+)
+{
+    int ix = 0, jx = 0, n_out = 0;
+    while (ix < n || jx < n_upd)
+    {
+        if (jx >= n_upd || (ix < n && indices[ix] < indices_upd[jx]))
+        {
+            if (indices_new) {
+                indices_new[n_out] = indices[ix];
+                values_new[n_out] = values[ix];
+            }
+            n_out++;
+            ix++;
+        }
+
+        else
+        {
+            if (ix < n && indices[ix] == indices_upd[jx])
+                ix++;
+            if (values_upd[jx] != 0)
+            {
+                if (indices_new) {
+                    indices_new[n_out] = indices_upd[jx];
+                    values_new[n_out] = values_upd[jx];
+                }
+                n_out++;
+            }
+            jx++;
+        }
+    }
+    return n_out;
+}
+
+/* Applies a batch of updates to a CSR matrix in a single pass, with the updates
+   passed as another CSR matrix of the same dimensions. Both need to have their
+   indices sorted, and the updates cannot have duplicated entries. */
+// [[Rcpp::export(rng = false)]]
+Rcpp::List set_csr_entries_from_csr
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    Rcpp::NumericVector values,
+    Rcpp::IntegerVector indptr_upd,
+    Rcpp::IntegerVector indices_upd,
+    Rcpp::NumericVector values_upd,
+    int nthreads
+)
+{
+    const int nrows = indptr.size() - 1;
+    const int *restrict indptr_ = INTEGER(indptr);
+    const int *restrict indices_ = INTEGER(indices);
+    const double *restrict values_ = REAL(values);
+    const int *restrict indptr_upd_ = INTEGER(indptr_upd);
+    const int *restrict indices_upd_ = INTEGER(indices_upd);
+    const double *restrict values_upd_ = REAL(values_upd);
+    nthreads = std::max(1, std::min(nthreads, nrows));
+
+    std::unique_ptr<size_large[]> indptr_temp(new size_large[(size_t)nrows + 1]);
+    indptr_temp[0] = 0;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+            shared(indptr_, indices_, values_, indptr_upd_, indices_upd_, values_upd_, indptr_temp)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        indptr_temp[row+1] = merge_row_with_update(
+            indices_ + indptr_[row],
+            values_ + indptr_[row],
+            indptr_[row+1] - indptr_[row],
+            indices_upd_ + indptr_upd_[row],
+            values_upd_ + indptr_upd_[row],
+            indptr_upd_[row+1] - indptr_upd_[row],
+            nullptr, nullptr
+        );
+    }
+
+    for (int row = 0; row < nrows; row++)
+        indptr_temp[row+1] += indptr_temp[row];
+    if (indptr_temp[nrows] >= (size_large)INT_MAX)
+        Rcpp::stop("Error: resulting matrix would be larger than INT_MAX limit.\n");
+
+    VectorConstructorArgs args;
+    args.as_integer = true; args.size = indptr.size();
+    Rcpp::IntegerVector indptr_new = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    args.size = indptr_temp[nrows];
+    Rcpp::IntegerVector indices_new = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    args.as_integer = false;
+    Rcpp::NumericVector values_new = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    int *restrict indptr_new_ = INTEGER(indptr_new);
+    int *restrict indices_new_ = INTEGER(indices_new);
+    double *restrict values_new_ = REAL(values_new);
+    for (int row = 0; row <= nrows; row++)
+        indptr_new_[row] = indptr_temp[row];
+    indptr_temp.reset();
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+            shared(indptr_, indices_, values_, indptr_upd_, indices_upd_, values_upd_, \
+                   indptr_new_, indices_new_, values_new_)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        merge_row_with_update(
+            indices_ + indptr_[row],
+            values_ + indptr_[row],
+            indptr_[row+1] - indptr_[row],
+            indices_upd_ + indptr_upd_[row],
+            values_upd_ + indptr_upd_[row],
+            indptr_upd_[row+1] - indptr_upd_[row],
+            indices_new_ + indptr_new_[row],
+            values_new_ + indptr_new_[row]
+        );
+    }
+
+    return Rcpp::List::create(
+        Rcpp::_["indptr"] = indptr_new,
+        Rcpp::_["indices"] = indices_new,
+        Rcpp::_["values"] = values_new
+    );
+}
+
+/* Replaces the diagonal of a CSR matrix when all of the diagonal entries are already
+   present in its sparsity pattern, in which case the structure doesn't change and
+   only the values need to be overwritten. Otherwise, returns NULL without modifying
+   anything, and the assignment is left to the general-purpose code. 'diag_values'
+   must have either a single value or 'ndiag' values. */
+// [[Rcpp::export(rng = false)]]
+SEXP set_diag_csr_existing
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    Rcpp::NumericVector values,
+    Rcpp::NumericVector diag_values,
+    const int ndiag,
+    int nthreads
+)
+{
+    const int *restrict indptr_ = INTEGER(indptr);
+    const int *restrict indices_ = INTEGER(indices);
+    std::unique_ptr<int[]> positions(new int[std::max(ndiag, 1)]);
+    int *restrict positions_ = positions.get();
+    bool all_present = true;
+    nthreads = std::max(1, std::min(nthreads, ndiag / 256));
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads) \
+            shared(indptr_, indices_, positions_) reduction(&&:all_present)
+    #endif
+    for (int row = 0; row < ndiag; row++)
+    {
+        const int *end = indices_ + indptr_[row+1];
+        const int *res = find_col_in_row(indices_ + indptr_[row], end, row);
+        if (res == end)
+            all_present = false;
+        else
+            positions_[row] = res - indices_;
+    }
+
+    if (!all_present)
+        return R_NilValue;
+
+    Rcpp::NumericVector values_new = get_values_for_overwrite(values);
+    double *restrict values_new_ = REAL(values_new);
+    const double *restrict diag_values_ = REAL(diag_values);
+    const bool is_const = diag_values.size() == 1;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads) \
+            shared(positions_, values_new_, diag_values_)
+    #endif
+    for (int row = 0; row < ndiag; row++)
+        values_new_[positions_[row]] = diag_values_[is_const? 0 : row];
+
+    return values_new;
+}
+
 // [[Rcpp::export(rng = false)]]
 bool check_shapes_are_assignable_2d(double x1, double x2, double y1, double y2)
 {
@@ -158,3 +158,91 @@ Rcpp::List cbind_csr_binary
         Rcpp::NumericVector()
     );
 }
+
+/* Concatenates many CSR matrices (all of the same type as 'out') by columns
+   into 'out', which should have its slots already allocated to the right sizes.
+
+   The row lengths of the output are computed first (in parallel) and
+   then each row is filled by copying the corresponding row from each
+   input, with the column indices shifted by the column offset of
+   that input. Inputs with fewer rows are taken as padded with empty rows. */
+// [[Rcpp::export(rng = false)]]
+Rcpp::S4 concat_csr_batch_cols(Rcpp::ListOf<Rcpp::S4> objects, Rcpp::S4 out, int nthreads)
+{
+    const int n_inputs = objects.size();
+    const bool is_numeric = out.inherits("dgRMatrix");
+    const bool is_logical = out.inherits("lgRMatrix");
+    const int nrows = INTEGER(out.slot("Dim"))[0];
+
+    int *restrict indptr_out = INTEGER(out.slot("p"));
+    int *restrict indices_out = INTEGER(out.slot("j"));
+    double *restrict values_out = is_numeric? REAL(out.slot("x")) : nullptr;
+    int *restrict values_out_bool = is_logical? LOGICAL(out.slot("x")) : nullptr;
+
+    std::vector<const int*> indptrs(n_inputs);
+    std::vector<const int*> indices(n_inputs);
+    std::vector<const double*> xvals(n_inputs);
+    std::vector<const int*> lvals(n_inputs);
+    std::vector<int> nrows_inputs(n_inputs);
+    std::vector<int> col_offsets(n_inputs);
+    int curr_col = 0;
+    for (int ix = 0; ix < n_inputs; ix++)
+    {
+        indptrs[ix] = INTEGER(objects[ix].slot("p"));
+        indices[ix] = INTEGER(objects[ix].slot("j"));
+        if (is_numeric)
+            xvals[ix] = REAL(objects[ix].slot("x"));
+        else if (is_logical)
+            lvals[ix] = LOGICAL(objects[ix].slot("x"));
+        nrows_inputs[ix] = INTEGER(objects[ix].slot("Dim"))[0];
+        col_offsets[ix] = curr_col;
+        curr_col += INTEGER(objects[ix].slot("Dim"))[1];
+    }
+
+    indptr_out[0] = 0;
+    if (!nrows)
+        return out;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads) \
+            shared(indptrs, nrows_inputs, indptr_out)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        int nnz_row = 0;
+        for (int ix = 0; ix < n_inputs; ix++)
+            if (row < nrows_inputs[ix])
+                nnz_row += indptrs[ix][row+1] - indptrs[ix][row];
+        indptr_out[row+1] = nnz_row;
+    }
+
+    for (int row = 0; row < nrows; row++)
+        indptr_out[row+1] += indptr_out[row];
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 64) num_threads(nthreads) \
+            shared(indptrs, indices, xvals, lvals, nrows_inputs, col_offsets, \
+                   indptr_out, indices_out, values_out, values_out_bool)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        int pos = indptr_out[row];
+        for (int ix = 0; ix < n_inputs; ix++)
+        {
+            if (row >= nrows_inputs[ix])
+                continue;
+            const int st = indptrs[ix][row];
+            const int n_this = indptrs[ix][row+1] - st;
+            const int offset = col_offsets[ix];
+            for (int el = 0; el < n_this; el++)
+                indices_out[pos + el] = indices[ix][st + el] + offset;
+            if (is_numeric)
+                std::copy(xvals[ix] + st, xvals[ix] + st + n_this, values_out + pos);
+            else if (is_logical)
+                std::copy(lvals[ix] + st, lvals[ix] + st + n_this, values_out_bool + pos);
+            pos += n_this;
+        }
+    }
+
+    return out;
+}
@@ -39,6 +39,18 @@ static inline void F77_CALL(scopy)(const int *n, const float *x, const int *incx
     }
 }
 
+static inline float F77_CALL(sdot)(const int *n, const float *x, const int *incx, const float *y, const int *incy)
+{
+    const int n_ = *n;
+    const int inc_x = *incx;
+    const int inc_y = *incy;
+    double res = 0;
+    for (int ix = 0; ix < n_; ix++) {
+        res += (double)x[ix*inc_x] * (double)y[ix*inc_y];
+    }
+    return res;
+}
+
 
 static inline void axpy(const int *n, const double* alpha, const double *x, const int* incx, double* y, const int* incy)
 {
@@ -77,6 +89,45 @@ static inline void tcopy(const int *n, const float* x, const int *incx, float *y
     F77_CALL(scopy)(n, x, incx, y, incy);
 }
 
+static inline double tdot(const int *n, const double *x, const int *incx, const double *y, const int *incy)
+{
+    return F77_CALL(ddot)(n, x, incx, y, incy);
+}
+
+static inline double tdot(const int *n, const float *x, const int *incx, const float *y, const int *incy)
+{
+    return F77_CALL(sdot)(n, x, incx, y, incy);
+}
+
+/* Splits the rows of a CSR matrix into contiguous blocks (one per thread) with
+   roughly the same number of non-zero entries each, so that matrices with very
+   uneven row lengths (e.g. power-law graphs) do not leave threads idle. Will
+   reduce the number of threads when there isn't enough work to split. The
+   blocks are given by 'row_st[tid]' (inclusive) to 'row_st[tid+1]' (exclusive). */
+static int nnz_balanced_row_blocks
+(
+    const int nrows,
+    const int *restrict indptr,
+    int nthreads,
+    std::unique_ptr<int[]> &row_st
+)
+{
+    const size_t nnz = indptr[nrows] - indptr[0];
+    nthreads = std::max(1, std::min(nthreads, nrows));
+    if (nnz < (size_t)nthreads * 256)
+        nthreads = std::max((size_t)1, nnz / 256);
+    row_st = std::unique_ptr<int[]>(new int[nthreads+1]);
+    row_st[0] = 0;
+    row_st[nthreads] = nrows;
+    for (int tid = 1; tid < nthreads; tid++)
+    {
+        const int nnz_st = indptr[0] + (int)(((size_large)nnz * (size_large)tid) / (size_large)nthreads);
+        row_st[tid] = std::lower_bound(indptr, indptr + nrows, nnz_st) - indptr;
+        row_st[tid] = std::max(row_st[tid], row_st[tid-1]);
+    }
+    return nthreads;
+}
+
 /* Mental map to figure out what should be called where:
 
 matmul(x,y) -> x %*% y
@@ -103,6 +154,90 @@ The required functions are:
     with all the dense ones being column-major
 */
 
+/* Specialized kernel for when 'n' (number of columns in B and X) is small, such as when
+   multiplying by a tall-and-skinny dense matrix (block of vectors): instead of calling 'axpy'
+   for each non-zero entry, takes the columns in groups of compile-time widths, so that the
+   accumulators for a given row can be kept in registers, and writes them to X at the end.
+
+   The output can be either row-major or column-major, according to the strides passed. */
+constexpr const int gemm_max_n_small = 32;
+
+template <class real_t, int width>
+static inline void gemm_csr_row_small_n
+(
+    const int row,
+    const int *restrict indptr, const int *restrict indices, const double *restrict values,
+    const real_t *restrict DenseMat, const size_t ldb,
+    real_t *restrict out_ptr, const size_t stride_col
+)
+{
+    real_t acc[width] = {0};
+    for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
+    {
+        const real_t *restrict B_row = DenseMat + (size_t)indices[ix]*ldb;
+        const real_t val = values[ix];
+        for (int col = 0; col < width; col++)
+            acc[col] += val * B_row[col];
+    }
+    for (int col = 0; col < width; col++)
+        out_ptr[(size_t)col * stride_col] += acc[col];
+}
+
+template <class real_t>
+void gemm_csr_drm_small_n
+(
+    const int m, const int n,
+    const int *restrict indptr, const int *restrict indices, const double *restrict values,
+    const real_t *restrict DenseMat, const size_t ldb,
+    real_t *restrict OutputMat, const size_t stride_row, const size_t stride_col,
+    int nthreads
+)
+{
+    std::unique_ptr<int[]> row_st;
+    nthreads = nnz_balanced_row_blocks(m, indptr, nthreads, row_st);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+            shared(OutputMat, DenseMat, indptr, indices, values, row_st)
+    #endif
+    for (int tid = 0; tid < nthreads; tid++)
+    {
+        for (int row = row_st[tid]; row < row_st[tid+1]; row++)
+        {
+            if (indptr[row] == indptr[row+1])
+                continue;
+            real_t *restrict out_row = OutputMat + (size_t)row*stride_row;
+            int col = 0;
+            while (col < n)
+            {
+                const int remaining = n - col;
+                const real_t *restrict B_st = DenseMat + col;
+                real_t *restrict out_st = out_row + (size_t)col*stride_col;
+                if (remaining >= 16) {
+                    gemm_csr_row_small_n<real_t, 16>(row, indptr, indices, values, B_st, ldb, out_st, stride_col);
+                    col += 16;
+                }
+                else if (remaining >= 8) {
+                    gemm_csr_row_small_n<real_t, 8>(row, indptr, indices, values, B_st, ldb, out_st, stride_col);
+                    col += 8;
+                }
+                else if (remaining >= 4) {
+                    gemm_csr_row_small_n<real_t, 4>(row, indptr, indices, values, B_st, ldb, out_st, stride_col);
+                    col += 4;
+                }
+                else if (remaining >= 2) {
+                    gemm_csr_row_small_n<real_t, 2>(row, indptr, indices, values, B_st, ldb, out_st, stride_col);
+                    col += 2;
+                }
+                else {
+                    gemm_csr_row_small_n<real_t, 1>(row, indptr, indices, values, B_st, ldb, out_st, stride_col);
+                    col += 1;
+                }
+            }
+        }
+    }
+}
+
 /* X <- A*B + X | A(m,k) is sparse CSR, B(k,n) is dense row-major, X(m,n) is dense row-major
 
    Equivalences:
@@ -127,6 +262,15 @@ void gemm_csr_drm_as_drm
 {
     if (m <= 0 || indptr[0] == indptr[m])
         return;
+    nthreads = get_effective_nthreads(
+        nthreads, (double)(indptr[m] - indptr[0]) * (double)n, min_work_per_thread_gemm
+    );
+    if (n <= gemm_max_n_small) {
+        gemm_csr_drm_small_n<real_t>(
+            m, n, indptr, indices, values, DenseMat, ldb, OutputMat, ldc, 1, nthreads
+        );
+        return;
+    }
     real_t *restrict row_ptr;
     #ifdef _OPENMP
     #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
@@ -146,9 +290,12 @@ void gemm_csr_drm_as_drm
    When X is zeroed-out:
    X <- A*t(B) | A(m,k) CSR, B(n,k) column-major, X(m,n) column-major
 
+   This variant computes each row separately into a buffer and then copies it
+   to the output with stride 'ldc', which becomes slow when 'n' is large, as
+   every write then lands on a different cache line and memory page.
 */
 template <class real_t>
-void gemm_csr_drm_as_dcm
+void gemm_csr_drm_as_dcm_by_row
 (
     const int m, const int n,
     const int *restrict indptr, const int *restrict indices, const double *restrict values,
@@ -157,10 +304,7 @@ void gemm_csr_drm_as_dcm
     int nthreads
 )
 {
-    if (m <= 0 || indptr[0] == indptr[m])
-        return;
     real_t *restrict write_ptr;
-    nthreads = std::min(nthreads, m);
     std::unique_ptr<real_t[]> temp_arr;
     #ifdef _OPENMP
     #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
@@ -173,10 +317,10 @@ void gemm_csr_drm_as_dcm
         {
             write_ptr = temp_arr.get();
             if (!write_ptr) {
-                temp_arr = std::unique_ptr<real_t[]>(new real_t[ldc]);
+                temp_arr = std::unique_ptr<real_t[]>(new real_t[n]);
                 write_ptr = temp_arr.get();
             }
-            memset(write_ptr, 0, ldb*sizeof(real_t));
+            memset(write_ptr, 0, (size_t)n*sizeof(real_t));
             for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
                 axpy(&n, values + ix, DenseMat + (size_t)indices[ix]*ldb, &one, write_ptr, &one);
             tcopy(&n, write_ptr, &one, OutputMat + row, &ldc);
@@ -184,6 +328,101 @@ void gemm_csr_drm_as_dcm
     }
 }
 
+/* Same as above, but tiled: takes blocks of 'tile_rows' rows and 'tile_cols' columns,
+   accumulates them into a small row-major tile, and then writes the transpose of the
+   tile into the output column by column, so that each write to the output covers a
+   contiguous stretch of 'tile_rows' entries instead of a single one. The tile is
+   small enough to remain in L1/L2 cache while it's being accumulated and copied. */
+constexpr const int gemm_dcm_tile_rows = 32;
+constexpr const int gemm_dcm_tile_cols = 256;
+constexpr const int gemm_dcm_min_n_tiled = 64;
+
+template <class real_t>
+void gemm_csr_drm_as_dcm_tiled
+(
+    const int m, const int n,
+    const int *restrict indptr, const int *restrict indices, const double *restrict values,
+    const real_t *restrict DenseMat, const size_t ldb,
+    real_t *restrict OutputMat, const int ldc,
+    int nthreads
+)
+{
+    const int n_row_blocks = (m + gemm_dcm_tile_rows - 1) / gemm_dcm_tile_rows;
+    const int n_col_blocks = (n + gemm_dcm_tile_cols - 1) / gemm_dcm_tile_cols;
+    nthreads = std::min(nthreads, n_row_blocks);
+    std::unique_ptr<real_t[]> tile;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(OutputMat, DenseMat, indptr, indices, values) \
+            private(tile)
+    #endif
+    for (int block = 0; block < n_row_blocks; block++)
+    {
+        const int row_st = block * gemm_dcm_tile_rows;
+        const int row_end = std::min(m, row_st + gemm_dcm_tile_rows);
+        const int nrows_tile = row_end - row_st;
+        if (indptr[row_st] == indptr[row_end])
+            continue;
+        if (!tile)
+            tile = std::unique_ptr<real_t[]>(new real_t[(size_t)gemm_dcm_tile_rows * (size_t)gemm_dcm_tile_cols]);
+        real_t *restrict tile_ptr = tile.get();
+
+        for (int col_block = 0; col_block < n_col_blocks; col_block++)
+        {
+            const int col_st = col_block * gemm_dcm_tile_cols;
+            const int ncols_tile = std::min(n - col_st, gemm_dcm_tile_cols);
+            memset(tile_ptr, 0, (size_t)nrows_tile * (size_t)gemm_dcm_tile_cols * sizeof(real_t));
+
+            for (int row = row_st; row < row_end; row++)
+            {
+                real_t *restrict tile_row = tile_ptr + (size_t)(row - row_st) * (size_t)gemm_dcm_tile_cols;
+                for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
+                    axpy(&ncols_tile, values + ix,
+                         DenseMat + (size_t)indices[ix]*ldb + (size_t)col_st, &one,
+                         tile_row, &one);
+            }
+
+            for (int col = 0; col < ncols_tile; col++)
+            {
+                real_t *restrict out_col = OutputMat + (size_t)(col_st + col) * (size_t)ldc + (size_t)row_st;
+                for (int row = 0; row < nrows_tile; row++)
+                    out_col[row] = tile_ptr[(size_t)row * (size_t)gemm_dcm_tile_cols + (size_t)col];
+            }
+        }
+    }
+}
+
+template <class real_t>
+void gemm_csr_drm_as_dcm
+(
+    const int m, const int n,
+    const int *restrict indptr, const int *restrict indices, const double *restrict values,
+    const real_t *restrict DenseMat, const size_t ldb,
+    real_t *restrict OutputMat, const int ldc,
+    int nthreads
+)
+{
+    if (m <= 0 || n <= 0 || indptr[0] == indptr[m])
+        return;
+    nthreads = get_effective_nthreads(
+        nthreads, (double)(indptr[m] - indptr[0]) * (double)n, min_work_per_thread_gemm
+    );
+    nthreads = std::min(nthreads, m);
+    if (n <= gemm_max_n_small)
+        gemm_csr_drm_small_n<real_t>(
+            m, n, indptr, indices, values, DenseMat, ldb, OutputMat, 1, ldc, nthreads
+        );
+    else if (n >= gemm_dcm_min_n_tiled && m >= gemm_dcm_tile_rows)
+        gemm_csr_drm_as_dcm_tiled<real_t>(
+            m, n, indptr, indices, values, DenseMat, ldb, OutputMat, ldc, nthreads
+        );
+    else
+        gemm_csr_drm_as_dcm_by_row<real_t>(
+            m, n, indptr, indices, values, DenseMat, ldb, OutputMat, ldc, nthreads
+        );
+}
+
 /* x %*% y */
 template <class RcppMatrix>
 RcppMatrix matmul_dense_csc(RcppMatrix X_colmajor,
@@ -192,9 +431,11 @@ RcppMatrix matmul_dense_csc(RcppMatrix X_colmajor,
                             Rcpp::NumericVector Y_csc_values,
                             int nthreads)
 {
+    profile_kernel("matmul_dense_csc");
     int nrows_X = X_colmajor.nrow();
     int ncols_Y = Y_csc_indptr.size() - 1;
     RcppMatrix out_colmajor(nrows_X, ncols_Y);
+    profile_count_allocation(out_colmajor);
     int nrows = out_colmajor.nrow();
     int ncols = out_colmajor.ncol();
 
@@ -258,7 +499,9 @@ RcppMatrix tcrossprod_dense_csr(RcppMatrix X_colmajor,
                                 Rcpp::NumericVector Y_csr_values,
                                 int nthreads, int ncols_Y)
 {
+    profile_kernel("tcrossprod_dense_csr");
     RcppMatrix out_colmajor(X_colmajor.nrow(), Y_csr_indptr.size()-1);
+    profile_count_allocation(out_colmajor);
 
     if (std::is_same<RcppMatrix, Rcpp::NumericMatrix>::value)
         gemm_csr_drm_as_drm<double>(
@@ -320,7 +563,9 @@ RcppMatrix tcrossprod_csr_dense(Rcpp::IntegerVector X_csr_indptr,
                                 RcppMatrix Y_colmajor,
                                 int nthreads)
 {
+    profile_kernel("tcrossprod_csr_dense");
     RcppMatrix out_colmajor(X_csr_indptr.size()-1, Y_colmajor.nrow());
+    profile_count_allocation(out_colmajor);
 
     if (std::is_same<RcppMatrix, Rcpp::NumericMatrix>::value)
         gemm_csr_drm_as_dcm<double>(
@@ -374,46 +619,243 @@ Rcpp::IntegerMatrix tcrossprod_csr_dense_float32(Rcpp::IntegerVector X_csr_indpt
     );
 }
 
+/* Sampled dense-dense product (SDDMM): calculates the entries of A %*% t(B) only
+   at the positions of the non-zeros of a CSR matrix, taking the sparsity pattern
+   of it as output structure. The dense matrices are passed transposed (i.e.
+   'At' is k-by-m and 'Bt' is k-by-n, both column-major), so that the rows of
+   A and B which enter each dot product are contiguous in memory.
+
+   This is O(nnz*k), while computing the full product first and then taking the
+   entries of the mask would be O(m*n*k) time and O(m*n) memory. */
+template <class real_t>
+static void sddmm_csr_template
+(
+    const int nrows,
+    const int *restrict indptr,
+    const int *restrict indices,
+    const real_t *restrict At,
+    const real_t *restrict Bt,
+    const int k,
+    double *restrict out,
+    int nthreads
+)
+{
+    nthreads = get_effective_nthreads(
+        nthreads, (double)(indptr[nrows] - indptr[0]) * (double)k, min_work_per_thread_sddmm
+    );
+    std::unique_ptr<int[]> row_st;
+    nthreads = nnz_balanced_row_blocks(nrows, indptr, nthreads, row_st);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+            shared(indptr, indices, At, Bt, out, row_st)
+    #endif
+    for (int tid = 0; tid < nthreads; tid++)
+    {
+        for (int row = row_st[tid]; row < row_st[tid+1]; row++)
+        {
+            const real_t *restrict a_row = At + (size_t)row * (size_t)k;
+            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
+                out[ix] = tdot(&k, a_row, &one, Bt + (size_t)indices[ix] * (size_t)k, &one);
+        }
+    }
+}
+
+template <class RcppMatrix>
+static Rcpp::NumericVector sddmm_csr
+(
+    Rcpp::IntegerVector mask_csr_indptr,
+    Rcpp::IntegerVector mask_csr_indices,
+    RcppMatrix At_colmajor,
+    RcppMatrix Bt_colmajor,
+    int nthreads
+)
+{
+    profile_kernel("sddmm_csr");
+    VectorConstructorArgs args;
+    args.size = mask_csr_indices.size();
+    Rcpp::NumericVector out = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    const int nrows = mask_csr_indptr.size() - 1;
+    const int k = At_colmajor.nrow();
+    if (!nrows || !out.size())
+        return out;
+    if (!k) {
+        std::fill(out.begin(), out.end(), 0.);
+        return out;
+    }
+
+    if (std::is_same<RcppMatrix, Rcpp::NumericMatrix>::value)
+        sddmm_csr_template<double>(
+            nrows, INTEGER(mask_csr_indptr), INTEGER(mask_csr_indices),
+            REAL(At_colmajor), REAL(Bt_colmajor), k,
+            REAL(out), nthreads
+        );
+    else
+        sddmm_csr_template<float>(
+            nrows, INTEGER(mask_csr_indptr), INTEGER(mask_csr_indices),
+            (float*)INTEGER(At_colmajor), (float*)INTEGER(Bt_colmajor), k,
+            REAL(out), nthreads
+        );
+
+    return out;
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::NumericVector sddmm_csr_numeric(Rcpp::IntegerVector mask_csr_indptr,
+                                      Rcpp::IntegerVector mask_csr_indices,
+                                      Rcpp::NumericMatrix At_colmajor,
+                                      Rcpp::NumericMatrix Bt_colmajor,
+                                      int nthreads)
+{
+    return sddmm_csr<Rcpp::NumericMatrix>(
+        mask_csr_indptr,
+        mask_csr_indices,
+        At_colmajor,
+        Bt_colmajor,
+        nthreads
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::NumericVector sddmm_csr_float32(Rcpp::IntegerVector mask_csr_indptr,
+                                      Rcpp::IntegerVector mask_csr_indices,
+                                      Rcpp::IntegerMatrix At_colmajor,
+                                      Rcpp::IntegerMatrix Bt_colmajor,
+                                      int nthreads)
+{
+    return sddmm_csr<Rcpp::IntegerMatrix>(
+        mask_csr_indptr,
+        mask_csr_indices,
+        At_colmajor,
+        Bt_colmajor,
+        nthreads
+    );
+}
+
 /* TODO: these matrix-by-vector multiplications could be done more
    efficiently for symmetric matrices and for unit diagonal */
 
+template <class OutputDType, bool is_logical, class YDType>
+static inline OutputDType dvec_value(const YDType y)
+{
+    return is_logical? (OutputDType)(y != 0) : (OutputDType)y;
+}
+
+/* Dot product between a sparse row and a dense vector. The accumulation is
+   done in four independent sums so that the compiler can interleave
+   the gathers from 'y' and vectorize the multiplications (it cannot
+   do that with a single accumulator without being allowed to reorder
+   floating point additions).
+
+   If 'check_NA' is passed, the entries of 'y' (integer or logical)
+   are checked for NAs, which will make the whole result NA. */
+template <class YDType, class OutputDType, bool is_logical, bool check_NA>
+static inline OutputDType dot_csr_row_dvec
+(
+    const int *restrict indices,
+    const double *restrict values,
+    const int n,
+    const YDType *restrict y
+)
+{
+    OutputDType s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int ix = 0;
+    #define yval(ix) dvec_value<OutputDType, is_logical>(y[indices[ix]])
+    if (check_NA)
+    {
+        for (; ix < n; ix++)
+        {
+            if (y[indices[ix]] == NA_INTEGER)
+                return NA_REAL;
+            s0 += values[ix] * yval(ix);
+        }
+        return s0;
+    }
+
+    const int n_unrolled = n - (n % 4);
+    for (; ix < n_unrolled; ix += 4)
+    {
+        s0 += values[ix  ] * yval(ix  );
+        s1 += values[ix+1] * yval(ix+1);
+        s2 += values[ix+2] * yval(ix+2);
+        s3 += values[ix+3] * yval(ix+3);
+    }
+    for (; ix < n; ix++)
+        s0 += values[ix] * yval(ix);
+    #undef yval
+    return (s0 + s1) + (s2 + s3);
+}
+
+template <class YDType, class OutputDType, bool is_logical, bool check_NA>
+static void matmul_csr_dvec_template
+(
+    const int nrows,
+    const int *restrict indptr,
+    const int *restrict indices,
+    const double *restrict values,
+    const YDType *restrict y,
+    OutputDType *restrict out,
+    int nthreads
+)
+{
+    nthreads = get_effective_nthreads(
+        nthreads, (double)(indptr[nrows] - indptr[0]), min_work_per_thread_matvec
+    );
+    std::unique_ptr<int[]> row_st;
+    nthreads = nnz_balanced_row_blocks(nrows, indptr, nthreads, row_st);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+            shared(indptr, indices, values, y, out, row_st)
+    #endif
+    for (int tid = 0; tid < nthreads; tid++)
+    {
+        for (int row = row_st[tid]; row < row_st[tid+1]; row++)
+            out[row] = dot_csr_row_dvec<YDType, OutputDType, is_logical, check_NA>(
+                indices + indptr[row], values + indptr[row], indptr[row+1] - indptr[row], y
+            );
+    }
+}
+
 /* x %*% y */
-template <class RcppVector, class OutputVector, class OutputDType>
+template <class YDType, bool is_logical, class OutputVector, class OutputDType>
 OutputVector matmul_csr_dvec(Rcpp::IntegerVector X_csr_indptr,
                              Rcpp::IntegerVector X_csr_indices,
                              Rcpp::NumericVector X_csr_values,
-                             RcppVector y_dense,
+                             const YDType *restrict y_dense,
+                             const size_t y_size,
                              int nthreads)
 {
+    profile_kernel("matmul_csr_dvec");
     // Rcpp::NumericVector out(X_csr_indptr.size()-1);
     OutputVector out_(X_csr_indptr.size()-1);
+    profile_count_allocation(out_);
     OutputDType *restrict out;
     if (std::is_same<OutputDType, float>::value)
         out = (OutputDType*)INTEGER(out_);
     else
         out = (OutputDType*)REAL(out_);
     const int nrows = out_.size();
-
-    #ifdef _OPENMP
-    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
-            shared(X_csr_indptr, X_csr_indices, X_csr_values, y_dense)
-    #endif
-    for (int row = 0; row < nrows; row++)
-    {
-        OutputDType val = 0;
-        for (int ix = X_csr_indptr[row]; ix < X_csr_indptr[row+1]; ix++)
-        {
-            if (std::is_same<RcppVector, Rcpp::IntegerVector>::value)
-                val += (y_dense[X_csr_indices[ix]] == NA_INTEGER)?
-                        NA_REAL : X_csr_values[ix] * y_dense[X_csr_indices[ix]];
-            else if (std::is_same<RcppVector, Rcpp::LogicalVector>::value)
-                val += (y_dense[X_csr_indices[ix]] == NA_LOGICAL)?
-                        NA_REAL : X_csr_values[ix] * (bool)y_dense[X_csr_indices[ix]];
-            else
-                val += X_csr_values[ix] * y_dense[X_csr_indices[ix]];
-        }
-        out[row] = val;
-    }
+    if (!nrows)
+        return out_;
+
+    const int *restrict indptr = INTEGER(X_csr_indptr);
+    const int *restrict indices = INTEGER(X_csr_indices);
+    const double *restrict values = REAL(X_csr_values);
+
+    /* For integer and logical inputs, NAs are checked only once here,
+       so that the product can be computed without branches when there
+       aren't any. For floating point types, NAs propagate by themselves. */
+    const bool has_NA = std::is_same<YDType, int>::value &&
+                        std::find(y_dense, y_dense + y_size, NA_INTEGER) != y_dense + y_size;
+    if (has_NA)
+        matmul_csr_dvec_template<YDType, OutputDType, is_logical, true>(
+            nrows, indptr, indices, values, y_dense, out, nthreads
+        );
+    else
+        matmul_csr_dvec_template<YDType, OutputDType, is_logical, false>(
+            nrows, indptr, indices, values, y_dense, out, nthreads
+        );
 
     return out_;
 }
@@ -425,11 +867,12 @@ Rcpp::NumericVector matmul_csr_dvec_numeric(Rcpp::IntegerVector X_csr_indptr,
                                             Rcpp::NumericVector y_dense,
                                             int nthreads)
 {
-    return matmul_csr_dvec<Rcpp::NumericVector, Rcpp::NumericVector, double>(
+    return matmul_csr_dvec<double, false, Rcpp::NumericVector, double>(
         X_csr_indptr,
         X_csr_indices,
         X_csr_values,
-        y_dense,
+        REAL(y_dense),
+        y_dense.size(),
         nthreads
     );
 }
@@ -441,11 +884,12 @@ Rcpp::NumericVector matmul_csr_dvec_integer(Rcpp::IntegerVector X_csr_indptr,
                                             Rcpp::IntegerVector y_dense,
                                             int nthreads)
 {
-    return matmul_csr_dvec<Rcpp::IntegerVector, Rcpp::NumericVector, double>(
+    return matmul_csr_dvec<int, false, Rcpp::NumericVector, double>(
         X_csr_indptr,
         X_csr_indices,
         X_csr_values,
-        y_dense,
+        INTEGER(y_dense),
+        y_dense.size(),
         nthreads
     );
 }
@@ -457,11 +901,12 @@ Rcpp::NumericVector matmul_csr_dvec_logical(Rcpp::IntegerVector X_csr_indptr,
                                             Rcpp::LogicalVector y_dense,
                                             int nthreads)
 {
-    return matmul_csr_dvec<Rcpp::LogicalVector, Rcpp::NumericVector, double>(
+    return matmul_csr_dvec<int, true, Rcpp::NumericVector, double>(
         X_csr_indptr,
         X_csr_indices,
         X_csr_values,
-        y_dense,
+        LOGICAL(y_dense),
+        y_dense.size(),
         nthreads
     );
 }
@@ -473,15 +918,117 @@ Rcpp::IntegerVector matmul_csr_dvec_float32(Rcpp::IntegerVector X_csr_indptr,
                                             Rcpp::IntegerVector y_dense,
                                             int nthreads)
 {
-    return matmul_csr_dvec<float*, Rcpp::IntegerVector, float>(
+    return matmul_csr_dvec<float, false, Rcpp::IntegerVector, float>(
         X_csr_indptr,
         X_csr_indices,
         X_csr_values,
         (float*)INTEGER(y_dense),
+        y_dense.size(),
         nthreads
     );
 }
 
+/* Same as 'matmul_csr_dvec_numeric', but taking the matrix from a memory-mapped file */
+// [[Rcpp::export(rng = false)]]
+Rcpp::NumericVector matmul_csr_dvec_mmap(SEXP mapped_ptr,
+                                         Rcpp::NumericVector y_dense,
+                                         int nthreads)
+{
+    MappedCSR *mapped = get_mapped_csr(mapped_ptr);
+    if (mapped->values_type != MappedNumeric)
+        Rcpp::stop("Matrix-vector products are only supported for numeric matrices.");
+    check_all_mapped_indices(mapped);
+    Rcpp::NumericVector out(mapped->nrows);
+    if (mapped->nrows)
+        matmul_csr_dvec_template<double, double, false, false>(
+            mapped->nrows, mapped->indptr, mapped->indices, (const double*)mapped->values,
+            REAL(y_dense), REAL(out), nthreads
+        );
+    return out;
+}
+
+/* Sparse vectors are passed with their values in different formats - this
+   returns them as double, with NAs converted to R's double NA. Binary vectors
+   are passed with a placeholder pointer as values. */
+template <class RcppVector>
+static inline double svec_value_as_double(const RcppVector &y_values, const size_t ix)
+{
+    if (std::is_same<RcppVector, Rcpp::IntegerVector>::value)
+        return (y_values[ix] == NA_INTEGER)? NA_REAL : (double)y_values[ix];
+    else if (std::is_same<RcppVector, Rcpp::LogicalVector>::value)
+        return (y_values[ix] == NA_LOGICAL)? NA_REAL : (double)(bool)y_values[ix];
+    else if (std::is_same<RcppVector, char*>::value)
+        return 1.;
+    else
+        return (double)y_values[ix];
+}
+
+/* Matrix-sparse vector product that first creates a lookup of the entries of
+   the vector (a bitmap telling which columns are non-zero, plus a dense array
+   with the values, which is only written and read at those columns), and then
+   streams over all the non-zeros of the matrix checking them against it. This
+   is faster than intersecting the indices of each row with the vector when the
+   rows are short, as there's no per-row search involved, and since the bitmap
+   takes one bit per column, it typically stays in cache for the whole pass.
+
+   Entries of the matrix that don't match with the vector are skipped rather
+   than multiplied by zero, so that infinites in the matrix do not produce NaNs
+   where the vector has no entry. */
+template <class RcppVector>
+static void matmul_csr_svec_lookup(const int nrows, const int ncols,
+                                   const int *restrict indptr,
+                                   const int *restrict indices,
+                                   const double *restrict values,
+                                   Rcpp::IntegerVector y_indices_base1,
+                                   RcppVector y_values,
+                                   double *restrict out,
+                                   int nthreads)
+{
+    const size_t nwords = ((size_t)ncols + 63) / 64;
+    std::unique_ptr<uint64_t[]> y_bitmap(new uint64_t[nwords]());
+    std::unique_ptr<double[]> y_lookup(new double[ncols]);
+    const size_t nnz_y = y_indices_base1.size();
+    for (size_t ix = 0; ix < nnz_y; ix++)
+    {
+        const int col = y_indices_base1[ix] - 1;
+        y_bitmap[col >> 6] |= UINT64_C(1) << (col & 63);
+        y_lookup[col] = svec_value_as_double<RcppVector>(y_values, ix);
+    }
+    const uint64_t *restrict bitmap = y_bitmap.get();
+    const double *restrict lookup = y_lookup.get();
+
+    nthreads = get_effective_nthreads(
+        nthreads, (double)(indptr[nrows] - indptr[0]), min_work_per_thread_matvec
+    );
+    std::unique_ptr<int[]> row_st;
+    nthreads = nnz_balanced_row_blocks(nrows, indptr, nthreads, row_st);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+            shared(indptr, indices, values, bitmap, lookup, out, row_st)
+    #endif
+    for (int tid = 0; tid < nthreads; tid++)
+    {
+        for (int row = row_st[tid]; row < row_st[tid+1]; row++)
+        {
+            double res = 0;
+            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
+            {
+                const int col = indices[ix];
+                if (bitmap[col >> 6] & (UINT64_C(1) << (col & 63)))
+                    res += values[ix] * lookup[col];
+            }
+            out[row] = res;
+        }
+    }
+}
+
+/* The lookup is used when the rows are not much longer than the vector (in
+   which case the intersection would need to look at most of their entries
+   anyway), and when the matrix has enough non-zeros to make up for the cost
+   of allocating the lookup over all of its columns. */
+constexpr const double svec_lookup_max_row_len_ratio = 4;
+
 /* x %*% y */
 template <class RcppVector>
 Rcpp::NumericVector matmul_csr_svec(Rcpp::IntegerVector X_csr_indptr,
@@ -489,17 +1036,39 @@ Rcpp::NumericVector matmul_csr_svec(Rcpp::IntegerVector X_csr_indptr,
                                     Rcpp::NumericVector X_csr_values,
                                     Rcpp::IntegerVector y_indices_base1,
                                     RcppVector y_values,
+                                    const int ncols,
                                     int nthreads)
 {
+    profile_kernel("matmul_csr_svec");
     Rcpp::NumericVector out(X_csr_indptr.size()-1);
+    profile_count_allocation(out);
     if (!y_indices_base1.size())
         return out;
     const int nrows = out.size();
+    if (!nrows)
+        return out;
+
+    const double nnz_X = (double)X_csr_indices.size();
+    if (nnz_X >= (double)ncols &&
+        nnz_X <= svec_lookup_max_row_len_ratio * (double)y_indices_base1.size() * (double)nrows)
+    {
+        matmul_csr_svec_lookup<RcppVector>(
+            nrows, ncols,
+            INTEGER(X_csr_indptr), INTEGER(X_csr_indices), REAL(X_csr_values),
+            y_indices_base1, y_values,
+            REAL(out), nthreads
+        );
+        return out;
+    }
 
     int *restrict ptr_X_indices = INTEGER(X_csr_indices);
     int *restrict ptr_y_indices = INTEGER(y_indices_base1);
     int *restrict end_y = ptr_y_indices + y_indices_base1.size();
     int *ptr1, *ptr2, *end1;
+    nthreads = get_effective_nthreads(
+        nthreads, (double)X_csr_indices.size() + (double)nrows, min_work_per_thread_matvec
+    );
+    nthreads = std::max(1, std::min(nthreads, nrows));
 
     #ifdef _OPENMP
     #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
@@ -557,6 +1126,7 @@ Rcpp::NumericVector matmul_csr_svec_numeric(Rcpp::IntegerVector X_csr_indptr,
                                             Rcpp::NumericVector X_csr_values,
                                             Rcpp::IntegerVector y_indices_base1,
                                             Rcpp::NumericVector y_values,
+                                            const int ncols,
                                             int nthreads)
 {
     return matmul_csr_svec<Rcpp::NumericVector>(
@@ -565,6 +1135,7 @@ Rcpp::NumericVector matmul_csr_svec_numeric(Rcpp::IntegerVector X_csr_indptr,
         X_csr_values,
         y_indices_base1,
         y_values,
+        ncols,
         nthreads
     );
 }
@@ -575,6 +1146,7 @@ Rcpp::NumericVector matmul_csr_svec_integer(Rcpp::IntegerVector X_csr_indptr,
                                             Rcpp::NumericVector X_csr_values,
                                             Rcpp::IntegerVector y_indices_base1,
                                             Rcpp::IntegerVector y_values,
+                                            const int ncols,
                                             int nthreads)
 {
     return matmul_csr_svec<Rcpp::IntegerVector>(
@@ -583,6 +1155,7 @@ Rcpp::NumericVector matmul_csr_svec_integer(Rcpp::IntegerVector X_csr_indptr,
         X_csr_values,
         y_indices_base1,
         y_values,
+        ncols,
         nthreads
     );
 }
@@ -593,6 +1166,7 @@ Rcpp::NumericVector matmul_csr_svec_logical(Rcpp::IntegerVector X_csr_indptr,
                                             Rcpp::NumericVector X_csr_values,
                                             Rcpp::IntegerVector y_indices_base1,
                                             Rcpp::LogicalVector y_values,
+                                            const int ncols,
                                             int nthreads)
 {
     return matmul_csr_svec<Rcpp::LogicalVector>(
@@ -601,6 +1175,7 @@ Rcpp::NumericVector matmul_csr_svec_logical(Rcpp::IntegerVector X_csr_indptr,
         X_csr_values,
         y_indices_base1,
         y_values,
+        ncols,
         nthreads
     );
 }
@@ -610,6 +1185,7 @@ Rcpp::NumericVector matmul_csr_svec_binary(Rcpp::IntegerVector X_csr_indptr,
                                             Rcpp::IntegerVector X_csr_indices,
                                             Rcpp::NumericVector X_csr_values,
                                             Rcpp::IntegerVector y_indices_base1,
+                                            const int ncols,
                                             int nthreads)
 {
     return matmul_csr_svec<char*>(
@@ -618,6 +1194,7 @@ Rcpp::NumericVector matmul_csr_svec_binary(Rcpp::IntegerVector X_csr_indptr,
         X_csr_values,
         y_indices_base1,
         (char*)INTEGER(y_indices_base1), /* <- placeholder */
+        ncols,
         nthreads
     );
 }
@@ -628,6 +1205,7 @@ Rcpp::NumericVector matmul_csr_svec_float32(Rcpp::IntegerVector X_csr_indptr,
                                             Rcpp::NumericVector X_csr_values,
                                             Rcpp::IntegerVector y_indices_base1,
                                             Rcpp::IntegerVector y_values,
+                                            const int ncols,
                                             int nthreads)
 {
     return matmul_csr_svec<float*>(
@@ -636,10 +1214,214 @@ Rcpp::NumericVector matmul_csr_svec_float32(Rcpp::IntegerVector X_csr_indptr,
         X_csr_values,
         y_indices_base1,
         (float*)INTEGER(y_values),
+        ncols,
         nthreads
     );
 }
 
+/* t(x) %*% y | x is CSR, y is a sparse column vector, output is a sparse vector
+
+   Only the rows of 'x' selected by the non-zeros of 'y' are visited, and their
+   scaled entries are scattered into the output. When the number of products
+   is small compared to the number of columns of 'x' (e.g. very sparse queries
+   against a large matrix), they are collected as (column, value) pairs which
+   are then sorted and summed up, so that the cost doesn't depend on the number
+   of columns; otherwise, they are accumulated into a dense array.
+
+   This is also equivalent to t(y) %*% x with 'x' in CSC format, by passing the
+   matrix as a CSR matrix of its transpose.
+
+   The output will have its indices sorted and 0-based. Indices of 'y' need
+   not be sorted.
+
+   Values of 'x' can be numeric or logical, or NULL if 'x' is binary, in which
+   case they are taken as ones - this avoids converting such matrices to numeric
+   before the multiplication. */
+constexpr const double scatter_svec_dense_min_ratio = 0.125;
+
+template <class XDType>
+static inline double csr_value_as_double(const XDType *values, const size_t ix)
+{
+    if (std::is_same<XDType, int>::value)
+        return (values[ix] == NA_LOGICAL)? NA_REAL : (double)(bool)values[ix];
+    else if (std::is_same<XDType, char>::value)
+        return 1.;
+    else
+        return (double)values[ix];
+}
+
+template <class XDType, class RcppVector>
+static Rcpp::List crossprod_csr_svec(Rcpp::IntegerVector X_csr_indptr,
+                                     Rcpp::IntegerVector X_csr_indices,
+                                     const XDType *restrict values,
+                                     Rcpp::IntegerVector y_indices_base1,
+                                     RcppVector y_values,
+                                     const int ncols)
+{
+    profile_kernel("crossprod_csr_svec");
+    const int *restrict indptr = INTEGER(X_csr_indptr);
+    const int *restrict indices = INTEGER(X_csr_indices);
+    const size_t nnz_y = y_indices_base1.size();
+
+    size_t nprods = 0;
+    for (size_t ix = 0; ix < nnz_y; ix++) {
+        const int row = y_indices_base1[ix] - 1;
+        nprods += indptr[row+1] - indptr[row];
+    }
+
+    std::vector<int> out_indices;
+    std::vector<double> out_values;
+
+    if ((double)nprods >= scatter_svec_dense_min_ratio * (double)ncols)
+    {
+        std::vector<double> acc(ncols, 0.);
+        std::vector<char> seen(ncols, false);
+        for (size_t ix = 0; ix < nnz_y; ix++)
+        {
+            const int row = y_indices_base1[ix] - 1;
+            const double yval = svec_value_as_double<RcppVector>(y_values, ix);
+            for (int jx = indptr[row]; jx < indptr[row+1]; jx++) {
+                acc[indices[jx]] += csr_value_as_double<XDType>(values, jx) * yval;
+                seen[indices[jx]] = true;
+            }
+        }
+        for (int col = 0; col < ncols; col++) {
+            if (seen[col]) {
+                out_indices.push_back(col);
+                out_values.push_back(acc[col]);
+            }
+        }
+    }
+
+    else if (nprods)
+    {
+        std::vector<std::pair<int, double>> prods;
+        prods.reserve(nprods);
+        for (size_t ix = 0; ix < nnz_y; ix++)
+        {
+            const int row = y_indices_base1[ix] - 1;
+            const double yval = svec_value_as_double<RcppVector>(y_values, ix);
+            for (int jx = indptr[row]; jx < indptr[row+1]; jx++)
+                prods.emplace_back(indices[jx], csr_value_as_double<XDType>(values, jx) * yval);
+        }
+        std::stable_sort(prods.begin(), prods.end(),
+                         [](const std::pair<int, double> &a, const std::pair<int, double> &b)
+                         {return a.first < b.first;});
+        for (const auto &el : prods) {
+            if (!out_indices.empty() && out_indices.back() == el.first) {
+                out_values.back() += el.second;
+            }
+            else {
+                out_indices.push_back(el.first);
+                out_values.push_back(el.second);
+            }
+        }
+    }
+
+    VectorConstructorArgs args;
+    args.as_integer = true; args.from_cpp_vec = true; args.int_vec_from = &out_indices;
+    Rcpp::IntegerVector out_indices_ = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    args.as_integer = false; args.num_vec_from = &out_values;
+    Rcpp::NumericVector out_values_ = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    return Rcpp::List::create(
+        Rcpp::_["indices"] = out_indices_,
+        Rcpp::_["values"] = out_values_
+    );
+}
+
+template <class RcppVector>
+static Rcpp::List crossprod_csr_svec(Rcpp::IntegerVector X_csr_indptr,
+                                     Rcpp::IntegerVector X_csr_indices,
+                                     SEXP X_csr_values,
+                                     Rcpp::IntegerVector y_indices_base1,
+                                     RcppVector y_values,
+                                     const int ncols)
+{
+    if (X_csr_values == R_NilValue)
+        return crossprod_csr_svec<char, RcppVector>(
+            X_csr_indptr, X_csr_indices, (const char*)nullptr, y_indices_base1, y_values, ncols
+        );
+    else if (TYPEOF(X_csr_values) == LGLSXP)
+        return crossprod_csr_svec<int, RcppVector>(
+            X_csr_indptr, X_csr_indices, LOGICAL(X_csr_values), y_indices_base1, y_values, ncols
+        );
+    else
+        return crossprod_csr_svec<double, RcppVector>(
+            X_csr_indptr, X_csr_indices, REAL(X_csr_values), y_indices_base1, y_values, ncols
+        );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List crossprod_csr_svec_numeric(Rcpp::IntegerVector X_csr_indptr,
+                                      Rcpp::IntegerVector X_csr_indices,
+                                      SEXP X_csr_values,
+                                      Rcpp::IntegerVector y_indices_base1,
+                                      Rcpp::NumericVector y_values,
+                                      const int ncols)
+{
+    return crossprod_csr_svec<Rcpp::NumericVector>(
+        X_csr_indptr,
+        X_csr_indices,
+        X_csr_values,
+        y_indices_base1,
+        y_values,
+        ncols
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List crossprod_csr_svec_integer(Rcpp::IntegerVector X_csr_indptr,
+                                      Rcpp::IntegerVector X_csr_indices,
+                                      SEXP X_csr_values,
+                                      Rcpp::IntegerVector y_indices_base1,
+                                      Rcpp::IntegerVector y_values,
+                                      const int ncols)
+{
+    return crossprod_csr_svec<Rcpp::IntegerVector>(
+        X_csr_indptr,
+        X_csr_indices,
+        X_csr_values,
+        y_indices_base1,
+        y_values,
+        ncols
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List crossprod_csr_svec_logical(Rcpp::IntegerVector X_csr_indptr,
+                                      Rcpp::IntegerVector X_csr_indices,
+                                      SEXP X_csr_values,
+                                      Rcpp::IntegerVector y_indices_base1,
+                                      Rcpp::LogicalVector y_values,
+                                      const int ncols)
+{
+    return crossprod_csr_svec<Rcpp::LogicalVector>(
+        X_csr_indptr,
+        X_csr_indices,
+        X_csr_values,
+        y_indices_base1,
+        y_values,
+        ncols
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List crossprod_csr_svec_binary(Rcpp::IntegerVector X_csr_indptr,
+                                     Rcpp::IntegerVector X_csr_indices,
+                                     SEXP X_csr_values,
+                                     Rcpp::IntegerVector y_indices_base1,
+                                     const int ncols)
+{
+    return crossprod_csr_svec<char*>(
+        X_csr_indptr,
+        X_csr_indices,
+        X_csr_values,
+        y_indices_base1,
+        (char*)INTEGER(y_indices_base1), /* <- placeholder */
+        ncols
+    );
+}
+
 // [[Rcpp::export(rng = false)]]
 Rcpp::IntegerMatrix matmul_rowvec_by_csc
 (
@@ -937,6 +1719,193 @@ Rcpp::List matmul_spcolvec_by_scolvecascsr_binary
     );
 }
 
+/* Z <- X*Y | X(m,k) is sparse CSR, Y(k,n) is sparse CSR, Z(m,n) is sparse CSR
+
+   This is done in two passes over the rows of X, both parallelized by rows:
+    - A symbolic pass which determines how many non-zeros each row of Z will have.
+    - A numeric pass which fills them by accumulating into a dense array of size 'n'
+      (one per thread), keeping track of which entries were touched in each row.
+
+   The output will have its indices sorted. If either of the inputs is binary,
+   the corresponding values should be passed as NULL. */
+template <bool X_is_binary, bool Y_is_binary>
+Rcpp::List matmul_csr_csr
+(
+    Rcpp::IntegerVector X_csr_indptr,
+    Rcpp::IntegerVector X_csr_indices,
+    const double *restrict X_csr_values,
+    Rcpp::IntegerVector Y_csr_indptr,
+    Rcpp::IntegerVector Y_csr_indices,
+    const double *restrict Y_csr_values,
+    const int ncols_Y,
+    int nthreads
+)
+{
+    profile_kernel("matmul_csr_csr");
+    const int nrows = X_csr_indptr.size() - 1;
+    Rcpp::IntegerVector out_csr_indptr(nrows+1);
+    profile_count_allocation(out_csr_indptr);
+    int *restrict indptr_out = INTEGER(out_csr_indptr);
+    const int *restrict X_indptr = INTEGER(X_csr_indptr);
+    const int *restrict X_indices = INTEGER(X_csr_indices);
+    const int *restrict Y_indptr = INTEGER(Y_csr_indptr);
+    const int *restrict Y_indices = INTEGER(Y_csr_indices);
+
+    if (nrows <= 0 || ncols_Y <= 0 || X_indptr[nrows] == 0 || !Y_csr_indices.size())
+    {
+        return Rcpp::List::create(
+            Rcpp::_["indptr"] = out_csr_indptr,
+            Rcpp::_["indices"] = Rcpp::IntegerVector(),
+            Rcpp::_["values"] = Rcpp::NumericVector()
+        );
+    }
+
+    /* The number of multiply-adds is estimated from the average row length of 'Y',
+       as calculating it exactly would need a full pass over the indices of 'X' */
+    const double avg_nnz_row_Y = (double)Y_csr_indices.size() / (double)(Y_csr_indptr.size() - 1);
+    nthreads = get_effective_nthreads(
+        nthreads, (double)(X_indptr[nrows] - X_indptr[0]) * avg_nnz_row_Y, min_work_per_thread_spgemm
+    );
+    nthreads = std::max(1, std::min(nthreads, nrows));
+    std::unique_ptr<int[]> last_seen(new int[(size_t)nthreads * (size_t)ncols_Y]);
+    std::fill(last_seen.get(), last_seen.get() + (size_t)nthreads * (size_t)ncols_Y, -1);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(X_indptr, X_indices, Y_indptr, Y_indices, last_seen, indptr_out)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        int *restrict marker = last_seen.get() + (size_t)omp_get_thread_num() * (size_t)ncols_Y;
+        int n_this = 0;
+        for (int ix = X_indptr[row]; ix < X_indptr[row+1]; ix++)
+        {
+            const int k = X_indices[ix];
+            for (int jx = Y_indptr[k]; jx < Y_indptr[k+1]; jx++)
+            {
+                if (marker[Y_indices[jx]] != row) {
+                    marker[Y_indices[jx]] = row;
+                    n_this++;
+                }
+            }
+        }
+        indptr_out[row+1] = n_this;
+    }
+
+    size_large nnz_out = 0;
+    for (int row = 0; row < nrows; row++)
+    {
+        nnz_out += indptr_out[row+1];
+        if (nnz_out > (size_large)INT_MAX)
+            Rcpp::stop("Error: the resulting matrix would have too many entries for a sparse CSR representation (int overflow).");
+        indptr_out[row+1] = (int)nnz_out;
+    }
+
+    VectorConstructorArgs args;
+    args.as_integer = true; args.size = nnz_out;
+    Rcpp::IntegerVector out_csr_indices_ = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    args.as_integer = false;
+    Rcpp::NumericVector out_csr_values_ = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    int *restrict indices_out = INTEGER(out_csr_indices_);
+    double *restrict values_out = REAL(out_csr_values_);
+
+    std::fill(last_seen.get(), last_seen.get() + (size_t)nthreads * (size_t)ncols_Y, -1);
+    std::unique_ptr<double[]> accumulators(new double[(size_t)nthreads * (size_t)ncols_Y]);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(X_indptr, X_indices, X_csr_values, Y_indptr, Y_indices, Y_csr_values, \
+                   last_seen, accumulators, indptr_out, indices_out, values_out)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        if (indptr_out[row] == indptr_out[row+1])
+            continue;
+        int *restrict marker = last_seen.get() + (size_t)omp_get_thread_num() * (size_t)ncols_Y;
+        double *restrict acc = accumulators.get() + (size_t)omp_get_thread_num() * (size_t)ncols_Y;
+        int *restrict row_indices = indices_out + indptr_out[row];
+        int n_this = 0;
+
+        for (int ix = X_indptr[row]; ix < X_indptr[row+1]; ix++)
+        {
+            const int k = X_indices[ix];
+            const double xval = X_is_binary? 1. : X_csr_values[ix];
+            for (int jx = Y_indptr[k]; jx < Y_indptr[k+1]; jx++)
+            {
+                const int col = Y_indices[jx];
+                const double prod = Y_is_binary? xval : (xval * Y_csr_values[jx]);
+                if (marker[col] != row) {
+                    marker[col] = row;
+                    acc[col] = prod;
+                    row_indices[n_this++] = col;
+                }
+                else {
+                    acc[col] += prod;
+                }
+            }
+        }
+
+        std::sort(row_indices, row_indices + n_this);
+        double *restrict row_values = values_out + indptr_out[row];
+        for (int ix = 0; ix < n_this; ix++)
+            row_values[ix] = acc[row_indices[ix]];
+    }
+
+    return Rcpp::List::create(
+        Rcpp::_["indptr"] = out_csr_indptr,
+        Rcpp::_["indices"] = out_csr_indices_,
+        Rcpp::_["values"] = out_csr_values_
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List matmul_csr_csr_numeric
+(
+    Rcpp::IntegerVector X_csr_indptr,
+    Rcpp::IntegerVector X_csr_indices,
+    Rcpp::NumericVector X_csr_values,
+    Rcpp::IntegerVector Y_csr_indptr,
+    Rcpp::IntegerVector Y_csr_indices,
+    Rcpp::NumericVector Y_csr_values,
+    const int ncols_Y,
+    int nthreads
+)
+{
+    return matmul_csr_csr<false, false>(
+        X_csr_indptr,
+        X_csr_indices,
+        REAL(X_csr_values),
+        Y_csr_indptr,
+        Y_csr_indices,
+        REAL(Y_csr_values),
+        ncols_Y,
+        nthreads
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List matmul_csr_csr_binary
+(
+    Rcpp::IntegerVector X_csr_indptr,
+    Rcpp::IntegerVector X_csr_indices,
+    Rcpp::IntegerVector Y_csr_indptr,
+    Rcpp::IntegerVector Y_csr_indices,
+    const int ncols_Y,
+    int nthreads
+)
+{
+    return matmul_csr_csr<true, true>(
+        X_csr_indptr,
+        X_csr_indices,
+        (double*)nullptr,
+        Y_csr_indptr,
+        Y_csr_indices,
+        (double*)nullptr,
+        ncols_Y,
+        nthreads
+    );
+}
+
 #ifdef __clang__
 #   pragma clang diagnostic pop
 #endif
@@ -5,6 +5,10 @@ SEXP SafeRcppVector(void *args_)
     VectorConstructorArgs *args = (VectorConstructorArgs*)args_;
     std::vector<int> *int_vec_from = (std::vector<int>*)args->int_vec_from;
     std::vector<double> *num_vec_from = (std::vector<double>*)args->num_vec_from;
+    if (args->from_cpp_vec && !args->cpp_lim_size)
+        profile_count_bytes(args->as_integer? int_vec_from->size() * sizeof(int) : num_vec_from->size() * sizeof(double));
+    else
+        profile_count_bytes(args->size * (args->as_integer? sizeof(int) : sizeof(double)));
     
     if (args->as_integer)
     {
@@ -88,6 +92,15 @@ bool contains_any_neg(Rcpp::NumericVector x)
     return false;
 }
 
+// [[Rcpp::export(rng = false)]]
+int find_first_non_na(Rcpp::IntegerVector x)
+{
+    for (auto el : x)
+        if (el != NA_INTEGER)
+            return el;
+    return NA_INTEGER;
+}
+
 bool contains_any_nas_or_inf(Rcpp::NumericVector x)
 {
     for (auto el : x)
@@ -96,23 +109,24 @@ bool contains_any_nas_or_inf(Rcpp::NumericVector x)
     return false;
 }
 
-// [[Rcpp::export(rng = false)]]
-int find_first_non_na(Rcpp::IntegerVector x)
+/* Whether two CSR matrices have the same sparsity pattern, either because they
+   share the same arrays or because the arrays have the same contents. */
+bool have_same_sparsity_pattern(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2,
+                                Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2)
 {
-    for (auto el : x)
-        if (el != NA_INTEGER)
-            return el;
-    return NA_INTEGER;
+    if (indptr1.size() != indptr2.size() || indices1.size() != indices2.size())
+        return false;
+    if (INTEGER(indptr1) == INTEGER(indptr2) && INTEGER(indices1) == INTEGER(indices2))
+        return true;
+    return std::equal(indptr1.begin(), indptr1.end(), indptr2.begin()) &&
+           std::equal(indices1.begin(), indices1.end(), indices2.begin());
 }
 
 // [[Rcpp::export(rng = false)]]
 bool is_same_ngRMatrix(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2,
                        Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2)
 {
-  return indptr1.size() == indptr2.size() &&
-         indices1.size() == indices2.size() &&
-         INTEGER(indptr1) == INTEGER(indptr2) &&
-         INTEGER(indices1) == INTEGER(indices2);
+    return have_same_sparsity_pattern(indptr1, indptr2, indices1, indices2);
 }
 
 bool check_is_sorted(int* vec, size_t n)
@@ -133,6 +147,55 @@ bool check_is_sorted(Rcpp::IntegerVector x)
     return check_is_sorted(x.begin(), x.size());
 }
 
+/* Finds the position of column 'col' within a row, returning 'end' if it's not there.
+   Tries a binary search first, which finds it directly when the row is sorted (an entry
+   equal to 'col' is the right one even if it isn't), falling back to a linear scan
+   when that misses, so that unsorted rows are handled without having to check the
+   whole matrix for sortedness beforehand. */
+const int* find_col_in_row(const int *st, const int *end, const int col)
+{
+    const int *lo = st;
+    const int *hi = end;
+    while (lo < hi)
+    {
+        const int *mid = lo + (hi - lo) / 2;
+        if (*mid < col)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo < end && *lo == col)
+        return lo;
+    return std::find(st, end, col);
+}
+
+// [[Rcpp::export(rng = false)]]
+bool check_indices_are_sorted
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    int nthreads
+)
+{
+    const int nrows = indptr.size() - 1;
+    int *restrict ptr_indptr = INTEGER(indptr);
+    int *restrict ptr_indices = INTEGER(indices);
+    bool is_sorted = true;
+    nthreads = std::max(1, std::min(nthreads, nrows));
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads) \
+            shared(ptr_indptr, ptr_indices) reduction(&&:is_sorted)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        const int n_this = ptr_indptr[row+1] - ptr_indptr[row];
+        if (n_this > 1 && !check_is_sorted(ptr_indices + ptr_indptr[row], n_this))
+            is_sorted = false;
+    }
+    return is_sorted;
+}
+
 void check_and_sort_single_row_inplace
 (
     int *restrict indices,
@@ -159,139 +222,115 @@ void check_and_sort_single_row_inplace
     }
 }
 
-bool check_indices_are_unsorted
-(
-    int *restrict indptr,
-    int *restrict indices,
-    int nrows
-)
-{
-    for (int row = 0; row < nrows; row++)
-    {
-        if(!check_is_sorted(indices + indptr[row], indptr[row+1] - indptr[row]))
-            return false;
-    }
-    return true;
-}
-
-// [[Rcpp::export(rng = false)]]
-bool check_indices_are_unsorted
-(
-    Rcpp::IntegerVector indptr,
-    Rcpp::NumericVector indices
-)
-{
-    return check_indices_are_unsorted(
-        INTEGER(indptr),
-        INTEGER(indices),
-        indptr.size() - 1
-    );
-}
-
+/* Sorts the indices of each row (along with their values) in-place.
 
+   Rows are processed in parallel, with each thread keeping its own buffers.
+   If the number of columns is known (passed as a positive number), rows whose
+   number of entries is large compared to it will be sorted through a counting
+   sort (over an array of size 'ncols' per thread) instead of a comparison sort. */
 template <class T>
 void sort_sparse_indices
 (
     int *restrict indptr,
     int *restrict indices,
     T values[],
-    int nrows
+    int nrows, int ncols,
+    int nthreads
 )
 {
+    profile_kernel("sort_sparse_indices");
     std::vector<int> argsorted;
     std::vector<int> temp_indices;
     std::vector<T> temp_values;
+    std::vector<int> counts;
     int ix1, ix2;
     int n_this;
 
+    nthreads = std::max(1, std::min(nthreads, nrows));
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(indptr, indices, values, nrows, ncols) \
+            private(argsorted, temp_indices, temp_values, counts, ix1, ix2, n_this)
+    #endif
     for (int row = 1; row <= nrows; row++)
     {
         ix1 = indptr[row-1];
         ix2 = indptr[row];
         n_this = ix2 - ix1;
-        if (n_this)
+        if (n_this > 1)
         {
             if (!check_is_sorted(indices + ix1, n_this))
             {
-                if ((int)argsorted.size() < n_this) {
-                    argsorted.resize(n_this);
+                if ((int)temp_indices.size() < n_this) {
                     temp_indices.resize(n_this);
                     temp_values.resize(n_this);
                 }
-                std::iota(argsorted.begin(), argsorted.begin() + n_this, ix1);
-                std::sort(argsorted.begin(), argsorted.begin() + n_this,
-                          [&indices](const int a, const int b){return indices[a] < indices[b];});
-                for (int ix = 0; ix < n_this; ix++)
-                    temp_indices[ix] = indices[argsorted[ix]];
-                std::copy(temp_indices.begin(), temp_indices.begin() + n_this, indices + ix1);
-                for (int ix = 0; ix < n_this; ix++)
-                    temp_values[ix] = values[argsorted[ix]];
-                std::copy(temp_values.begin(), temp_values.begin() + n_this, values + ix1);
 
-            }
-        }
-    }
-}
+                if (ncols > 0 && (size_t)ncols <= (size_t)n_this * (size_t)8)
+                {
+                    if (counts.empty())
+                        counts.resize((size_t)ncols + 1);
+                    for (int ix = ix1; ix < ix2; ix++)
+                        counts[indices[ix] + 1]++;
+                    for (int col = 0; col < ncols; col++)
+                        counts[col+1] += counts[col];
+                    for (int ix = ix1; ix < ix2; ix++)
+                    {
+                        const int pos = counts[indices[ix]]++;
+                        temp_indices[pos] = indices[ix];
+                        temp_values[pos] = values[ix];
+                    }
+                    std::fill(counts.begin(), counts.end(), 0);
+                }
 
-void sort_sparse_indices
-(
-    int *restrict indptr,
-    int *restrict indices,
-    size_t nrows
-)
-{
-    size_t ix1, ix2;
-    size_t n_this;
+                else
+                {
+                    if ((int)argsorted.size() < n_this)
+                        argsorted.resize(n_this);
+                    std::iota(argsorted.begin(), argsorted.begin() + n_this, ix1);
+                    std::sort(argsorted.begin(), argsorted.begin() + n_this,
+                              [&indices](const int a, const int b){return indices[a] < indices[b];});
+                    for (int ix = 0; ix < n_this; ix++)
+                        temp_indices[ix] = indices[argsorted[ix]];
+                    for (int ix = 0; ix < n_this; ix++)
+                        temp_values[ix] = values[argsorted[ix]];
+                }
 
-    for (size_t row = 1; row <= nrows; row++)
-    {
-        ix1 = indptr[row-1];
-        ix2 = indptr[row];
-        n_this = ix2 - ix1;
-        if (n_this)
-        {
-            if (!check_is_sorted(indices + ix1, n_this))
-            {
-                std::sort(indices + ix1, indices + ix2);
+                std::copy(temp_indices.begin(), temp_indices.begin() + n_this, indices + ix1);
+                std::copy(temp_values.begin(), temp_values.begin() + n_this, values + ix1);
             }
         }
     }
 }
 
-template <class T>
-void sort_sparse_indices_known_ncol
+/* Binary matrices have no values to move along, so the indices are sorted directly */
+void sort_sparse_indices
 (
     int *restrict indptr,
     int *restrict indices,
-    T values[],
-    int nrows, int ncols
+    int nrows,
+    int nthreads
 )
 {
-    std::vector<int> argsorted(ncols);
-    std::vector<int> temp_indices(ncols);
-    std::vector<T> temp_values(ncols);
+    profile_kernel("sort_sparse_indices");
     int ix1, ix2;
     int n_this;
 
+    nthreads = std::max(1, std::min(nthreads, nrows));
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(indptr, indices, nrows) private(ix1, ix2, n_this)
+    #endif
     for (int row = 1; row <= nrows; row++)
     {
         ix1 = indptr[row-1];
         ix2 = indptr[row];
         n_this = ix2 - ix1;
-        if (n_this)
+        if (n_this > 1)
         {
             if (!check_is_sorted(indices + ix1, n_this))
             {
-                std::iota(argsorted.begin(), argsorted.begin() + n_this, ix1);
-                std::sort(argsorted.begin(), argsorted.begin() + n_this,
-                          [&indices](const int a, const int b){return indices[a] < indices[b];});
-                for (int ix = 0; ix < n_this; ix++)
-                    temp_indices[ix] = indices[argsorted[ix]];
-                std::copy(temp_indices.begin(), temp_indices.begin() + n_this, indices + ix1);
-                for (int ix = 0; ix < n_this; ix++)
-                    temp_values[ix] = values[argsorted[ix]];
-                std::copy(temp_values.begin(), temp_values.begin() + n_this, values + ix1);
-
+                std::sort(indices + ix1, indices + ix2);
             }
         }
     }
@@ -302,14 +341,16 @@ void sort_sparse_indices_numeric
 (
     Rcpp::IntegerVector indptr,
     Rcpp::IntegerVector indices,
-    Rcpp::NumericVector values
+    Rcpp::NumericVector values,
+    int nthreads
 )
 {
     sort_sparse_indices(
         INTEGER(indptr),
         INTEGER(indices),
         REAL(values),
-        indptr.size()-1
+        indptr.size()-1, 0,
+        nthreads
     );
 }
 
@@ -318,14 +359,16 @@ void sort_sparse_indices_logical
 (
     Rcpp::IntegerVector indptr,
     Rcpp::IntegerVector indices,
-    Rcpp::LogicalVector values
+    Rcpp::LogicalVector values,
+    int nthreads
 )
 {
     sort_sparse_indices(
         INTEGER(indptr),
         INTEGER(indices),
         LOGICAL(values),
-        indptr.size()-1
+        indptr.size()-1, 0,
+        nthreads
     );
 }
 
@@ -335,14 +378,16 @@ void sort_sparse_indices_numeric_known_ncol
     Rcpp::IntegerVector indptr,
     Rcpp::IntegerVector indices,
     Rcpp::NumericVector values,
-    int ncol
+    int ncol,
+    int nthreads
 )
 {
-    sort_sparse_indices_known_ncol(
+    sort_sparse_indices(
         INTEGER(indptr),
         INTEGER(indices),
         REAL(values),
-        indptr.size()-1, ncol
+        indptr.size()-1, ncol,
+        nthreads
     );
 }
 
@@ -352,14 +397,16 @@ void sort_sparse_indices_logical_known_ncol
     Rcpp::IntegerVector indptr,
     Rcpp::IntegerVector indices,
     Rcpp::LogicalVector values,
-    int ncol
+    int ncol,
+    int nthreads
 )
 {
-    sort_sparse_indices_known_ncol(
+    sort_sparse_indices(
         INTEGER(indptr),
         INTEGER(indices),
         LOGICAL(values),
-        indptr.size()-1, ncol
+        indptr.size()-1, ncol,
+        nthreads
     );
 }
 
@@ -367,13 +414,15 @@ void sort_sparse_indices_logical_known_ncol
 void sort_sparse_indices_binary
 (
     Rcpp::IntegerVector indptr,
-    Rcpp::IntegerVector indices
+    Rcpp::IntegerVector indices,
+    int nthreads
 )
 {
     sort_sparse_indices(
         INTEGER(indptr),
         INTEGER(indices),
-        indptr.size()-1
+        indptr.size()-1,
+        nthreads
     );
 }
 
@@ -0,0 +1,226 @@
+#ifdef _WIN32
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+#include "MatrixExtra.h"
+
+/* Binary format for CSR matrices which can be memory-mapped (see 'write_csr_binary'
+   in the R code), with all numbers in the native byte order of the machine:
+    - Bytes [0, 8): magic string "MXTRCSR1".
+    - Bytes [8, 64): seven doubles with: number of rows, number of columns,
+      number of non-zeros, type of the values (0=binary, 1=numeric, 2=logical),
+      and the byte offsets at which 'indptr', 'indices', and 'values' start.
+    - Then the arrays 'indptr' (int32, nrows+1), 'indices' (int32, nnz) and
+      'values' (double or int32, nnz, absent for binary), each starting at
+      a position that's a multiple of 64.
+
+   The file is mapped read-only and shared, so several processes mapping
+   the same file will use the same physical pages, which are only read
+   from disk when they are accessed. */
+
+static const char mmap_csr_magic[] = "MXTRCSR1";
+constexpr const size_t mmap_csr_header_size = 64;
+
+static void unmap_csr_file(MappedCSR *mapped)
+{
+    if (mapped->addr == nullptr)
+        return;
+    #ifdef _WIN32
+    UnmapViewOfFile(mapped->addr);
+    CloseHandle((HANDLE)mapped->map_handle);
+    CloseHandle((HANDLE)mapped->file_handle);
+    #else
+    munmap(mapped->addr, mapped->size);
+    #endif
+    mapped->addr = nullptr;
+}
+
+static void finalize_mapped_csr(MappedCSR *mapped)
+{
+    unmap_csr_file(mapped);
+    delete mapped;
+}
+
+typedef Rcpp::XPtr<MappedCSR, Rcpp::PreserveStorage, finalize_mapped_csr, true> MappedCSRPtr;
+
+MappedCSR* get_mapped_csr(SEXP ptr)
+{
+    MappedCSRPtr mapped(ptr);
+    if (mapped.get() == nullptr || mapped->addr == nullptr)
+        Rcpp::stop("Memory-mapped matrix has been closed.");
+    return mapped.get();
+}
+
+static bool is_valid_offset(const double offset, const size_t nbytes, const size_t file_size)
+{
+    return offset >= (double)mmap_csr_header_size &&
+           std::fmod(offset, 64.) == 0 &&
+           (size_t)offset <= file_size &&
+           nbytes <= file_size - (size_t)offset;
+}
+
+/* The kernels that operate on the mapped matrix take the index pointer as it
+   is, so it's checked in full when opening the file, the same way as
+   'check_valid_csr_matrix' does for matrices in memory - otherwise a truncated
+   or corrupted file could lead them to read or write out of bounds. The indices
+   are not checked at this point, since that would read the whole file from disk,
+   defeating the purpose of mapping it - they are instead checked as they get
+   used (see 'check_mapped_indices'). */
+static bool has_valid_indptr(const MappedCSR *mapped)
+{
+    const int *restrict indptr = mapped->indptr;
+    const int nrows = mapped->nrows;
+    if (indptr[0] != 0 || indptr[nrows] < 0 || (size_t)indptr[nrows] != mapped->nnz)
+        return false;
+    for (int row = 0; row < nrows; row++) {
+        if (indptr[row] > indptr[row+1])
+            return false;
+    }
+    return true;
+}
+
+/* Checks that the indices taken from the mapped matrix are within its number of
+   columns. Slices check only the rows that they copied, while operations that read
+   all of the indices check the whole array, which is then not checked again. */
+void check_mapped_indices(const MappedCSR *mapped, const int *indices, const size_t n)
+{
+    if (mapped->indices_checked)
+        return;
+    const int ncols = mapped->ncols;
+    for (size_t ix = 0; ix < n; ix++) {
+        if (indices[ix] < 0 || indices[ix] >= ncols)
+            Rcpp::stop("File is not a valid CSR binary file (column indices out of bounds).");
+    }
+}
+
+void check_all_mapped_indices(MappedCSR *mapped)
+{
+    check_mapped_indices(mapped, mapped->indices, mapped->nnz);
+    mapped->indices_checked = true;
+}
+
+// [[Rcpp::export(rng = false)]]
+SEXP mmap_csr_open_file(std::string fname)
+{
+    std::unique_ptr<MappedCSR> mapped(new MappedCSR());
+
+    #ifdef _WIN32
+    HANDLE file_handle = CreateFileA(fname.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file_handle == INVALID_HANDLE_VALUE)
+        Rcpp::stop("Could not open file.");
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size)) {
+        CloseHandle(file_handle);
+        Rcpp::stop("Could not determine file size.");
+    }
+    mapped->size = (size_t)file_size.QuadPart;
+    if (mapped->size < mmap_csr_header_size) {
+        CloseHandle(file_handle);
+        Rcpp::stop("File is not a valid CSR binary file.");
+    }
+    HANDLE map_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (map_handle == NULL) {
+        CloseHandle(file_handle);
+        Rcpp::stop("Could not memory-map file.");
+    }
+    void *addr = MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0);
+    if (addr == NULL) {
+        CloseHandle(map_handle);
+        CloseHandle(file_handle);
+        Rcpp::stop("Could not memory-map file.");
+    }
+    mapped->file_handle = (void*)file_handle;
+    mapped->map_handle = (void*)map_handle;
+    mapped->addr = addr;
+    #else
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+        Rcpp::stop("Could not open file.");
+    struct stat file_info;
+    if (fstat(fd, &file_info) != 0) {
+        close(fd);
+        Rcpp::stop("Could not determine file size.");
+    }
+    mapped->size = (size_t)file_info.st_size;
+    if (mapped->size < mmap_csr_header_size) {
+        close(fd);
+        Rcpp::stop("File is not a valid CSR binary file.");
+    }
+    void *addr = mmap(NULL, mapped->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        Rcpp::stop("Could not memory-map file.");
+    mapped->addr = addr;
+    #endif
+
+    const char *base = (const char*)mapped->addr;
+    double header[7];
+    memcpy(header, base + 8, sizeof(header));
+    const double nrows = header[0];
+    const double ncols = header[1];
+    const double nnz = header[2];
+    const double values_type = header[3];
+    bool is_valid = memcmp(base, mmap_csr_magic, 8) == 0 &&
+                    nrows >= 0 && nrows < INT_MAX && ncols >= 0 && ncols < INT_MAX &&
+                    nnz >= 0 && nnz < INT_MAX &&
+                    (values_type == MappedBinary || values_type == MappedNumeric || values_type == MappedLogical);
+    if (is_valid)
+    {
+        const size_t size_values = (values_type == MappedNumeric)? sizeof(double) : sizeof(int);
+        is_valid = is_valid_offset(header[4], ((size_t)nrows + 1) * sizeof(int), mapped->size) &&
+                   is_valid_offset(header[5], (size_t)nnz * sizeof(int), mapped->size) &&
+                   (values_type == MappedBinary ||
+                    is_valid_offset(header[6], (size_t)nnz * size_values, mapped->size));
+    }
+    if (!is_valid) {
+        unmap_csr_file(mapped.get());
+        Rcpp::stop("File is not a valid CSR binary file.");
+    }
+
+    mapped->nrows = (int)nrows;
+    mapped->ncols = (int)ncols;
+    mapped->nnz = (size_t)nnz;
+    mapped->values_type = (MappedValuesType)(int)values_type;
+    mapped->indptr = (const int*)(base + (size_t)header[4]);
+    mapped->indices = (const int*)(base + (size_t)header[5]);
+    mapped->values = (values_type == MappedBinary)? nullptr : (const void*)(base + (size_t)header[6]);
+
+    if (!has_valid_indptr(mapped.get())) {
+        unmap_csr_file(mapped.get());
+        Rcpp::stop("File is not a valid CSR binary file.");
+    }
+
+    MappedCSRPtr out(mapped.release(), true);
+    return out;
+}
+
+// [[Rcpp::export(rng = false)]]
+void mmap_csr_close_file(SEXP ptr)
+{
+    MappedCSRPtr mapped(ptr);
+    if (mapped.get() != nullptr)
+        unmap_csr_file(mapped.get());
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List mmap_csr_get_info(SEXP ptr)
+{
+    MappedCSR *mapped = get_mapped_csr(ptr);
+    return Rcpp::List::create(
+        Rcpp::_["nrows"] = Rcpp::wrap(mapped->nrows),
+        Rcpp::_["ncols"] = Rcpp::wrap(mapped->ncols),
+        Rcpp::_["nnz"] = Rcpp::wrap((double)mapped->nnz),
+        Rcpp::_["type"] = Rcpp::wrap((int)mapped->values_type)
+    );
+}
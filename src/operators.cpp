@@ -95,115 +95,154 @@ int R_logical_xor(int x, int y)
 
 /* TODO: some of these operations could benefit from adding 'libdivide' when recycling vectors. */
 
+/* These are the per-row kernels for the elementwise operations between two CSR
+   matrices with sorted indices. They are called twice for each row: first without
+   outputs in order to determine the number of non-zeros in the result, and then
+   with outputs pointing to the corresponding positions in the preallocated arrays.
+   Both return the number of non-zeros that the row will have in the result. */
+template <class InputDType, bool is_logical, bool write_output>
+static inline int multiply_csr_row
+(
+    const int *restrict indices1, const int st1, const int end1,
+    const int *restrict indices2, const int st2, const int end2,
+    const InputDType *restrict values1, const InputDType *restrict values2,
+    int *restrict indices_out, InputDType *restrict values_out
+)
+{
+    if (st1 == end1 || st2 == end2)
+        return 0;
+    if (indices1[end1-1] < indices2[st2] || indices2[end2-1] < indices1[st1])
+        return 0;
+
+    int n_this = 0;
+    const int *ptr1 = indices1 + st1;
+    const int *ptr2 = indices2 + st2;
+    const int *ptr_end1 = indices1 + end1;
+    const int *ptr_end2 = indices2 + end2;
+    while (ptr1 < ptr_end1 && ptr2 < ptr_end2)
+    {
+        if (*ptr1 == *ptr2) {
+            if (write_output) {
+                indices_out[n_this] = *ptr1;
+                if (!is_logical)
+                    values_out[n_this] = values1[ptr1 - indices1] * values2[ptr2 - indices2];
+                else
+                    values_out[n_this] = R_logical_and(values1[ptr1 - indices1], values2[ptr2 - indices2]);
+            }
+            ptr1++;
+            ptr2++;
+            n_this++;
+        }
+
+        else if (*ptr1 > *ptr2) {
+            ptr2 = std::lower_bound(ptr2, ptr_end2, *ptr1);
+        }
+
+        else {
+            ptr1 = std::lower_bound(ptr1, ptr_end1, *ptr2);
+        }
+    }
+    return n_this;
+}
+
 /* This function does multiplication and ampersand ("&" operator) */
 template <class RcppVector=Rcpp::NumericVector, class InputDType=double>
 Rcpp::List multiply_csr_elemwise(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2,
                                  Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2,
-                                 RcppVector values1, RcppVector values2)
+                                 RcppVector values1_, RcppVector values2_,
+                                 int nthreads)
 {
-    if (indptr1.size() == indptr2.size() &&
-        indices1.size() == indices2.size() &&
-        INTEGER(indptr1) == INTEGER(indptr2) &&
-        INTEGER(indices1) == INTEGER(indices2)
-    ) {
-        RcppVector values_out(values1.size());
-
-        if (std::is_same<RcppVector, Rcpp::NumericVector>::value) {
+    profile_kernel("multiply_csr_elemwise");
+    const bool is_logical = std::is_same<RcppVector, Rcpp::LogicalVector>::value;
+    const InputDType *restrict values1 = (const InputDType*)values1_.begin();
+    const InputDType *restrict values2 = (const InputDType*)values2_.begin();
+
+    /* When both have the same sparsity pattern (even if in different arrays), the
+       output has that same pattern too, and can reuse the arrays of the first one */
+    if (have_same_sparsity_pattern(indptr1, indptr2, indices1, indices2)) {
+        RcppVector values_out_(values1_.size());
+        profile_count_allocation(values_out_);
+        InputDType *restrict values_out = (InputDType*)values_out_.begin();
+        const int nnz = values1_.size();
+
+        if (!is_logical) {
             #ifdef _OPENMP
-            #pragma omp simd
+            #pragma omp parallel for simd schedule(static) num_threads(nthreads) \
+                    shared(values1, values2, values_out)
             #endif
-            for (int el = 0; el < (int)values1.size(); el++)
+            for (int el = 0; el < nnz; el++)
                 values_out[el] = values1[el] * values2[el];
         }
 
         else {
             #ifdef _OPENMP
-            #pragma omp simd
+            #pragma omp parallel for simd schedule(static) num_threads(nthreads) \
+                    shared(values1, values2, values_out)
             #endif
-            for (int el = 0; el < (int)values1.size(); el++)
+            for (int el = 0; el < nnz; el++)
                 values_out[el] = R_logical_and(values1[el], values2[el]);
         }
         
         return Rcpp::List::create(
             Rcpp::_["indptr"] = indptr1,
             Rcpp::_["indices"] = indices1,
-            Rcpp::_["values"] = values_out
+            Rcpp::_["values"] = values_out_
         );
     }
 
-    size_t nrows = indptr1.size() - 1;
-    Rcpp::List out = Rcpp::List::create(
-        Rcpp::_["indptr"] = Rcpp::IntegerVector(nrows+1)
-    );
-
-    auto nnz_min = std::min(indices1.size(), indices2.size());
-
-    int *indptr_out = INTEGER(out["indptr"]);
-    std::unique_ptr<int[]> indices_out(new int[nnz_min]);
-    std::unique_ptr<InputDType[]> values_out(new InputDType[nnz_min]);
-
-    int *ptr_indices1 = INTEGER(indices1);
-    int *ptr_indices2 = INTEGER(indices2);
-    size_t curr = 0;
-
-    indptr_out[0] = 0;
-    int *ptr1, *ptr2, *end1, *end2;
-    for (size_t row = 0; row < nrows; row++) {
-        
-        if (indptr1[row] == indptr1[row+1] ||
-            indptr2[row] == indptr2[row+1])
-            goto next_row;
-        if (ptr_indices1[indptr1[row+1]-1] < ptr_indices2[indptr2[row]] ||
-            ptr_indices2[indptr2[row+1]-1] < ptr_indices1[indptr1[row]])
-            goto next_row;
-        
-        ptr1 = ptr_indices1 + indptr1[row];
-        ptr2 = ptr_indices2 + indptr2[row];
-        end1 = ptr_indices1 + indptr1[row+1];
-        end2 = ptr_indices2 + indptr2[row+1];
-
-        while (true)
-        {
-            if (ptr1 >= end1 || ptr2 >= end2)
-                goto next_row;
-
-            else if (*ptr1 == *ptr2) {
-                indices_out[curr] = *ptr1;
-                if (std::is_same<RcppVector, Rcpp::NumericVector>::value)
-                    values_out[curr] = values1[ptr1 - ptr_indices1] * values2[ptr2 - ptr_indices2];
-                else
-                    values_out[curr] = R_logical_and(values1[ptr1 - ptr_indices1], values2[ptr2 - ptr_indices2]);
-                ptr1++;
-                ptr2++;
-                curr++;
-            }
-
-            else if (*ptr1 > *ptr2) {
-                ptr2 = std::lower_bound(ptr2, end2, *ptr1);
-            }
-
-            else {
-                ptr1 = std::lower_bound(ptr1, end1, *ptr2);
-            }
-        }
+    const int nrows = indptr1.size() - 1;
+    Rcpp::IntegerVector indptr_out_(nrows+1);
+    profile_count_allocation(indptr_out_);
+    int *restrict indptr_out = INTEGER(indptr_out_);
+    const int *restrict ptr_indptr1 = INTEGER(indptr1);
+    const int *restrict ptr_indptr2 = INTEGER(indptr2);
+    const int *restrict ptr_indices1 = INTEGER(indices1);
+    const int *restrict ptr_indices2 = INTEGER(indices2);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(ptr_indptr1, ptr_indptr2, ptr_indices1, ptr_indices2, indptr_out)
+    #endif
+    for (int row = 0; row < nrows; row++)
+        indptr_out[row+1] = multiply_csr_row<InputDType, is_logical, false>(
+            ptr_indices1, ptr_indptr1[row], ptr_indptr1[row+1],
+            ptr_indices2, ptr_indptr2[row], ptr_indptr2[row+1],
+            values1, values2,
+            nullptr, nullptr
+        );
 
-        next_row:
-        indptr_out[row+1] = curr;
-    }
+    for (int row = 0; row < nrows; row++)
+        indptr_out[row+1] += indptr_out[row];
 
     VectorConstructorArgs args;
-    args.as_integer = true; args.from_pointer = true; args.int_pointer_from = indices_out.get();
-    args.cpp_lim_size = true; args.size = curr;
-    out["indices"] = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    indices_out.reset();
-    if (std::is_same<RcppVector, Rcpp::NumericVector>::value) {
-        args.as_integer = false; args.from_pointer = true; args.num_pointer_from = values_out.get();
-    } else {
-        args.as_integer = true; args.from_pointer = true; args.int_pointer_from = values_out.get();
-        args.as_logical = true;
+    args.as_integer = true; args.size = indptr_out[nrows];
+    Rcpp::IntegerVector indices_out_ = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    args.as_integer = is_logical; args.as_logical = is_logical;
+    RcppVector values_out_ = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    int *restrict indices_out = INTEGER(indices_out_);
+    InputDType *restrict values_out = (InputDType*)values_out_.begin();
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(ptr_indptr1, ptr_indptr2, ptr_indices1, ptr_indices2, indptr_out, indices_out, values_out)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        if (indptr_out[row] == indptr_out[row+1])
+            continue;
+        multiply_csr_row<InputDType, is_logical, true>(
+            ptr_indices1, ptr_indptr1[row], ptr_indptr1[row+1],
+            ptr_indices2, ptr_indptr2[row], ptr_indptr2[row+1],
+            values1, values2,
+            indices_out + indptr_out[row], values_out + indptr_out[row]
+        );
     }
-    out["values"] = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    return out;
+
+    return Rcpp::List::create(
+        Rcpp::_["indptr"] = indptr_out_,
+        Rcpp::_["indices"] = indices_out_,
+        Rcpp::_["values"] = values_out_
+    );
 }
 
 // [[Rcpp::export(rng = false)]]
@@ -211,13 +250,15 @@ Rcpp::List multiply_csr_elemwise
 (
     Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2,
     Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2,
-    Rcpp::NumericVector values1, Rcpp::NumericVector values2
+    Rcpp::NumericVector values1, Rcpp::NumericVector values2,
+    int nthreads
 )
 {
     return multiply_csr_elemwise<Rcpp::NumericVector, double>(
         indptr1, indptr2,
         indices1, indices2,
-        values1, values2
+        values1, values2,
+        nthreads
     );
 }
 
@@ -226,13 +267,15 @@ Rcpp::List logicaland_csr_elemwise
 (
     Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2,
     Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2,
-    Rcpp::LogicalVector values1, Rcpp::LogicalVector values2
+    Rcpp::LogicalVector values1, Rcpp::LogicalVector values2,
+    int nthreads
 )
 {
     return multiply_csr_elemwise<Rcpp::LogicalVector, int>(
         indptr1, indptr2,
         indices1, indices2,
-        values1, values2
+        values1, values2,
+        nthreads
     );
 }
 
@@ -245,7 +288,9 @@ RcppVector multiply_csr_by_dense_elemwise
     RcppMatrixAsVector dense_mat
 )
 {
+    profile_kernel("multiply_csr_by_dense_elemwise");
     RcppVector values_out(values.size());
+    profile_count_allocation(values_out);
     size_t nrows = indptr.size() - 1;
     if (std::is_same<RcppVector, Rcpp::NumericVector>::value)
     {
@@ -333,19 +378,106 @@ Rcpp::LogicalVector logicaland_csr_by_dense_cpp
     return multiply_csr_by_dense_elemwise(indptr, indices, values, dense_mat);
 }
 
+template <class InputDType, bool is_logical, bool write_output>
+static inline int add_csr_row
+(
+    const int *restrict indices1, const int st1, const int end1,
+    const int *restrict indices2, const int st2, const int end2,
+    const InputDType *restrict values1, const InputDType *restrict values2,
+    int *restrict indices_out, InputDType *restrict values_out,
+    const bool substract, const bool xor_op
+)
+{
+    if (!write_output)
+    {
+        if (st1 == end1 || st2 == end2)
+            return (end1 - st1) + (end2 - st2);
+        int n_this = 0;
+        int ix1 = st1, ix2 = st2;
+        while (ix1 < end1 && ix2 < end2)
+        {
+            if (indices1[ix1] == indices2[ix2]) {
+                ix1++;
+                ix2++;
+            }
+            else if (indices1[ix1] < indices2[ix2]) {
+                ix1++;
+            }
+            else {
+                ix2++;
+            }
+            n_this++;
+        }
+        return n_this + (end1 - ix1) + (end2 - ix2);
+    }
+
+    int n_this = 0;
+    int ix1 = st1, ix2 = st2;
+    while (ix1 < end1 && ix2 < end2)
+    {
+        if (indices1[ix1] == indices2[ix2]) {
+            indices_out[n_this] = indices1[ix1];
+            if (!is_logical)
+                values_out[n_this] = values1[ix1] + (substract? (-values2[ix2]) : values2[ix2]);
+            else
+                values_out[n_this] = xor_op?
+                                        R_logical_xor(values1[ix1], values2[ix2])
+                                            :
+                                        R_logical_or(values1[ix1], values2[ix2]);
+            ix1++;
+            ix2++;
+        }
+
+        else if (indices1[ix1] < indices2[ix2]) {
+            indices_out[n_this] = indices1[ix1];
+            values_out[n_this] = values1[ix1];
+            ix1++;
+        }
+
+        else {
+            indices_out[n_this] = indices2[ix2];
+            values_out[n_this] = substract? (-values2[ix2]) : values2[ix2];
+            ix2++;
+        }
+        n_this++;
+    }
+
+    if (ix1 < end1) {
+        std::copy(indices1 + ix1, indices1 + end1, indices_out + n_this);
+        std::copy(values1 + ix1, values1 + end1, values_out + n_this);
+        n_this += end1 - ix1;
+    }
+    if (ix2 < end2) {
+        std::copy(indices2 + ix2, indices2 + end2, indices_out + n_this);
+        if (!substract) {
+            std::copy(values2 + ix2, values2 + end2, values_out + n_this);
+            n_this += end2 - ix2;
+        }
+        else {
+            for (int ix = ix2; ix < end2; ix++)
+                values_out[n_this++] = -values2[ix];
+        }
+    }
+    return n_this;
+}
+
 /* Does "+" and logical "|" */
 template <class RcppVector, class InputDType>
 Rcpp::List add_csr_elemwise(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2,
                             Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2,
                             RcppVector values1_, RcppVector values2_,
-                            const bool substract, const bool xor_op)
+                            const bool substract, const bool xor_op,
+                            int nthreads)
 {
-    if (indices1.size() == indices2.size() &&
-        INTEGER(indptr1) == INTEGER(indptr2) &&
-        INTEGER(indices1) == INTEGER(indices2))
+    profile_kernel("add_csr_elemwise");
+    const bool is_logical = std::is_same<RcppVector, Rcpp::LogicalVector>::value;
+    const InputDType *restrict values1 = (const InputDType*)values1_.begin();
+    const InputDType *restrict values2 = (const InputDType*)values2_.begin();
+
+    if (have_same_sparsity_pattern(indptr1, indptr2, indices1, indices2))
     {
 
-        if (substract && REAL(values1_) == REAL(values2_))
+        if (substract && values1 == values2)
         {
             return Rcpp::List::create(
                 Rcpp::_["indptr"] = Rcpp::IntegerVector(indptr1.size()),
@@ -354,186 +486,114 @@ Rcpp::List add_csr_elemwise(Rcpp::IntegerVector indptr1, Rcpp::IntegerVector ind
             );
         }
 
-        RcppVector values_out(values1_.size());
-        if (std::is_same<RcppVector, Rcpp::NumericVector>::value)
+        RcppVector values_out_(values1_.size());
+        profile_count_allocation(values_out_);
+        InputDType *restrict values_out = (InputDType*)values_out_.begin();
+        const int nnz = values1_.size();
+        if (!is_logical)
         {
             if (!substract)
                 #ifdef _OPENMP
-                #pragma omp simd
+                #pragma omp parallel for simd schedule(static) num_threads(nthreads) \
+                        shared(values1, values2, values_out)
                 #endif
-                for (int el = 0; el < (int)values1_.size(); el++)
-                    values_out[el] = values1_[el] + values2_[el];
+                for (int el = 0; el < nnz; el++)
+                    values_out[el] = values1[el] + values2[el];
             else
                 #ifdef _OPENMP
-                #pragma omp simd
+                #pragma omp parallel for simd schedule(static) num_threads(nthreads) \
+                        shared(values1, values2, values_out)
                 #endif
-                for (int el = 0; el < (int)values1_.size(); el++)
-                    values_out[el] = values1_[el] - values2_[el];
+                for (int el = 0; el < nnz; el++)
+                    values_out[el] = values1[el] - values2[el];
         }
 
         else
         {
             if (!xor_op)
                 #ifdef _OPENMP
-                #pragma omp simd
+                #pragma omp parallel for simd schedule(static) num_threads(nthreads) \
+                        shared(values1, values2, values_out)
                 #endif
-                for (int el = 0; el < (int)values1_.size(); el++)
-                    values_out[el] = R_logical_or(values1_[el], values2_[el]);
+                for (int el = 0; el < nnz; el++)
+                    values_out[el] = R_logical_or(values1[el], values2[el]);
             else
                 #ifdef _OPENMP
-                #pragma omp simd
+                #pragma omp parallel for simd schedule(static) num_threads(nthreads) \
+                        shared(values1, values2, values_out)
                 #endif
-                for (int el = 0; el < (int)values1_.size(); el++)
-                    values_out[el] = R_logical_xor(values1_[el], values2_[el]);
+                for (int el = 0; el < nnz; el++)
+                    values_out[el] = R_logical_xor(values1[el], values2[el]);
         }
 
         return Rcpp::List::create(
             Rcpp::_["indptr"] = indptr1,
             Rcpp::_["indices"] = indices1,
-            Rcpp::_["values"] = values_out
+            Rcpp::_["values"] = values_out_
         );
     }
 
-    size_t nrows = indptr1.size() - 1;
-    Rcpp::List out = Rcpp::List::create(
-        Rcpp::_["indptr"] = Rcpp::IntegerVector(nrows+1)
-    );
-
-    size_large nnz_max = (size_large)indices1.size() + (size_large)indices2.size();
-
-    int *indptr_out = INTEGER(out["indptr"]);
-    std::unique_ptr<int[]> indices_out(new int[nnz_max]);
-    std::unique_ptr<InputDType[]> values_out(new InputDType[nnz_max]);
-
-    int *restrict ptr_indices1 = INTEGER(indices1);
-    int *restrict ptr_indices2 = INTEGER(indices2);
-    InputDType *restrict values1 = values1_.begin();
-    InputDType *restrict values2 = values2_.begin();
-    
+    const int nrows = indptr1.size() - 1;
+    Rcpp::IntegerVector indptr_out_(nrows+1);
+    profile_count_allocation(indptr_out_);
+    int *restrict indptr_out = INTEGER(indptr_out_);
+    const int *restrict ptr_indptr1 = INTEGER(indptr1);
+    const int *restrict ptr_indptr2 = INTEGER(indptr2);
+    const int *restrict ptr_indices1 = INTEGER(indices1);
+    const int *restrict ptr_indices2 = INTEGER(indices2);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(ptr_indptr1, ptr_indptr2, ptr_indices1, ptr_indices2, indptr_out)
+    #endif
+    for (int row = 0; row < nrows; row++)
+        indptr_out[row+1] = add_csr_row<InputDType, is_logical, false>(
+            ptr_indices1, ptr_indptr1[row], ptr_indptr1[row+1],
+            ptr_indices2, ptr_indptr2[row], ptr_indptr2[row+1],
+            values1, values2,
+            nullptr, nullptr,
+            substract, xor_op
+        );
 
-    indptr_out[0] = 0;
-    size_t curr = 0;
-    int *ptr1, *ptr2, *end1, *end2;
-    for (size_t row = 0; row < nrows; row++)
+    size_large nnz_out = 0;
+    for (int row = 0; row < nrows; row++)
     {
-
-        if (indptr1[row] == indptr1[row+1] &&
-            indptr2[row] == indptr2[row+1]) {
-            
-            goto next_row;
-
-        } else if (indptr1[row] == indptr1[row+1]) {
-
-            std::copy(ptr_indices2 + indptr2[row], ptr_indices2 + indptr2[row+1], indices_out.get() + curr);
-            if (!substract) {
-                std::copy(values2 + indptr2[row], values2 + indptr2[row+1], values_out.get() + curr);
-                curr += indptr2[row+1] - indptr2[row];
-            }
-            else {
-                for (int el = indptr2[row]; el < indptr2[row+1]; el++)
-                    values_out[curr++] = -values2[el];
-            }
-            
-            goto next_row;
-
-        } else if (indptr2[row] == indptr2[row+1]) {
-            
-            std::copy(ptr_indices1 + indptr1[row], ptr_indices1 + indptr1[row+1], indices_out.get() + curr);
-            std::copy(values1 + indptr1[row], values1 + indptr1[row+1], values_out.get() + curr);
-            curr += indptr1[row+1] - indptr1[row];
-            goto next_row;
-
-        }
-        
-        ptr1 = ptr_indices1 + indptr1[row];
-        ptr2 = ptr_indices2 + indptr2[row];
-        end1 = ptr_indices1 + indptr1[row+1];
-        end2 = ptr_indices2 + indptr2[row+1];
-
-        while (true)
-        {
-            if (ptr1 >= end1 || ptr2 >= end2) {
-                
-                if (ptr1 < end1) {
-                    std::copy(ptr1, end1, indices_out.get() + curr);
-                    std::copy(values1 + (ptr1 - ptr_indices1), values1 + (end1 - ptr_indices1), values_out.get() + curr);
-                    curr += end1 - ptr1;
-                }
-                if (ptr2 < end2) {
-                    std::copy(ptr2, end2, indices_out.get() + curr);
-                    if (!substract) {
-                        std::copy(values2 + (ptr2 - ptr_indices2), values2 + (end2 - ptr_indices2), values_out.get() + curr);
-                        curr += end2 - ptr2;
-                    }
-                    else {
-                        for (int *ix = ptr2; ix < end2; ix++)
-                            values_out[curr++] = -values2[ix - ptr_indices2];
-                    }
-                }
-                goto next_row;
-
-            }
-
-            else if (*ptr1 == *ptr2) {
-
-                indices_out[curr] = *ptr1;
-                if (std::is_same<RcppVector, Rcpp::NumericVector>::value)
-                    values_out[curr++] = values1[ptr1 - ptr_indices1]
-                                            + (substract?
-                                                (-values2[ptr2 - ptr_indices2])
-                                                    :
-                                                values2[ptr2 - ptr_indices2]);
-                else
-                    values_out[curr++] = xor_op?
-                                            R_logical_xor(values1[ptr1 - ptr_indices1], values2[ptr2 - ptr_indices2])
-                                                :
-                                            R_logical_or(values1[ptr1 - ptr_indices1], values2[ptr2 - ptr_indices2]);
-
-                ptr1++;
-                ptr2++;
-
-            }
-
-            else if (*ptr1 > *ptr2) {
-
-                do {
-                    indices_out[curr] = *ptr2;
-                    values_out[curr] = substract? (-values2[ptr2 - ptr_indices2]) : (values2[ptr2 - ptr_indices2]);
-                    ptr2++;
-                    curr++;
-                } while (ptr2 < end2 && *ptr2 < *ptr1);
-
-            }
-
-            else {
-
-                do {
-                    indices_out[curr] = *ptr1;
-                    values_out[curr] = values1[ptr1 - ptr_indices1];
-                    ptr1++;
-                    curr++;
-                } while (ptr1 < end1 && *ptr1 < *ptr2);
-                
-            }
-        }
-
-        next_row:
-        indptr_out[row+1] = curr;
+        nnz_out += indptr_out[row+1];
+        if (nnz_out > (size_large)INT_MAX)
+            Rcpp::stop("Error: resulting matrix would have too many entries for a sparse CSR representation (int overflow).");
+        indptr_out[row+1] = (int)nnz_out;
     }
 
     VectorConstructorArgs args;
-    args.as_integer = true; args.from_pointer = true; args.int_pointer_from = indices_out.get();
-    args.cpp_lim_size = true; args.size = curr;
-    out["indices"] = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    indices_out.reset();
-    if (std::is_same<RcppVector, Rcpp::NumericVector>::value) {
-        args.as_integer = false; args.from_pointer = true; args.num_pointer_from = values_out.get();
-    } else {
-        args.as_integer = true; args.from_pointer = true; args.int_pointer_from = values_out.get();
-        args.as_logical = true;
+    args.as_integer = true; args.size = nnz_out;
+    Rcpp::IntegerVector indices_out_ = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    args.as_integer = is_logical; args.as_logical = is_logical;
+    RcppVector values_out_ = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    int *restrict indices_out = INTEGER(indices_out_);
+    InputDType *restrict values_out = (InputDType*)values_out_.begin();
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(ptr_indptr1, ptr_indptr2, ptr_indices1, ptr_indices2, indptr_out, indices_out, values_out)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        if (indptr_out[row] == indptr_out[row+1])
+            continue;
+        add_csr_row<InputDType, is_logical, true>(
+            ptr_indices1, ptr_indptr1[row], ptr_indptr1[row+1],
+            ptr_indices2, ptr_indptr2[row], ptr_indptr2[row+1],
+            values1, values2,
+            indices_out + indptr_out[row], values_out + indptr_out[row],
+            substract, xor_op
+        );
     }
-    out["values"] = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    return out;
+
+    return Rcpp::List::create(
+        Rcpp::_["indptr"] = indptr_out_,
+        Rcpp::_["indices"] = indices_out_,
+        Rcpp::_["values"] = values_out_
+    );
 }
 
 // [[Rcpp::export(rng = false)]]
@@ -542,14 +602,16 @@ Rcpp::List add_csr_elemwise
     Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2,
     Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2,
     Rcpp::NumericVector values1, Rcpp::NumericVector values2,
-    const bool substract
+    const bool substract,
+    int nthreads
 )
 {
     return add_csr_elemwise<Rcpp::NumericVector, double>(
         indptr1, indptr2,
         indices1, indices2,
         values1, values2,
-        substract, false
+        substract, false,
+        nthreads
     );
 }
 
@@ -559,14 +621,16 @@ Rcpp::List logicalor_csr_elemwise
     Rcpp::IntegerVector indptr1, Rcpp::IntegerVector indptr2,
     Rcpp::IntegerVector indices1, Rcpp::IntegerVector indices2,
     Rcpp::LogicalVector values1, Rcpp::LogicalVector values2,
-    const bool xor_op
+    const bool xor_op,
+    int nthreads
 )
 {
     return add_csr_elemwise<Rcpp::LogicalVector, int>(
         indptr1, indptr2,
         indices1, indices2,
         values1, values2,
-        false, xor_op
+        false, xor_op,
+        nthreads
     );
 }
 
@@ -576,100 +640,133 @@ Rcpp::List multiply_csr_by_coo_elemwise
     Rcpp::IntegerVector X_csr_indptr_,
     Rcpp::IntegerVector X_csr_indices_,
     RcppVector X_csr_values_,
-    Rcpp::IntegerVector Y_coo_row,
-    Rcpp::IntegerVector Y_coo_col,
-    RcppVector Y_coo_val,
-    int max_row_X, int max_col_X
+    Rcpp::IntegerVector Y_coo_row_,
+    Rcpp::IntegerVector Y_coo_col_,
+    RcppVector Y_coo_val_,
+    int max_row_X, int max_col_X,
+    int nthreads
 )
 {
-    size_t nnz_y = Y_coo_row.size();
-    std::unique_ptr<int[]> out_coo_row(new int[nnz_y]);
-    std::unique_ptr<int[]> out_coo_col(new int[nnz_y]);
-    std::unique_ptr<InputDType[]> out_coo_val(new InputDType[nnz_y]);
-    size_t curr = 0;
-    InputDType val;
-
+    const bool is_logical = std::is_same<RcppVector, Rcpp::LogicalVector>::value;
+    const size_t nnz_y = Y_coo_row_.size();
     int *restrict X_csr_indptr = INTEGER(X_csr_indptr_);
     int *restrict X_csr_indices = INTEGER(X_csr_indices_);
-    InputDType *restrict X_csr_values = NULL;
-    if (std::is_same<RcppVector, Rcpp::NumericVector>::value) {
-        X_csr_values = (InputDType*)REAL(X_csr_values_);
-    } else {
-        X_csr_values = (InputDType*)LOGICAL(X_csr_values_);
-    }
-
-    if (std::is_same<RcppVector, Rcpp::NumericVector>::value)
+    InputDType *restrict X_csr_values = (InputDType*)X_csr_values_.begin();
+    const int *restrict Y_coo_row = INTEGER(Y_coo_row_);
+    const int *restrict Y_coo_col = INTEGER(Y_coo_col_);
+    const InputDType *restrict Y_coo_val = (const InputDType*)Y_coo_val_.begin();
+
+    /* First pass: each thread computes the products for a contiguous chunk of
+       the entries in 'Y', keeping them in a temporary array along with the number
+       of non-zeros in its chunk. Second pass: each thread copies the non-zero
+       entries from its chunk into the output, at offsets given by the cumulative
+       sum of the chunk counts. */
+    nthreads = std::max(1, std::min(nthreads, (int)std::min(nnz_y, (size_t)INT_MAX)));
+    std::unique_ptr<InputDType[]> products(new InputDType[nnz_y]);
+    std::unique_ptr<char[]> is_nonzero(new char[nnz_y]);
+    std::unique_ptr<size_t[]> chunk_st(new size_t[nthreads+1]);
+    for (int tid = 0; tid <= nthreads; tid++)
+        chunk_st[tid] = ((size_large)nnz_y * (size_large)tid) / (size_large)nthreads;
+    std::unique_ptr<size_t[]> chunk_nnz(new size_t[nthreads+1]());
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+            shared(X_csr_indptr, X_csr_indices, X_csr_values, Y_coo_row, Y_coo_col, Y_coo_val, \
+                   products, is_nonzero, chunk_st, chunk_nnz, max_row_X, max_col_X)
+    #endif
+    for (int tid = 0; tid < nthreads; tid++)
     {
-        for (size_t ix = 0; ix < nnz_y; ix++)
+        size_t n_this = 0;
+        for (size_t ix = chunk_st[tid]; ix < chunk_st[tid+1]; ix++)
         {
-            if ((ISNAN(Y_coo_val[ix]) || Y_coo_val[ix] != 0) &&
-                Y_coo_row[ix] < max_row_X &&
-                Y_coo_col[ix] < max_col_X)
+            is_nonzero[ix] = false;
+            if (!is_logical)
             {
-                val = extract_single_val_csr(
-                    X_csr_indptr,
-                    X_csr_indices,
-                    X_csr_values,
-                    Y_coo_row[ix], Y_coo_col[ix],
-                    true
-                );
-
-                if (ISNAN(val) || val != 0)
+                if ((ISNAN((double)Y_coo_val[ix]) || Y_coo_val[ix] != 0) &&
+                    Y_coo_row[ix] < max_row_X &&
+                    Y_coo_col[ix] < max_col_X)
                 {
-                    out_coo_row[curr] = Y_coo_row[ix];
-                    out_coo_col[curr] = Y_coo_col[ix];
-                    out_coo_val[curr] = val * Y_coo_val[ix];
-                    curr++;
+                    InputDType val = extract_single_val_csr(
+                        X_csr_indptr,
+                        X_csr_indices,
+                        X_csr_values,
+                        Y_coo_row[ix], Y_coo_col[ix],
+                        true
+                    );
+
+                    if (ISNAN((double)val) || val != 0)
+                    {
+                        products[ix] = val * Y_coo_val[ix];
+                        is_nonzero[ix] = true;
+                        n_this++;
+                    }
                 }
             }
-        }
-    }
 
-    else
-    {
-        for (size_t ix = 0; ix < nnz_y; ix++)
-        {
-            if (Y_coo_val[ix] != 0 &&
-                Y_coo_row[ix] < max_row_X &&
-                Y_coo_col[ix] < max_col_X)
+            else
             {
-                val = extract_single_val_csr(
-                    X_csr_indptr,
-                    X_csr_indices,
-                    X_csr_values,
-                    Y_coo_row[ix], Y_coo_col[ix],
-                    true
-                );
-
-                if (val != 0)
+                if (Y_coo_val[ix] != 0 &&
+                    Y_coo_row[ix] < max_row_X &&
+                    Y_coo_col[ix] < max_col_X)
                 {
-                    out_coo_row[curr] = Y_coo_row[ix];
-                    out_coo_col[curr] = Y_coo_col[ix];
-                    out_coo_val[curr] = R_logical_and(val, Y_coo_val[ix]);
-                    curr++;
+                    InputDType val = extract_single_val_csr(
+                        X_csr_indptr,
+                        X_csr_indices,
+                        X_csr_values,
+                        Y_coo_row[ix], Y_coo_col[ix],
+                        true
+                    );
+
+                    if (val != 0)
+                    {
+                        products[ix] = R_logical_and(val, Y_coo_val[ix]);
+                        is_nonzero[ix] = true;
+                        n_this++;
+                    }
                 }
             }
         }
+        chunk_nnz[tid+1] = n_this;
     }
 
+    for (int tid = 0; tid < nthreads; tid++)
+        chunk_nnz[tid+1] += chunk_nnz[tid];
 
-    Rcpp::List out;
     VectorConstructorArgs args;
-    args.as_integer = true; args.from_pointer = true; args.int_pointer_from = out_coo_row.get();
-    args.cpp_lim_size = true; args.size = curr;
-    out["row"] = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    out_coo_row.reset();
-    args.as_integer = true; args.from_pointer = true; args.int_pointer_from = out_coo_col.get();
-    out["col"] = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    out_coo_col.reset();
-    if (std::is_same<RcppVector, Rcpp::NumericVector>::value) {
-        args.as_integer = false; args.from_pointer = true; args.num_pointer_from = out_coo_val.get();
-    } else {
-        args.as_integer = true; args.from_pointer = true; args.int_pointer_from = out_coo_val.get();
-        args.as_logical = true;
+    args.as_integer = true; args.size = chunk_nnz[nthreads];
+    Rcpp::IntegerVector out_coo_row = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    Rcpp::IntegerVector out_coo_col = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    args.as_integer = is_logical; args.as_logical = is_logical;
+    RcppVector out_coo_val = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    int *restrict row_out = INTEGER(out_coo_row);
+    int *restrict col_out = INTEGER(out_coo_col);
+    InputDType *restrict val_out = (InputDType*)out_coo_val.begin();
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+            shared(Y_coo_row, Y_coo_col, products, is_nonzero, chunk_st, chunk_nnz, \
+                   row_out, col_out, val_out)
+    #endif
+    for (int tid = 0; tid < nthreads; tid++)
+    {
+        size_t curr = chunk_nnz[tid];
+        for (size_t ix = chunk_st[tid]; ix < chunk_st[tid+1]; ix++)
+        {
+            if (is_nonzero[ix])
+            {
+                row_out[curr] = Y_coo_row[ix];
+                col_out[curr] = Y_coo_col[ix];
+                val_out[curr] = products[ix];
+                curr++;
+            }
+        }
     }
-    out["val"] = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    return out;
+
+    return Rcpp::List::create(
+        Rcpp::_["row"] = out_coo_row,
+        Rcpp::_["col"] = out_coo_col,
+        Rcpp::_["val"] = out_coo_val
+    );
 }
 
 // [[Rcpp::export(rng = false)]]
@@ -681,7 +778,8 @@ Rcpp::List multiply_csr_by_coo_elemwise
     Rcpp::IntegerVector Y_coo_row,
     Rcpp::IntegerVector Y_coo_col,
     Rcpp::NumericVector Y_coo_val,
-    int max_row_X, int max_col_X
+    int max_row_X, int max_col_X,
+    int nthreads
 )
 {
     return multiply_csr_by_coo_elemwise<Rcpp::NumericVector, double>(
@@ -691,7 +789,8 @@ Rcpp::List multiply_csr_by_coo_elemwise
         Y_coo_row,
         Y_coo_col,
         Y_coo_val,
-        max_row_X, max_col_X
+        max_row_X, max_col_X,
+        nthreads
     );
 }
 
@@ -704,7 +803,8 @@ Rcpp::List logicaland_csr_by_coo_elemwise
     Rcpp::IntegerVector Y_coo_row,
     Rcpp::IntegerVector Y_coo_col,
     Rcpp::LogicalVector Y_coo_val,
-    int max_row_X, int max_col_X
+    int max_row_X, int max_col_X,
+    int nthreads
 )
 {
     return multiply_csr_by_coo_elemwise<Rcpp::LogicalVector, int>(
@@ -714,7 +814,8 @@ Rcpp::List logicaland_csr_by_coo_elemwise
         Y_coo_row,
         Y_coo_col,
         Y_coo_val,
-        max_row_X, max_col_X
+        max_row_X, max_col_X,
+        nthreads
     );
 }
 
@@ -1601,546 +1702,140 @@ static inline double R_modulus(double x1, double x2)
 
 enum Operation {Multiply, PowerTo, Divide, DivRest, IntDiv};
 
-template <class RcppVector>
-RcppVector multiply_csr_by_dvec_no_NAs
+/* The operation is a template parameter so that each combination gets its
+   own loop without branches inside, which the compiler can vectorize when
+   the vector is recycled by rows. For logical inputs, the only operation
+   is a logical AND. */
+template <Operation op, bool X_is_LHS>
+static inline double apply_dvec_op(const double x, const double y)
+{
+    const double a = X_is_LHS? x : y;
+    const double b = X_is_LHS? y : x;
+    switch (op)
+    {
+        case Multiply: return a * b;
+        case Divide: return a / b;
+        case DivRest: return R_modulus(a, b);
+        case IntDiv: return R_intdiv(a, b);
+        case PowerTo: return R_pow(a, b);
+    }
+    return NA_REAL;
+}
+
+template <Operation op, bool X_is_LHS>
+static inline int apply_dvec_op(const int x, const int y)
+{
+    return R_logical_and(x, y);
+}
+
+template <class RcppVector, class InputDType, Operation op, bool X_is_LHS>
+static RcppVector multiply_csr_by_dvec_template
 (
     Rcpp::IntegerVector indptr,
     Rcpp::IntegerVector indices,
     RcppVector values,
     RcppVector dvec,
     const int ncols,
+    int nthreads
+)
+{
+    RcppVector values_out(values.size());
+    const int nrows = indptr.size() - 1;
+    const size_t dvec_size = dvec.size();
+    const int *restrict indptr_ = INTEGER(indptr);
+    const int *restrict indices_ = INTEGER(indices);
+    const InputDType *restrict values_ = values.begin();
+    const InputDType *restrict dvec_ = dvec.begin();
+    InputDType *restrict values_out_ = values_out.begin();
+    nthreads = std::max(1, std::min(nthreads, nrows));
+
+    if (dvec_size == (size_t)nrows || (dvec_size < (size_t)nrows && ((size_t)nrows % dvec_size) == 0))
+    {
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+                shared(indptr_, values_, dvec_, values_out_)
+        #endif
+        for (int row = 0; row < nrows; row++)
+        {
+            const InputDType val = dvec_[(size_t)row % dvec_size];
+            #ifdef _OPENMP
+            #pragma omp simd
+            #endif
+            for (int ix = indptr_[row]; ix < indptr_[row+1]; ix++)
+                values_out_[ix] = apply_dvec_op<op, X_is_LHS>(values_[ix], val);
+        }
+    }
+
+    else if ((size_large)dvec_size >= (size_large)nrows * (size_large)ncols)
+    {
+        const size_t nrows_ = nrows;
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+                shared(indptr_, indices_, values_, dvec_, values_out_)
+        #endif
+        for (int row = 0; row < nrows; row++)
+        {
+            for (int ix = indptr_[row]; ix < indptr_[row+1]; ix++)
+                values_out_[ix] = apply_dvec_op<op, X_is_LHS>(
+                    values_[ix], dvec_[(size_t)row + (size_t)indices_[ix]*nrows_]
+                );
+        }
+    }
+
+    else
+    {
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+                shared(indptr_, indices_, values_, dvec_, values_out_)
+        #endif
+        for (int row = 0; row < nrows; row++)
+        {
+            for (int ix = indptr_[row]; ix < indptr_[row+1]; ix++)
+                values_out_[ix] = apply_dvec_op<op, X_is_LHS>(
+                    values_[ix], dvec_[recyle_pos(row, indices_[ix], nrows, dvec_size)]
+                );
+        }
+    }
+
+    return values_out;
+}
+
+#define dispatch_dvec_op(op) \
+    X_is_LHS? \
+        multiply_csr_by_dvec_template<Rcpp::NumericVector, double, op, true>( \
+            indptr, indices, values, dvec, ncols, nthreads) \
+            : \
+        multiply_csr_by_dvec_template<Rcpp::NumericVector, double, op, false>( \
+            indptr, indices, values, dvec, ncols, nthreads)
+
+static Rcpp::NumericVector multiply_csr_by_dvec_no_NAs
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    Rcpp::NumericVector values,
+    Rcpp::NumericVector dvec,
+    const int ncols,
     const bool multiply,
     const bool powerto,
     const bool divide,
     const bool divrest,
     const bool intdiv,
-    const bool X_is_LHS
+    const bool X_is_LHS,
+    int nthreads
 )
 {
-    Operation op;
     if (multiply)
-        op = Multiply;
+        return dispatch_dvec_op(Multiply);
     else if (powerto)
-        op = PowerTo;
+        return dispatch_dvec_op(PowerTo);
     else if (divide)
-        op = Divide;
+        return dispatch_dvec_op(Divide);
     else if (divrest)
-        op = DivRest;
+        return dispatch_dvec_op(DivRest);
     else if (intdiv)
-        op = IntDiv;
+        return dispatch_dvec_op(IntDiv);
     else
         throw_internal_err();
-
-    RcppVector values_out(values.size());
-    const int nrows = indptr.size() - 1;
-    const size_t dvec_size = dvec.size();
-    double val; int vall;
-
-    /* TODO: some of these can be changed to daxpy */
-
-    if (dvec_size == (size_t)nrows)
-    {
-        if (std::is_same<RcppVector, Rcpp::NumericVector>::value)
-        {
-            switch(op)
-            {
-                case Multiply:
-                {
-                    for (int row = 0; row < nrows; row++)
-                        #ifdef _OPENMP
-                        #pragma omp simd
-                        #endif
-                        for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                            values_out[ix] = values[ix] * dvec[row];
-                    break;
-                }
-
-                case Divide:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            val = dvec[row];
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = values[ix] / val;
-                        }
-                    }
-
-                    else
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            val = dvec[row];
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = val / values[ix];
-                        }
-                    }
-                    break;
-                }
-
-                case DivRest:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (int row = 0; row < nrows; row++)
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_modulus(values[ix], dvec[row]);
-                    }
-
-                    else
-                    {
-                        for (int row = 0; row < nrows; row++)
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_modulus(dvec[row], values[ix]);
-                    }
-                    break;
-                }
-
-                case IntDiv:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (int row = 0; row < nrows; row++)
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_intdiv(values[ix], dvec[row]);
-                    }
-
-                    else
-                    {
-                        for (int row = 0; row < nrows; row++)
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_intdiv(dvec[row], values[ix]);
-                    }
-                    break;
-                }
-
-                case PowerTo:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (int row = 0; row < nrows; row++)
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_pow(values[ix], dvec[row]);
-                    }
-
-                    else
-                    {
-                        for (int row = 0; row < nrows; row++)
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_pow(dvec[row], values[ix]);
-                    }
-                    break;
-                }
-            }
-        }
-
-        else
-        {
-            for (int row = 0; row < nrows; row++)
-                #ifdef _OPENMP
-                #pragma omp simd
-                #endif
-                for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                    values_out[ix] = R_logical_and(values[ix], dvec[row]);
-        }
-    }
-
-    else if ((size_large)dvec_size >= (size_large)nrows * (size_large)ncols)
-    {
-        const size_t nrows_ = nrows;
-        if (std::is_same<RcppVector, Rcpp::NumericVector>::value)
-        {
-            switch(op)
-            {
-                case Multiply:
-                {
-                    for (size_t row = 0; row < (size_t)nrows; row++)
-                        for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                            values_out[ix] = values[ix] * dvec[row + (size_t)indices[ix]*nrows_];
-                    break;
-                }
-
-                case Divide:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (size_t row = 0; row < (size_t)nrows; row++)
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = values[ix] / dvec[row + (size_t)indices[ix]*nrows_];
-                    }
-
-                    else
-                    {
-                        for (size_t row = 0; row < (size_t)nrows; row++)
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = dvec[row + (size_t)indices[ix]*nrows_] / values[ix];
-                    }
-                    break;
-                }
-
-                case DivRest:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (size_t row = 0; row < (size_t)nrows; row++)
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_modulus(values[ix], dvec[row + (size_t)indices[ix]*nrows_]);
-                    }
-
-                    else
-                    {
-                        for (size_t row = 0; row < (size_t)nrows; row++)
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_modulus(dvec[row + (size_t)indices[ix]*nrows_], values[ix]);
-                    }
-                    break;
-                }
-
-                case IntDiv:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (size_t row = 0; row < (size_t)nrows; row++)
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_intdiv(values[ix], dvec[row + (size_t)indices[ix]*nrows_]);
-                    }
-
-                    else
-                    {
-                        for (size_t row = 0; row < (size_t)nrows; row++)
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_intdiv(dvec[row + (size_t)indices[ix]*nrows_], values[ix]);
-                    }
-                    break;
-                }
-
-                case PowerTo:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (size_t row = 0; row < (size_t)nrows; row++)
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_pow(values[ix], dvec[row + (size_t)indices[ix]*nrows_]);
-                    }
-
-                    else
-                    {
-                        for (size_t row = 0; row < (size_t)nrows; row++)
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_pow(dvec[row + (size_t)indices[ix]*nrows_], values[ix]);
-                    }
-                    break;
-                }
-            }
-        }
-
-        else
-        {
-            for (size_t row = 0; row < (size_t)nrows; row++)
-                for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                    values_out[ix] = R_logical_and(values[ix], dvec[row + (size_t)indices[ix]*nrows_]);
-        }
-    }
-
-    else if (dvec_size < (size_t)nrows && ((size_t)nrows % dvec_size) == 0)
-    {
-        const int dvec_size_ = dvec_size;
-        if (std::is_same<RcppVector, Rcpp::NumericVector>::value)
-        {
-            switch(op)
-            {
-                case Multiply:
-                {
-                    for (int row = 0; row < nrows; row++)
-                    {
-                        val = dvec[row % dvec_size_];
-                        #ifdef _OPENMP
-                        #pragma omp simd
-                        #endif
-                        for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                            values_out[ix] = values[ix] * val;
-                    }
-                    break;
-                }
-
-                case Divide:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            val = dvec[row % dvec_size_];
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = values[ix] / val;
-                        }
-                    }
-
-                    else
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            val = dvec[row % dvec_size_];
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = val / values[ix];
-                        }
-                    }
-                    break;
-                }
-
-                case DivRest:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            val = dvec[row % dvec_size_];
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_modulus(values[ix], val);
-                        }
-                    }
-
-                    else
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            val = dvec[row % dvec_size_];
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_modulus(val, values[ix]);
-                        }
-                    }
-                    break;
-                }
-
-                case IntDiv:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            val = dvec[row % dvec_size_];
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_intdiv(values[ix], val);
-                        }
-                    }
-
-                    else
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            val = dvec[row % dvec_size_];
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_intdiv(val, values[ix]);
-                        }
-                    }
-                    break;
-                }
-
-                case PowerTo:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            val = dvec[row % dvec_size_];
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_pow(values[ix], val);
-                        }
-                    }
-
-                    else
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            val = dvec[row % dvec_size_];
-                            #ifdef _OPENMP
-                            #pragma omp simd
-                            #endif
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_pow(val, values[ix]);
-                        }
-                    }
-                    break;
-                }
-            }
-        }
-
-        else
-        {
-            for (int row = 0; row < nrows; row++)
-            {
-                vall = dvec[row % dvec_size_];
-                #ifdef _OPENMP
-                #pragma omp simd
-                #endif
-                for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                    values_out[ix] = R_logical_and(values[ix], vall);
-            }
-        }
-    }
-
-    else
-    {
-        if (std::is_same<RcppVector, Rcpp::NumericVector>::value)
-        {
-            switch(op)
-            {
-                case Multiply:
-                {
-                    for (int row = 0; row < nrows; row++)
-                    {
-                        for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                            values_out[ix] = values[ix] * dvec[recyle_pos(row, indices[ix], nrows, dvec_size)];
-                    }
-                    break;
-                }
-
-                case Divide:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = values[ix] / dvec[recyle_pos(row, indices[ix], nrows, dvec_size)];
-                        }
-                    }
-
-                    else
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = dvec[recyle_pos(row, indices[ix], nrows, dvec_size)] / values[ix];
-                        }
-                    }
-                    break;
-                }
-
-                case DivRest:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_modulus(values[ix], dvec[recyle_pos(row, indices[ix], nrows, dvec_size)]);
-                        }
-                    }
-
-                    else
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_modulus(dvec[recyle_pos(row, indices[ix], nrows, dvec_size)], values[ix]);
-                        }
-                    }
-                    break;
-                }
-
-                case IntDiv:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_intdiv(values[ix], dvec[recyle_pos(row, indices[ix], nrows, dvec_size)]);
-                        }
-                    }
-
-                    else
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_intdiv(dvec[recyle_pos(row, indices[ix], nrows, dvec_size)], values[ix]);
-                        }
-                    }
-                    break;
-                }
-
-                case PowerTo:
-                {
-                    if (X_is_LHS)
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_pow(values[ix], dvec[recyle_pos(row, indices[ix], nrows, dvec_size)]);
-                        }
-                    }
-
-                    else
-                    {
-                        for (int row = 0; row < nrows; row++)
-                        {
-                            for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                                values_out[ix] = R_pow(dvec[recyle_pos(row, indices[ix], nrows, dvec_size)], values[ix]);
-                        }
-                    }
-                    break;
-                }
-            }
-        }
-
-        else
-        {
-            for (int row = 0; row < nrows; row++)
-            {
-                for (int ix = indptr[row]; ix < indptr[row+1]; ix++)
-                    values_out[ix] = R_logical_and(values[ix], dvec[recyle_pos(row, indices[ix], nrows, dvec_size)]);
-            }
-        }
-    }
-
-    return values_out;
 }
 
 // [[Rcpp::export(rng = false)]]
@@ -2156,7 +1851,8 @@ Rcpp::NumericVector multiply_csr_by_dvec_no_NAs_numeric
     const bool divide,
     const bool divrest,
     const bool intdiv,
-    const bool X_is_LHS
+    const bool X_is_LHS,
+    int nthreads
 )
 {
     return multiply_csr_by_dvec_no_NAs(
@@ -2170,7 +1866,8 @@ Rcpp::NumericVector multiply_csr_by_dvec_no_NAs_numeric
         divide,
         divrest,
         intdiv,
-        X_is_LHS
+        X_is_LHS,
+        nthreads
     );
 }
 
@@ -2181,21 +1878,17 @@ Rcpp::LogicalVector logicaland_csr_by_dvec_internal
     Rcpp::IntegerVector indices,
     Rcpp::LogicalVector values,
     Rcpp::LogicalVector dvec,
-    const int ncols
+    const int ncols,
+    int nthreads
 )
 {
-    return multiply_csr_by_dvec_no_NAs(
+    return multiply_csr_by_dvec_template<Rcpp::LogicalVector, int, Multiply, true>(
         indptr,
         indices,
         values,
         dvec,
         ncols,
-        true,
-        false,
-        false,
-        false,
-        false,
-        true
+        nthreads
     );
 }
 
@@ -2269,7 +1962,8 @@ Rcpp::List multiply_csr_by_dvec_with_NAs
     const bool divide,
     const bool divrest,
     const bool intdiv,
-    const bool X_is_LHS
+    const bool X_is_LHS,
+    int nthreads
 )
 {
     if ((powerto || divide || divrest) && !X_is_LHS)
@@ -2646,7 +2340,8 @@ Rcpp::List multiply_csr_by_dvec_with_NAs
                 Rcpp::_["indptr"] = indptr,
                 Rcpp::_["indices"] = indices,
                 Rcpp::_["values"] = multiply_csr_by_dvec_no_NAs(indptr, indices, values, dvec, ncols,
-                                                                multiply, powerto, divide, divrest, intdiv, X_is_LHS)
+                                                                multiply, powerto, divide, divrest, intdiv, X_is_LHS,
+                                                                nthreads)
             );
         }
 
@@ -0,0 +1,117 @@
+#include "MatrixExtra.h"
+#include <map>
+#include <string>
+
+/* Opt-in instrumentation of the computational kernels, enabled through
+   'options("MatrixExtra.profile" = TRUE)'. When enabled, each instrumented
+   kernel accumulates its number of calls, wall-clock time, and the bytes of
+   R vectors that it allocated, under its name.
+
+   Timings are inclusive - if a kernel calls another instrumented kernel,
+   the time of the inner one is counted in both. The allocations are those
+   made through 'SafeRcppVector' plus the outputs that the kernels register
+   explicitly, which covers the arrays that they return, but not temporary
+   buffers allocated in C++.
+
+   The option is checked once at the start of each kernel, so the overhead
+   when it is disabled is a lookup in R's list of options per call, and the
+   accumulated results are kept until calling 'reset_kernel_timings'. All of
+   this happens in the main thread, outside of the parallel regions.
+
+   Whether allocations are counted is decided by a flag which every kernel
+   sets from the option when it starts, rather than by keeping track of how
+   many kernels are running, since an R error can jump out of a kernel
+   without running its destructor. */
+
+struct KernelTimings {
+    double calls = 0;
+    double seconds = 0;
+    double bytes = 0;
+};
+
+static std::map<std::string, KernelTimings> kernel_timings;
+static bool count_allocations = false;
+static double bytes_allocated = 0;
+
+static bool profiling_is_enabled()
+{
+    SEXP opt = Rf_GetOption1(Rf_install("MatrixExtra.profile"));
+    return opt != R_NilValue && Rf_asLogical(opt) == TRUE;
+}
+
+KernelProfiler::KernelProfiler(const char *name)
+:
+name(name),
+active(profiling_is_enabled())
+{
+    count_allocations = this->active;
+    if (this->active) {
+        this->bytes_start = bytes_allocated;
+        this->time_start = std::chrono::steady_clock::now();
+    }
+}
+
+KernelProfiler::~KernelProfiler()
+{
+    if (!this->active)
+        return;
+    const auto time_end = std::chrono::steady_clock::now();
+    KernelTimings &timings = kernel_timings[this->name];
+    timings.calls += 1;
+    timings.seconds += std::chrono::duration<double>(time_end - this->time_start).count();
+    timings.bytes += bytes_allocated - this->bytes_start;
+}
+
+void profile_count_bytes(const size_t bytes)
+{
+    if (count_allocations)
+        bytes_allocated += bytes;
+}
+
+void profile_count_allocation(SEXP x)
+{
+    if (!count_allocations)
+        return;
+    size_t elt_size;
+    switch (TYPEOF(x))
+    {
+        case REALSXP: {elt_size = sizeof(double); break;}
+        case INTSXP: {elt_size = sizeof(int); break;}
+        case LGLSXP: {elt_size = sizeof(int); break;}
+        default: {elt_size = sizeof(SEXP);}
+    }
+    bytes_allocated += (double)Rf_xlength(x) * (double)elt_size;
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List get_kernel_timings_cpp()
+{
+    const size_t n = kernel_timings.size();
+    Rcpp::CharacterVector kernel(n);
+    Rcpp::NumericVector calls(n);
+    Rcpp::NumericVector seconds(n);
+    Rcpp::NumericVector bytes(n);
+    size_t ix = 0;
+    for (const auto &el : kernel_timings)
+    {
+        kernel[ix] = el.first;
+        calls[ix] = el.second.calls;
+        seconds[ix] = el.second.seconds;
+        bytes[ix] = el.second.bytes;
+        ix++;
+    }
+    return Rcpp::List::create(
+        Rcpp::_["kernel"] = kernel,
+        Rcpp::_["calls"] = calls,
+        Rcpp::_["seconds"] = seconds,
+        Rcpp::_["bytes"] = bytes
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+void reset_kernel_timings_cpp()
+{
+    kernel_timings.clear();
+    bytes_allocated = 0;
+    count_allocations = false;
+}
@@ -20,8 +20,109 @@ Rcpp::IntegerVector concat_indptr2(Rcpp::IntegerVector ptr1, Rcpp::IntegerVector
     return out;
 }
 
+/* Pointers and offsets for each of the inputs to 'concat_csr_batch',
+   collected beforehand since R objects cannot be accessed from
+   multiple threads. Sparse vectors are taken as a single row. */
+struct BatchBindInput
+{
+    bool is_vector = false;
+    const int *indptr = nullptr;
+    const int *indices = nullptr;
+    const double *xvals = nullptr;
+    const int *lvals = nullptr;
+    const int *ivals = nullptr;
+    int nrows = 0;
+    int nnz = 0;
+    int row_offset = 0;
+    int nnz_offset = 0;
+};
+
+static void fill_batch_input(Rcpp::S4 object, BatchBindInput &inp, const RbindedType otype, const int argnum)
+{
+    if (object.hasSlot("j"))
+    {
+        inp.indptr = INTEGER(object.slot("p"));
+        inp.indices = INTEGER(object.slot("j"));
+        inp.nnz = Rf_xlength(object.slot("j"));
+        inp.nrows = INTEGER(object.slot("Dim"))[0];
+        if (object.hasSlot("x"))
+        {
+            SEXP xvals = object.slot("x");
+            if (TYPEOF(xvals) == REALSXP)
+                inp.xvals = REAL(xvals);
+            else if (TYPEOF(xvals) == LGLSXP)
+                inp.lvals = LOGICAL(xvals);
+        }
+    }
+
+    else
+    {
+        inp.is_vector = true;
+        inp.indices = INTEGER(object.slot("i"));
+        inp.nnz = Rf_xlength(object.slot("i"));
+        inp.nrows = 1;
+
+        if (object.inherits("dsparseVector"))
+            inp.xvals = REAL(object.slot("x"));
+        else if (object.inherits("isparseVector"))
+            inp.ivals = INTEGER(object.slot("x"));
+        else if (object.inherits("lsparseVector"))
+            inp.lvals = LOGICAL(object.slot("x"));
+        else if (!object.inherits("nsparseVector") && otype != ngRMatrix) {
+            char errmsg[100];
+            std::snprintf(errmsg, 99, "Invalid vector type in argument %d.\n", argnum);
+            Rcpp::stop(errmsg);
+        }
+    }
+}
+
+static void copy_batch_input_values
+(
+    const BatchBindInput &inp,
+    const RbindedType otype,
+    double *restrict values_out,
+    int *restrict values_out_bool
+)
+{
+    const int nnz = inp.nnz;
+    if (otype == dgRMatrix)
+    {
+        values_out += inp.nnz_offset;
+        if (inp.xvals != nullptr)
+            std::copy(inp.xvals, inp.xvals + nnz, values_out);
+        else if (inp.lvals != nullptr)
+            for (int el = 0; el < nnz; el++)
+                values_out[el] = (inp.lvals[el] == NA_LOGICAL)? NA_REAL : (bool)inp.lvals[el];
+        else if (inp.ivals != nullptr)
+            for (int el = 0; el < nnz; el++)
+                values_out[el] = (inp.ivals[el] == NA_INTEGER)? NA_REAL : inp.ivals[el];
+        else
+            std::fill(values_out, values_out + nnz, 1.);
+    }
+
+    else if (otype == lgRMatrix)
+    {
+        values_out_bool += inp.nnz_offset;
+        if (inp.lvals != nullptr)
+            std::copy(inp.lvals, inp.lvals + nnz, values_out_bool);
+        else if (inp.xvals != nullptr)
+            for (int el = 0; el < nnz; el++)
+                values_out_bool[el] = ISNAN(inp.xvals[el])? NA_LOGICAL : (bool)inp.xvals[el];
+        else if (inp.ivals != nullptr)
+            for (int el = 0; el < nnz; el++)
+                values_out_bool[el] = (inp.ivals[el] == NA_INTEGER)? NA_LOGICAL : (bool)inp.ivals[el];
+        else
+            std::fill(values_out_bool, values_out_bool + nnz, (int)true);
+    }
+}
+
+/* Concatenates CSR matrices and sparse vectors by rows into 'out', which
+   should have its slots already allocated to the right sizes.
+
+   The offsets at which each input goes are determined in a first (serial)
+   pass, after which the inputs are copied concurrently. */
 // [[Rcpp::export(rng = false)]]
-Rcpp::S4 concat_csr_batch(Rcpp::ListOf<Rcpp::S4> objects, Rcpp::S4 out)
+Rcpp::S4 concat_csr_batch(Rcpp::ListOf<Rcpp::S4> objects, Rcpp::S4 out, int nthreads)
 {
     size_t n_inputs = objects.size();
     RbindedType otype;
@@ -32,143 +133,196 @@ Rcpp::S4 concat_csr_batch(Rcpp::ListOf<Rcpp::S4> objects, Rcpp::S4 out)
     else
         otype = dgRMatrix;
 
-    int *indptr_out = INTEGER(out.slot("p"));
-    int *indices_out = INTEGER(out.slot("j"));
-    double *values_out = (otype == dgRMatrix)? REAL(out.slot("x")) : nullptr;
-    int *values_out_bool = (otype == lgRMatrix)? LOGICAL(out.slot("x")) : nullptr;
+    int *restrict indptr_out = INTEGER(out.slot("p"));
+    int *restrict indices_out = INTEGER(out.slot("j"));
+    double *restrict values_out = (otype == dgRMatrix)? REAL(out.slot("x")) : nullptr;
+    int *restrict values_out_bool = (otype == lgRMatrix)? LOGICAL(out.slot("x")) : nullptr;
 
-    int nrows_add, nnz_add;
-    int *indptr_obj, *indices_obj;
-    double *xvals_obj = nullptr;
-    int *lvals_obj = nullptr;
-    int *ivals_obj = nullptr;
-
-    indptr_out[0] = 0;
+    std::vector<BatchBindInput> inputs(n_inputs);
     int curr_pos = 0;
     int curr_row = 0;
+    indptr_out[0] = 0;
 
     for (size_t ix = 0; ix < n_inputs; ix++)
     {
+        BatchBindInput &inp = inputs[ix];
+        inp.row_offset = curr_row;
+        inp.nnz_offset = curr_pos;
+        fill_batch_input(objects[ix], inp, otype, (int)ix);
+        if (inp.is_vector)
+            indptr_out[curr_row + 1] = curr_pos + inp.nnz;
+
+        curr_row += inp.nrows;
+        curr_pos += inp.nnz;
+    }
 
-        if (objects[ix].hasSlot("j"))
+    nthreads = std::max(1, std::min(nthreads, (int)n_inputs));
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(inputs, indptr_out, indices_out, values_out, values_out_bool, otype)
+    #endif
+    for (size_t ix = 0; ix < n_inputs; ix++)
+    {
+        const BatchBindInput &inp = inputs[ix];
+        if (!inp.is_vector)
         {
-            
-            indptr_obj = INTEGER(objects[ix].slot("p"));
-            indices_obj = INTEGER(objects[ix].slot("j"));
-            nnz_add = Rf_xlength(objects[ix].slot("j"));
-            xvals_obj = objects[ix].inherits("dgRMatrix")? REAL(objects[ix].slot("x")) : nullptr;
-            lvals_obj = objects[ix].inherits("lgRMatrix")? LOGICAL(objects[ix].slot("x")) : nullptr;
-            nrows_add = INTEGER(objects[ix].slot("Dim"))[0];
-
-            /* indptr */
-            for (int row = 0; row < nrows_add; row++)
-                indptr_out[row + curr_row + 1] = indptr_out[curr_row] + indptr_obj[row+1];
-            curr_row += nrows_add;
-            /* indices */
-            std::copy(indices_obj, indices_obj + nnz_add, indices_out + curr_pos);
-            /* values, if applicable */
-            if (otype == dgRMatrix) {
-                if (xvals_obj != nullptr)
-                    std::copy(xvals_obj, xvals_obj + nnz_add, values_out + curr_pos);
-                else if (lvals_obj != nullptr)
-                    #ifdef _OPENMP
-                    #pragma omp simd
-                    #endif
-                    for (int el = 0; el < nnz_add; el++)
-                        values_out[el + curr_pos] = (lvals_obj[el] == NA_LOGICAL)? (NA_REAL) : lvals_obj[el];
-                else
-                    std::fill(values_out + curr_pos, values_out + curr_pos + nnz_add, 1.);
-            }
-            
-            else if (otype == lgRMatrix) {
-                if (lvals_obj != nullptr)
-                    std::copy(lvals_obj, lvals_obj + nnz_add, values_out_bool + curr_pos);
-                else if (xvals_obj != nullptr)
-                    #ifdef _OPENMP
-                    #pragma omp simd
-                    #endif
-                    for (int el = 0; el < nnz_add; el++)
-                        values_out_bool[el + curr_pos] = ISNAN(xvals_obj[el])? NA_LOGICAL : (bool)xvals_obj[el];
-                else
-                    std::fill(values_out_bool + curr_pos, values_out_bool + curr_pos + nnz_add, (int)true);
-            }
+            for (int row = 0; row < inp.nrows; row++)
+                indptr_out[inp.row_offset + row + 1] = inp.nnz_offset + inp.indptr[row+1];
+            std::copy(inp.indices, inp.indices + inp.nnz, indices_out + inp.nnz_offset);
         }
 
         else
         {
-            
-            indices_obj = INTEGER(objects[ix].slot("i"));
-            nnz_add = Rf_xlength(objects[ix].slot("i"));
-            indptr_out[curr_row + 1] = indptr_out[curr_row] + nnz_add;
-            curr_row++;
-            #ifdef _OPENMP
-            #pragma omp simd
-            #endif
-            for (int el = 0; el < nnz_add; el++)
-                indices_out[el + curr_pos] = indices_obj[el] - 1;
-
-            if (otype == dgRMatrix) {
-                
-                if (objects[ix].inherits("dsparseVector")) {
-                    xvals_obj = REAL(objects[ix].slot("x"));
-                    std::copy(xvals_obj, xvals_obj + nnz_add, values_out + curr_pos);
-                } else if (objects[ix].inherits("isparseVector")) {
-                    ivals_obj = INTEGER(objects[ix].slot("x"));
-                    #ifdef _OPENMP
-                    #pragma omp simd
-                    #endif
-                    for (int el = 0; el < nnz_add; el++)
-                        values_out[el + curr_pos] = (ivals_obj[el] == NA_INTEGER)? NA_REAL : ivals_obj[el];
-                } else if (objects[ix].inherits("lsparseVector")) {
-                    lvals_obj = LOGICAL(objects[ix].slot("x"));
-                    #ifdef _OPENMP
-                    #pragma omp simd
-                    #endif
-                    for (int el = 0; el < nnz_add; el++)
-                        values_out[el + curr_pos] = (lvals_obj[el] == NA_LOGICAL)? NA_REAL : (bool)lvals_obj[el];
-                } else if (objects[ix].inherits("nsparseVector")) {
-                    std::fill(values_out + curr_pos, values_out + curr_pos + nnz_add, 1.);
-                } else {
-                    char errmsg[100];
-                    std::snprintf(errmsg, 99, "Invalid vector type in argument %d.\n", (int)ix);
-                    Rcpp::stop(errmsg);
-                }
-
-            }
-
-            else if (otype == lgRMatrix) {
-
-                if (objects[ix].inherits("dsparseVector")) {
-                    xvals_obj = REAL(objects[ix].slot("x"));
-                    #ifdef _OPENMP
-                    #pragma omp simd
-                    #endif
-                    for (int el = 0; el < nnz_add; el++)
-                        values_out_bool[el + curr_pos] = ISNAN(xvals_obj[el])? NA_LOGICAL : (bool)xvals_obj[el];
-                } else if (objects[ix].inherits("isparseVector")) {
-                    ivals_obj = INTEGER(objects[ix].slot("x"));
-                    #ifdef _OPENMP
-                    #pragma omp simd
-                    #endif
-                    for (int el = 0; el < nnz_add; el++)
-                        values_out_bool[el + curr_pos] = (ivals_obj[el] == NA_INTEGER)? NA_LOGICAL : (bool)ivals_obj[el];
-                } else if (objects[ix].inherits("lsparseVector")) {
-                    lvals_obj = LOGICAL(objects[ix].slot("x"));
-                    std::copy(lvals_obj, lvals_obj + nnz_add, values_out_bool + curr_pos);
-                } else if (objects[ix].inherits("nsparseVector")) {
-                    std::fill(values_out_bool + curr_pos, values_out_bool + curr_pos + nnz_add, (int)true);
-                } else {
-                    char errmsg[100];
-                    std::snprintf(errmsg, 99, "Invalid vector type in argument %d.\n", (int)ix);
-                    Rcpp::stop(errmsg);
-                }
-
-            }
+            for (int el = 0; el < inp.nnz; el++)
+                indices_out[inp.nnz_offset + el] = inp.indices[el] - 1;
         }
 
-        curr_pos += nnz_add;
+        copy_batch_input_values(inp, otype, values_out, values_out_bool);
+    }
+
+    return out;
+}
+
+/* Growable CSR matrix to which rows can be appended one batch at a time. The
+   buffers are grown by (at least) doubling their capacity, so appending 'n'
+   entries in total takes O(n) time instead of the O(n^2) that repeated 'rbind'
+   calls would take, and the final R vectors are produced with a single copy. */
+struct CSRBuilder
+{
+    RbindedType otype = dgRMatrix;
+    int ncols = 0;
+    bool finalized = false;
+    std::vector<int> indptr = std::vector<int>(1, 0);
+    std::vector<int> indices;
+    std::vector<double> values;
+    std::vector<int> values_bool;
+};
+
+template <class T>
+static void grow_builder_buffer(std::vector<T> &buffer, const size_t new_size)
+{
+    if (new_size > buffer.capacity())
+        buffer.reserve(std::max(new_size, 2 * buffer.capacity()));
+    buffer.resize(new_size);
+}
+
+static CSRBuilder* get_csr_builder(SEXP ptr)
+{
+    Rcpp::XPtr<CSRBuilder> builder(ptr);
+    if (builder.get() == nullptr)
+        Rcpp::stop("Invalid CSR builder object.");
+    if (builder->finalized)
+        Rcpp::stop("CSR builder has already been finalized.");
+    return builder.get();
+}
+
+// [[Rcpp::export(rng = false)]]
+SEXP csr_builder_create(int ncols, bool logical, bool binary)
+{
+    std::unique_ptr<CSRBuilder> builder(new CSRBuilder());
+    builder->ncols = ncols;
+    builder->otype = binary? ngRMatrix : (logical? lgRMatrix : dgRMatrix);
+    Rcpp::XPtr<CSRBuilder> out(builder.release(), true);
+    return out;
+}
+
+// [[Rcpp::export(rng = false)]]
+void csr_builder_append(SEXP builder_ptr, Rcpp::S4 batch, int ncols_batch)
+{
+    CSRBuilder *builder = get_csr_builder(builder_ptr);
+    BatchBindInput inp;
+    fill_batch_input(batch, inp, builder->otype, 1);
+
+    const size_large nrows_prev = builder->indptr.size() - 1;
+    const size_large nnz_prev = builder->indices.size();
+    if (nrows_prev + (size_large)inp.nrows >= (size_large)INT_MAX)
+        Rcpp::stop("Result has too many rows for R to handle.");
+    if (nnz_prev + (size_large)inp.nnz >= (size_large)INT_MAX)
+        Rcpp::stop("Result has too many non-zero entries for R to handle.");
+    inp.row_offset = nrows_prev;
+    inp.nnz_offset = nnz_prev;
+
+    grow_builder_buffer(builder->indptr, nrows_prev + inp.nrows + 1);
+    grow_builder_buffer(builder->indices, nnz_prev + inp.nnz);
+    if (builder->otype == dgRMatrix)
+        grow_builder_buffer(builder->values, nnz_prev + inp.nnz);
+    else if (builder->otype == lgRMatrix)
+        grow_builder_buffer(builder->values_bool, nnz_prev + inp.nnz);
+
+    int *restrict indptr_out = builder->indptr.data();
+    int *restrict indices_out = builder->indices.data();
+    if (!inp.is_vector)
+    {
+        for (int row = 0; row < inp.nrows; row++)
+            indptr_out[inp.row_offset + row + 1] = inp.nnz_offset + inp.indptr[row+1];
+        std::copy(inp.indices, inp.indices + inp.nnz, indices_out + inp.nnz_offset);
+    }
+
+    else
+    {
+        indptr_out[inp.row_offset + 1] = inp.nnz_offset + inp.nnz;
+        for (int el = 0; el < inp.nnz; el++)
+            indices_out[inp.nnz_offset + el] = inp.indices[el] - 1;
+    }
+
+    copy_batch_input_values(inp, builder->otype, builder->values.data(), builder->values_bool.data());
+    builder->ncols = std::max(builder->ncols, ncols_batch);
+}
+
+/* Dimensions of what has been appended so far. Unlike the other functions,
+   this one also works on finalized builders, for which it returns zeros. */
+// [[Rcpp::export(rng = false)]]
+Rcpp::List csr_builder_info(SEXP builder_ptr)
+{
+    Rcpp::XPtr<CSRBuilder> builder(builder_ptr);
+    if (builder.get() == nullptr)
+        Rcpp::stop("Invalid CSR builder object.");
+    const bool finalized = builder->finalized;
+    return Rcpp::List::create(
+        Rcpp::_["nrows"] = Rcpp::wrap(finalized? 0 : (int)(builder->indptr.size() - 1)),
+        Rcpp::_["ncols"] = Rcpp::wrap(builder->ncols),
+        Rcpp::_["nnz"] = Rcpp::wrap(finalized? 0 : (int)builder->indices.size()),
+        Rcpp::_["finalized"] = Rcpp::wrap(finalized)
+    );
+}
+
+/* Copies the buffers into R vectors and then frees them, after which
+   the builder cannot be used anymore. */
+// [[Rcpp::export(rng = false)]]
+Rcpp::List csr_builder_finalize(SEXP builder_ptr)
+{
+    CSRBuilder *builder = get_csr_builder(builder_ptr);
+
+    VectorConstructorArgs args;
+    args.as_integer = true; args.from_cpp_vec = true; args.int_vec_from = &builder->indptr;
+    Rcpp::IntegerVector indptr = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+
+    args.int_vec_from = &builder->indices;
+    Rcpp::IntegerVector indices = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+
+    Rcpp::List out = Rcpp::List::create(
+        Rcpp::_["indptr"] = indptr,
+        Rcpp::_["indices"] = indices,
+        Rcpp::_["ncols"] = Rcpp::wrap(builder->ncols)
+    );
+
+    if (builder->otype == dgRMatrix)
+    {
+        args.as_integer = false; args.num_vec_from = &builder->values;
+        out["values"] = Rcpp::NumericVector(Rcpp::unwindProtect(SafeRcppVector, (void*)&args));
+    }
+
+    else if (builder->otype == lgRMatrix)
+    {
+        args.as_logical = true; args.int_vec_from = &builder->values_bool;
+        out["values"] = Rcpp::LogicalVector(Rcpp::unwindProtect(SafeRcppVector, (void*)&args));
     }
 
+    builder->finalized = true;
+    std::vector<int>().swap(builder->indptr);
+    std::vector<int>().swap(builder->indices);
+    std::vector<double>().swap(builder->values);
+    std::vector<int>().swap(builder->values_bool);
     return out;
 }
 
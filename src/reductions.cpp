@@ -0,0 +1,608 @@
+#include "MatrixExtra.h"
+
+/* Row and column sums and means of CSR matrices.
+
+   Logical values count as 1 when TRUE, and NA values propagate to the
+   result unless passing 'na_rm', in which case they are skipped, and
+   for the means, are also excluded from the number of entries by which
+   the sums get divided (which otherwise is the length of the row or
+   column, including the entries that are not stored).
+
+   If the matrix is binary, 'values' should be passed as NULL. */
+
+template <class InputDType>
+static inline bool is_na_value(const InputDType val)
+{
+    return std::is_same<InputDType, double>::value? ISNAN((double)val) : (val == NA_LOGICAL);
+}
+
+template <class InputDType>
+static inline double value_as_double(const InputDType val)
+{
+    if (std::is_same<InputDType, double>::value)
+        return val;
+    else
+        return (val == NA_LOGICAL)? NA_REAL : (double)(val != 0);
+}
+
+template <class InputDType>
+Rcpp::NumericVector rowsums_csr
+(
+    Rcpp::IntegerVector indptr,
+    const InputDType *restrict values,
+    const int ncols,
+    const bool na_rm,
+    const bool mean,
+    int nthreads
+)
+{
+    const int nrows = indptr.size() - 1;
+    const int *restrict indptr_ = INTEGER(indptr);
+    Rcpp::NumericVector out(nrows);
+    double *restrict out_ = REAL(out);
+    nthreads = std::max(1, std::min(nthreads, nrows));
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+            shared(indptr_, values, out_)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        double sum = 0;
+        int n_na = 0;
+        if (!values)
+        {
+            sum = indptr_[row+1] - indptr_[row];
+        }
+
+        else if (!na_rm)
+        {
+            for (int ix = indptr_[row]; ix < indptr_[row+1]; ix++)
+                sum += value_as_double(values[ix]);
+        }
+
+        else
+        {
+            for (int ix = indptr_[row]; ix < indptr_[row+1]; ix++)
+            {
+                if (is_na_value(values[ix]))
+                    n_na++;
+                else
+                    sum += value_as_double(values[ix]);
+            }
+        }
+
+        out_[row] = mean? (sum / (double)(ncols - n_na)) : sum;
+    }
+
+    return out;
+}
+
+/* Blocks of contiguous rows with roughly the same number of non-zeros, one
+   per thread, given by 'row_st[tid]' (inclusive) to 'row_st[tid+1]' (exclusive) */
+static std::unique_ptr<int[]> split_rows_by_nnz
+(
+    const int *restrict indptr,
+    const int nrows,
+    const size_t nnz,
+    const int nthreads
+)
+{
+    std::unique_ptr<int[]> row_st(new int[nthreads+1]);
+    row_st[0] = 0;
+    row_st[nthreads] = std::max(nrows, 0);
+    for (int tid = 1; tid < nthreads; tid++)
+    {
+        const int nnz_st = (int)(((size_large)nnz * (size_large)tid) / (size_large)nthreads);
+        row_st[tid] = std::lower_bound(indptr, indptr + nrows, nnz_st) - indptr;
+        row_st[tid] = std::max(row_st[tid], row_st[tid-1]);
+    }
+    return row_st;
+}
+
+template <class InputDType>
+Rcpp::NumericVector colsums_csr
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    const InputDType *restrict values,
+    const int ncols,
+    const bool na_rm,
+    const bool mean,
+    int nthreads
+)
+{
+    const int nrows = indptr.size() - 1;
+    const int *restrict indptr_ = INTEGER(indptr);
+    const int *restrict indices_ = INTEGER(indices);
+    const size_t nnz = (nrows > 0)? indptr_[nrows] : 0;
+    Rcpp::NumericVector out(ncols);
+    double *restrict out_ = REAL(out);
+    if (ncols <= 0)
+        return out;
+
+    /* Each thread accumulates the sums for its block of rows (and the
+       number of NAs when needed for the means) in its own buffer, which
+       are then added up by columns. As in the transpose, these take
+       memory proportional to the number of columns, so wide matrices
+       with few non-zeros use fewer threads. */
+    const bool count_na = values && na_rm && mean;
+    nthreads = std::max(1, std::min(nthreads, nrows));
+    if (nthreads > 1 && (size_t)nthreads * (size_t)ncols > 4 * nnz)
+        nthreads = std::max((size_t)1, (4 * nnz) / (size_t)ncols);
+
+    std::unique_ptr<int[]> row_st = split_rows_by_nnz(indptr_, nrows, nnz, nthreads);
+
+    std::unique_ptr<double[]> sums(new double[(size_t)nthreads * (size_t)ncols]());
+    std::unique_ptr<int[]> counts_na(count_na? new int[(size_t)nthreads * (size_t)ncols]() : nullptr);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+            shared(indptr_, indices_, values, row_st, sums, counts_na)
+    #endif
+    for (int tid = 0; tid < nthreads; tid++)
+    {
+        double *restrict sums_this = sums.get() + (size_t)tid * (size_t)ncols;
+        int *restrict counts_na_this = count_na? counts_na.get() + (size_t)tid * (size_t)ncols : nullptr;
+        const int st = indptr_[row_st[tid]];
+        const int end = indptr_[row_st[tid+1]];
+
+        if (!values)
+        {
+            for (int ix = st; ix < end; ix++)
+                sums_this[indices_[ix]] += 1;
+        }
+
+        else if (!na_rm)
+        {
+            for (int ix = st; ix < end; ix++)
+                sums_this[indices_[ix]] += value_as_double(values[ix]);
+        }
+
+        else
+        {
+            for (int ix = st; ix < end; ix++)
+            {
+                if (!is_na_value(values[ix]))
+                    sums_this[indices_[ix]] += value_as_double(values[ix]);
+                else if (count_na)
+                    counts_na_this[indices_[ix]]++;
+            }
+        }
+    }
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads) \
+            shared(sums, counts_na, out_)
+    #endif
+    for (int col = 0; col < ncols; col++)
+    {
+        double sum = 0;
+        int n_na = 0;
+        for (int tid = 0; tid < nthreads; tid++)
+        {
+            const size_t ix = (size_t)tid * (size_t)ncols + (size_t)col;
+            sum += sums[ix];
+            if (count_na) n_na += counts_na[ix];
+        }
+        out_[col] = mean? (sum / (double)(nrows - n_na)) : sum;
+    }
+
+    return out;
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::NumericVector rowsums_csr_numeric
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::NumericVector values,
+    const int ncols,
+    const bool na_rm,
+    const bool mean,
+    int nthreads
+)
+{
+    return rowsums_csr<double>(indptr, REAL(values), ncols, na_rm, mean, nthreads);
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::NumericVector rowsums_csr_logical
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::LogicalVector values,
+    const int ncols,
+    const bool na_rm,
+    const bool mean,
+    int nthreads
+)
+{
+    return rowsums_csr<int>(indptr, LOGICAL(values), ncols, na_rm, mean, nthreads);
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::NumericVector rowsums_csr_binary
+(
+    Rcpp::IntegerVector indptr,
+    const int ncols,
+    const bool mean,
+    int nthreads
+)
+{
+    return rowsums_csr<int>(indptr, (int*)nullptr, ncols, false, mean, nthreads);
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::NumericVector colsums_csr_numeric
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    Rcpp::NumericVector values,
+    const int ncols,
+    const bool na_rm,
+    const bool mean,
+    int nthreads
+)
+{
+    return colsums_csr<double>(indptr, indices, REAL(values), ncols, na_rm, mean, nthreads);
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::NumericVector colsums_csr_logical
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    Rcpp::LogicalVector values,
+    const int ncols,
+    const bool na_rm,
+    const bool mean,
+    int nthreads
+)
+{
+    return colsums_csr<int>(indptr, indices, LOGICAL(values), ncols, na_rm, mean, nthreads);
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::NumericVector colsums_csr_binary
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    const int ncols,
+    const bool mean,
+    int nthreads
+)
+{
+    return colsums_csr<int>(indptr, indices, (int*)nullptr, ncols, false, mean, nthreads);
+}
+
+/* Matrix norms of CSR matrices (same definitions as 'norm' from base R and 'Matrix'):
+    - One: maximum over columns of the sum of absolute values.
+    - Inf: maximum over rows of the sum of absolute values.
+    - Frobenius: square root of the sum of squares.
+    - Max: maximum absolute value.
+   These are all calculated in a single pass over the data. NAs and NaNs propagate
+   to the result (the maximums return the first such value that they find). */
+enum MatrixNormType {NormOne = 0, NormInf = 1, NormFrobenius = 2, NormMax = 3};
+
+static inline double fmax_propagate_nan(const double a, const double b)
+{
+    return ISNAN(a)? a : (ISNAN(b)? b : std::fmax(a, b));
+}
+
+template <class InputDType>
+static inline double abs_value(const InputDType *restrict values, const int ix)
+{
+    return values? std::fabs(value_as_double(values[ix])) : 1.;
+}
+
+template <class InputDType>
+double norm_csr
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    const InputDType *restrict values,
+    const int ncols,
+    const int norm_type,
+    int nthreads
+)
+{
+    const int nrows = indptr.size() - 1;
+    const int *restrict indptr_ = INTEGER(indptr);
+    const int *restrict indices_ = INTEGER(indices);
+    const size_t nnz = (nrows > 0)? indptr_[nrows] : 0;
+    const MatrixNormType norm = (MatrixNormType)norm_type;
+    if (!nnz)
+        return 0;
+
+    /* The 1-norm needs per-thread buffers for the column sums, as in 'colsums_csr' */
+    nthreads = std::max(1, std::min(nthreads, nrows));
+    if (nnz < (size_t)nthreads * 1024)
+        nthreads = std::max((size_t)1, nnz / 1024);
+    if (norm == NormOne && nthreads > 1 && (size_t)nthreads * (size_t)ncols > 4 * nnz)
+        nthreads = std::max((size_t)1, (4 * nnz) / (size_t)ncols);
+
+    std::unique_ptr<int[]> row_st = split_rows_by_nnz(indptr_, nrows, nnz, nthreads);
+    std::unique_ptr<double[]> partial(new double[nthreads]());
+    std::unique_ptr<double[]> col_sums(
+        (norm == NormOne)? new double[(size_t)nthreads * (size_t)ncols]() : nullptr
+    );
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+            shared(indptr_, indices_, values, row_st, partial, col_sums)
+    #endif
+    for (int tid = 0; tid < nthreads; tid++)
+    {
+        double res = 0;
+        switch (norm)
+        {
+            case NormOne:
+            {
+                double *restrict sums_this = col_sums.get() + (size_t)tid * (size_t)ncols;
+                for (int ix = indptr_[row_st[tid]]; ix < indptr_[row_st[tid+1]]; ix++)
+                    sums_this[indices_[ix]] += abs_value(values, ix);
+                break;
+            }
+            case NormInf:
+            {
+                for (int row = row_st[tid]; row < row_st[tid+1]; row++)
+                {
+                    double row_sum = 0;
+                    for (int ix = indptr_[row]; ix < indptr_[row+1]; ix++)
+                        row_sum += abs_value(values, ix);
+                    res = fmax_propagate_nan(res, row_sum);
+                }
+                break;
+            }
+            case NormFrobenius:
+            {
+                for (int ix = indptr_[row_st[tid]]; ix < indptr_[row_st[tid+1]]; ix++)
+                {
+                    const double val = abs_value(values, ix);
+                    res += val * val;
+                }
+                break;
+            }
+            default:
+            {
+                for (int ix = indptr_[row_st[tid]]; ix < indptr_[row_st[tid+1]]; ix++)
+                    res = fmax_propagate_nan(res, abs_value(values, ix));
+                break;
+            }
+        }
+        partial[tid] = res;
+    }
+
+    double out = 0;
+    switch (norm)
+    {
+        case NormOne:
+        {
+            for (int col = 0; col < ncols; col++)
+            {
+                double col_sum = 0;
+                for (int tid = 0; tid < nthreads; tid++)
+                    col_sum += col_sums[(size_t)tid * (size_t)ncols + (size_t)col];
+                out = fmax_propagate_nan(out, col_sum);
+            }
+            break;
+        }
+        case NormFrobenius:
+        {
+            for (int tid = 0; tid < nthreads; tid++)
+                out += partial[tid];
+            out = std::sqrt(out);
+            break;
+        }
+        default:
+        {
+            for (int tid = 0; tid < nthreads; tid++)
+                out = fmax_propagate_nan(out, partial[tid]);
+            break;
+        }
+    }
+    return out;
+}
+
+// [[Rcpp::export(rng = false)]]
+double norm_csr_numeric
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    Rcpp::NumericVector values,
+    const int ncols,
+    const int norm_type,
+    int nthreads
+)
+{
+    return norm_csr<double>(indptr, indices, REAL(values), ncols, norm_type, nthreads);
+}
+
+// [[Rcpp::export(rng = false)]]
+double norm_csr_logical
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    Rcpp::LogicalVector values,
+    const int ncols,
+    const int norm_type,
+    int nthreads
+)
+{
+    return norm_csr<int>(indptr, indices, LOGICAL(values), ncols, norm_type, nthreads);
+}
+
+// [[Rcpp::export(rng = false)]]
+double norm_csr_binary
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    const int ncols,
+    const int norm_type,
+    int nthreads
+)
+{
+    return norm_csr<int>(indptr, indices, (int*)nullptr, ncols, norm_type, nthreads);
+}
+
+/* Scaling of the rows or columns of a numeric CSR matrix by a dense vector,
+   and normalization of its rows to unit norm. These either write the result
+   into a new vector, or overwrite 'values' when passing 'inplace' (in which
+   case the R object is modified, along with any other object sharing its
+   'x' slot), which avoids allocating a second array of the same size.
+   Since the input and output might then be the same array, the pointers
+   to them are not marked as 'restrict'.
+
+   Rows that have zero norm are left as they are. */
+enum RowNormType {RowNormMax = 0, RowNormL1 = 1, RowNormL2 = 2};
+
+static Rcpp::NumericVector get_scaling_output(Rcpp::NumericVector values, const bool inplace)
+{
+    if (inplace)
+        return values;
+    VectorConstructorArgs args;
+    args.size = values.size();
+    return Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::NumericVector scale_csr_rows
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::NumericVector values,
+    Rcpp::NumericVector scaling,
+    const bool inplace,
+    int nthreads
+)
+{
+    const int nrows = indptr.size() - 1;
+    const int *restrict indptr_ = INTEGER(indptr);
+    const double *values_ = REAL(values);
+    const double *restrict scaling_ = REAL(scaling);
+    Rcpp::NumericVector out = get_scaling_output(values, inplace);
+    double *out_ = REAL(out);
+    nthreads = std::max(1, std::min(nthreads, nrows));
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+            shared(indptr_, values_, scaling_, out_)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        const double s = scaling_[row];
+        #ifdef _OPENMP
+        #pragma omp simd
+        #endif
+        for (int ix = indptr_[row]; ix < indptr_[row+1]; ix++)
+            out_[ix] = values_[ix] * s;
+    }
+
+    return out;
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::NumericVector scale_csr_cols
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    Rcpp::NumericVector values,
+    Rcpp::NumericVector scaling,
+    const bool inplace,
+    int nthreads
+)
+{
+    const int nrows = indptr.size() - 1;
+    const int *restrict indptr_ = INTEGER(indptr);
+    const int *restrict indices_ = INTEGER(indices);
+    const double *values_ = REAL(values);
+    const double *restrict scaling_ = REAL(scaling);
+    Rcpp::NumericVector out = get_scaling_output(values, inplace);
+    double *out_ = REAL(out);
+    nthreads = std::max(1, std::min(nthreads, nrows));
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+            shared(indptr_, indices_, values_, scaling_, out_)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        for (int ix = indptr_[row]; ix < indptr_[row+1]; ix++)
+            out_[ix] = values_[ix] * scaling_[indices_[ix]];
+    }
+
+    return out;
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::NumericVector normalize_csr_rows
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::NumericVector values,
+    const int norm_type,
+    const bool inplace,
+    int nthreads
+)
+{
+    const int nrows = indptr.size() - 1;
+    const int *restrict indptr_ = INTEGER(indptr);
+    const double *values_ = REAL(values);
+    Rcpp::NumericVector out = get_scaling_output(values, inplace);
+    double *out_ = REAL(out);
+    const RowNormType norm = (RowNormType)norm_type;
+    nthreads = std::max(1, std::min(nthreads, nrows));
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+            shared(indptr_, values_, out_)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        const int st = indptr_[row];
+        const int end = indptr_[row+1];
+        double row_norm = 0;
+        switch (norm)
+        {
+            case RowNormL1:
+            {
+                for (int ix = st; ix < end; ix++)
+                    row_norm += std::fabs(values_[ix]);
+                break;
+            }
+            case RowNormL2:
+            {
+                for (int ix = st; ix < end; ix++)
+                    row_norm += values_[ix] * values_[ix];
+                row_norm = std::sqrt(row_norm);
+                break;
+            }
+            default:
+            {
+                for (int ix = st; ix < end; ix++)
+                {
+                    if (ISNAN(values_[ix]))
+                    {
+                        row_norm = values_[ix];
+                        break;
+                    }
+                    row_norm = std::fmax(row_norm, std::fabs(values_[ix]));
+                }
+                break;
+            }
+        }
+
+        if (row_norm == 0)
+        {
+            if (!inplace)
+                std::copy(values_ + st, values_ + end, out_ + st);
+            continue;
+        }
+
+        const double scaling = 1. / row_norm;
+        #ifdef _OPENMP
+        #pragma omp simd
+        #endif
+        for (int ix = st; ix < end; ix++)
+            out_[ix] = values_[ix] * scaling;
+    }
+
+    return out;
+}
@@ -0,0 +1,123 @@
+#include "MatrixExtra.h"
+
+/* Element-wise mathematical functions over the non-zero values of sparse
+   matrices. These are all functions which map zero to zero, so they only
+   need to be applied to the values that are stored.
+
+   A sequence of functions can be passed, in which case they are applied
+   one after another (first element first) over small blocks of the values
+   that fit in cache, so that the whole array is traversed only once.
+
+   In order to keep the same behavior as base R, the output signals whether
+   the functions produced a NaN from an input that was not NaN. */
+
+enum ScalarFunction {
+    FunSqrt=0, FunAbs=1, FunLog1p=2, FunSin=3, FunTan=4, FunTanh=5, FunSinh=6,
+    FunAtanh=7, FunExpm1=8, FunSign=9, FunCeiling=10, FunFloor=11, FunTrunc=12
+};
+constexpr const int n_scalar_functions = 13;
+constexpr const size_t scalar_fun_block_size = 1024;
+
+static inline double sign_value(const double x)
+{
+    return ISNAN(x)? x : (double)((x > 0) - (x < 0));
+}
+
+#ifdef _OPENMP
+#   define apply_over_block(fun) \
+    _Pragma("omp simd") \
+    for (size_t ix = 0; ix < n; ix++) \
+        out[ix] = fun(inp[ix]); \
+    break;
+#else
+#   define apply_over_block(fun) \
+    for (size_t ix = 0; ix < n; ix++) \
+        out[ix] = fun(inp[ix]); \
+    break;
+#endif
+
+/* 'inp' and 'out' might point to the same array */
+static void apply_scalar_function_block(const ScalarFunction fun, const double *inp, double *out, const size_t n)
+{
+    switch (fun)
+    {
+        case FunSqrt: {apply_over_block(std::sqrt)}
+        case FunAbs: {apply_over_block(std::fabs)}
+        case FunLog1p: {apply_over_block(std::log1p)}
+        case FunSin: {apply_over_block(std::sin)}
+        case FunTan: {apply_over_block(std::tan)}
+        case FunTanh: {apply_over_block(std::tanh)}
+        case FunSinh: {apply_over_block(std::sinh)}
+        case FunAtanh: {apply_over_block(std::atanh)}
+        case FunExpm1: {apply_over_block(std::expm1)}
+        case FunSign: {apply_over_block(sign_value)}
+        case FunCeiling: {apply_over_block(std::ceil)}
+        case FunFloor: {apply_over_block(std::floor)}
+        case FunTrunc: {apply_over_block(std::trunc)}
+    }
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List apply_scalar_functions
+(
+    Rcpp::NumericVector values,
+    Rcpp::IntegerVector functions,
+    const bool inplace,
+    int nthreads
+)
+{
+    const int nfuns = functions.size();
+    const int *restrict functions_ = INTEGER(functions);
+    for (int fun = 0; fun < nfuns; fun++) {
+        if (functions_[fun] < 0 || functions_[fun] >= n_scalar_functions)
+            Rcpp::stop("Invalid function code.");
+    }
+
+    Rcpp::NumericVector out;
+    if (inplace) {
+        out = values;
+    }
+    else {
+        VectorConstructorArgs args;
+        args.size = values.size();
+        out = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    }
+
+    const size_t n = values.size();
+    const double *values_ = REAL(values);
+    double *out_ = REAL(out);
+    const size_t nblocks = n / scalar_fun_block_size + (n % scalar_fun_block_size != 0);
+    nthreads = std::max(1, (int)std::min((size_t)nthreads, nblocks));
+    bool produced_nan = false;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads) \
+            shared(values_, out_, functions_) reduction(||:produced_nan)
+    #endif
+    for (size_t block = 0; block < nblocks; block++)
+    {
+        const size_t st = block * scalar_fun_block_size;
+        const size_t block_size = std::min(scalar_fun_block_size, n - st);
+
+        bool had_nan[scalar_fun_block_size];
+        for (size_t ix = 0; ix < block_size; ix++)
+            had_nan[ix] = ISNAN(values_[st + ix]);
+
+        const double *inp = values_ + st;
+        for (int fun = 0; fun < nfuns; fun++)
+        {
+            apply_scalar_function_block((ScalarFunction)functions_[fun], inp, out_ + st, block_size);
+            inp = out_ + st;
+        }
+        if (!nfuns && !inplace)
+            std::copy(values_ + st, values_ + st + block_size, out_ + st);
+
+        for (size_t ix = 0; ix < block_size; ix++)
+            produced_nan = produced_nan || (!had_nan[ix] && ISNAN(out_[st + ix]));
+    }
+
+    return Rcpp::List::create(
+        Rcpp::_["values"] = out,
+        Rcpp::_["produced_nan"] = Rcpp::wrap(produced_nan)
+    );
+}
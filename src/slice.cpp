@@ -220,73 +220,165 @@ void reverse_columns_inplace_binary
     );
 }
 
-/* TODO: make these ones work also for logical vectors */
+/* The row-slicing functions below work in two passes: first, the number of
+   entries that each selected row will have in the output is determined and
+   accumulated into the output 'indptr', and then each row is copied in
+   parallel into its position in the (already allocated) output arrays. */
 
-template <class RcppVector>
-Rcpp::List copy_csr_rows_template
+static inline size_large cumsum_indptr_slice(int *restrict indptr, const int nrows)
+{
+    size_large total = 0;
+    for (int row = 0; row < nrows; row++)
+    {
+        total += indptr[row+1];
+        if (total > (size_large)INT_MAX)
+            Rcpp::stop("Error: resulting matrix would have too many entries for a sparse CSR representation (int overflow).");
+        indptr[row+1] = (int)total;
+    }
+    return total;
+}
+
+/* Works on raw pointers so that it can also be used with matrices that
+   are not held in R memory (e.g. memory-mapped files). If the matrix is
+   binary, 'ptr_values' should be passed as NULL. */
+template <class RcppVector, class InputDType>
+Rcpp::List copy_csr_rows_ptr
 (
-    Rcpp::IntegerVector indptr,
-    Rcpp::IntegerVector indices,
-    RcppVector values,
-    Rcpp::IntegerVector rows_take
+    const int *restrict ptr_indptr,
+    const int *restrict ptr_indices,
+    const InputDType *restrict ptr_values,
+    const int *restrict ptr_rows_take,
+    const int n_take,
+    int nthreads
 )
 {
-    size_t total_size = 0;
-    for (const int row : rows_take) total_size += indptr[row + 1] - indptr[row];
+    profile_kernel("copy_csr_rows");
+    Rcpp::IntegerVector new_indptr = Rcpp::IntegerVector(n_take + 1);
+    profile_count_allocation(new_indptr);
+    int *restrict ptr_new_indptr = new_indptr.begin();
+    const bool has_values = ptr_values != nullptr;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads) \
+            shared(ptr_indptr, ptr_rows_take, ptr_new_indptr)
+    #endif
+    for (int ix = 0; ix < n_take; ix++)
+        ptr_new_indptr[ix + 1] = ptr_indptr[ptr_rows_take[ix] + 1] - ptr_indptr[ptr_rows_take[ix]];
+    const size_t total_size = cumsum_indptr_slice(ptr_new_indptr, n_take);
+
     if (total_size == 0) {
-        return Rcpp::List::create(Rcpp::_["indptr"] = Rcpp::IntegerVector(),
+        return Rcpp::List::create(Rcpp::_["indptr"] = new_indptr,
                                   Rcpp::_["indices"] = Rcpp::IntegerVector(),
                                   Rcpp::_["values"] = RcppVector());
     }
-    
-    Rcpp::IntegerVector new_indptr = Rcpp::IntegerVector(rows_take.size() + 1);
-    Rcpp::IntegerVector new_indices = Rcpp::IntegerVector(total_size);
-    RcppVector new_values = RcppVector(values.size()? total_size : 0);
-
-    size_t n_copy;
-    int row;
-    int *restrict ptr_indptr = indptr.begin();
-    int *restrict ptr_indices = indices.begin();
-    auto *restrict prt_values = values.begin();
-    int *restrict ptr_new_indptr = new_indptr.begin();
+
+    VectorConstructorArgs args;
+    args.as_integer = true; args.size = total_size;
+    Rcpp::IntegerVector new_indices = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    RcppVector new_values;
+    if (has_values) {
+        args.as_integer = !std::is_same<RcppVector, Rcpp::NumericVector>::value;
+        args.as_logical = std::is_same<RcppVector, Rcpp::LogicalVector>::value;
+        new_values = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    }
     int *restrict ptr_new_indices = new_indices.begin();
-    auto *restrict ptr_new_values = new_values.begin();
-    const bool has_values = values.size() > 0;
+    InputDType *restrict ptr_new_values = has_values? (InputDType*)new_values.begin() : nullptr;
 
-    size_t curr = 0;
-    for (int ix = 0; ix < (int)rows_take.size(); ix++)
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(ptr_indptr, ptr_indices, ptr_values, ptr_rows_take, \
+                   ptr_new_indptr, ptr_new_indices, ptr_new_values)
+    #endif
+    for (int ix = 0; ix < n_take; ix++)
     {
-        row = rows_take[ix];
-        n_copy = ptr_indptr[row + 1] - ptr_indptr[row];
-        ptr_new_indptr[ix + 1] = ptr_new_indptr[ix] + n_copy;
-        if (n_copy) {
+        const int row = ptr_rows_take[ix];
+        if (ptr_indptr[row] < ptr_indptr[row + 1]) {
             std::copy(ptr_indices + ptr_indptr[row], ptr_indices + ptr_indptr[row + 1],
-                      ptr_new_indices + curr);
+                      ptr_new_indices + ptr_new_indptr[ix]);
             if (has_values)
-            std::copy(prt_values + ptr_indptr[row], prt_values + ptr_indptr[row + 1],
-                      ptr_new_values + curr);
+            std::copy(ptr_values + ptr_indptr[row], ptr_values + ptr_indptr[row + 1],
+                      ptr_new_values + ptr_new_indptr[ix]);
         }
-        curr += n_copy;
     }
     return Rcpp::List::create(Rcpp::_["indptr"] = new_indptr,
                               Rcpp::_["indices"] = new_indices,
                               Rcpp::_["values"] = new_values);
 }
 
+template <class RcppVector>
+Rcpp::List copy_csr_rows_template
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    RcppVector values,
+    Rcpp::IntegerVector rows_take,
+    int nthreads
+)
+{
+    typedef typename std::remove_reference<decltype(*values.begin())>::type InputDType;
+    return copy_csr_rows_ptr<RcppVector, InputDType>(
+        indptr.begin(),
+        indices.begin(),
+        (values.size() > 0)? (const InputDType*)values.begin() : (const InputDType*)nullptr,
+        rows_take.begin(),
+        rows_take.size(),
+        nthreads
+    );
+}
+
+/* Same as 'copy_csr_rows', but taking the matrix from a memory-mapped file,
+   which will only read from disk the pages that contain the selected rows. */
+// [[Rcpp::export(rng = false)]]
+Rcpp::List copy_csr_rows_mmap
+(
+    SEXP mapped_ptr,
+    Rcpp::IntegerVector rows_take,
+    int nthreads
+)
+{
+    MappedCSR *mapped = get_mapped_csr(mapped_ptr);
+    Rcpp::List out;
+    switch (mapped->values_type)
+    {
+        case MappedNumeric:
+            out = copy_csr_rows_ptr<Rcpp::NumericVector, double>(
+                mapped->indptr, mapped->indices, (const double*)mapped->values,
+                rows_take.begin(), rows_take.size(), nthreads
+            );
+            break;
+        case MappedLogical:
+            out = copy_csr_rows_ptr<Rcpp::LogicalVector, int>(
+                mapped->indptr, mapped->indices, (const int*)mapped->values,
+                rows_take.begin(), rows_take.size(), nthreads
+            );
+            break;
+        default:
+            out = copy_csr_rows_ptr<Rcpp::NumericVector, double>(
+                mapped->indptr, mapped->indices, (const double*)nullptr,
+                rows_take.begin(), rows_take.size(), nthreads
+            );
+    }
+    Rcpp::IntegerVector indices_out = out["indices"];
+    check_mapped_indices(mapped, INTEGER(indices_out), indices_out.size());
+    return out;
+}
+
 // [[Rcpp::export(rng = false)]]
 Rcpp::List copy_csr_rows_numeric
 (
     Rcpp::IntegerVector indptr,
     Rcpp::IntegerVector indices,
     Rcpp::NumericVector values,
-    Rcpp::IntegerVector rows_take
+    Rcpp::IntegerVector rows_take,
+    int nthreads
 )
 {
     return copy_csr_rows_template(
         indptr,
         indices,
         values,
-        rows_take
+        rows_take,
+        nthreads
     );
 }
 
@@ -296,14 +388,16 @@ Rcpp::List copy_csr_rows_logical
     Rcpp::IntegerVector indptr,
     Rcpp::IntegerVector indices,
     Rcpp::LogicalVector values,
-    Rcpp::IntegerVector rows_take
+    Rcpp::IntegerVector rows_take,
+    int nthreads
 )
 {
     return copy_csr_rows_template(
         indptr,
         indices,
         values,
-        rows_take
+        rows_take,
+        nthreads
     );
 }
 
@@ -312,14 +406,16 @@ Rcpp::List copy_csr_rows_binary
 (
     Rcpp::IntegerVector indptr,
     Rcpp::IntegerVector indices,
-    Rcpp::IntegerVector rows_take
+    Rcpp::IntegerVector rows_take,
+    int nthreads
 )
 {
     return copy_csr_rows_template(
         indptr,
         indices,
         Rcpp::NumericVector(),
-        rows_take
+        rows_take,
+        nthreads
     );
 }
 
@@ -331,26 +427,36 @@ Rcpp::List copy_csr_rows_col_seq_template
     RcppVector values,
     Rcpp::IntegerVector rows_take,
     Rcpp::IntegerVector cols_take,
-    const bool index1
+    const bool index1,
+    int nthreads
 )
 {
+    profile_kernel("copy_csr_rows_col_seq");
     const int min_col = *std::min_element(cols_take.begin(), cols_take.end()) - index1;
     const int max_col = *std::max_element(cols_take.begin(), cols_take.end()) - index1;
-    Rcpp::IntegerVector new_indptr(rows_take.size() + 1);
+    const int n_take = rows_take.size();
+    Rcpp::IntegerVector new_indptr(n_take + 1);
+    profile_count_allocation(new_indptr);
 
-    int *restrict ptr_indptr = indptr.begin();
-    int *restrict ptr_indices = indices.begin();
-    auto *restrict ptr_values = values.begin();
+    const int *restrict ptr_indptr = indptr.begin();
+    const int *restrict ptr_indices = indices.begin();
+    const auto *restrict ptr_values = values.begin();
+    const int *restrict ptr_rows_take = rows_take.begin();
     int *restrict ptr_new_indptr = new_indptr.begin();
     const bool has_values = values.size() > 0;
 
-    size_t total_size = 0;
-    for (int row = 0; row < (int)rows_take.size(); row++)
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(ptr_indptr, ptr_indices, ptr_rows_take, ptr_new_indptr)
+    #endif
+    for (int row = 0; row < n_take; row++)
     {
-        for (int ix = ptr_indptr[rows_take[row]]; ix < ptr_indptr[rows_take[row] + 1]; ix++)
-            total_size += (ptr_indices[ix] >= min_col) && (ptr_indices[ix] <= max_col);
-        ptr_new_indptr[row + 1] = total_size;
+        int n_this = 0;
+        for (int ix = ptr_indptr[ptr_rows_take[row]]; ix < ptr_indptr[ptr_rows_take[row] + 1]; ix++)
+            n_this += (ptr_indices[ix] >= min_col) && (ptr_indices[ix] <= max_col);
+        ptr_new_indptr[row + 1] = n_this;
     }
+    const size_t total_size = cumsum_indptr_slice(ptr_new_indptr, n_take);
 
     if (total_size == 0) {
         return Rcpp::List::create(Rcpp::_["indptr"] = new_indptr,
@@ -358,15 +464,25 @@ Rcpp::List copy_csr_rows_col_seq_template
                                   Rcpp::_["values"] = Rcpp::NumericVector());
     }
 
-    Rcpp::IntegerVector new_indices = Rcpp::IntegerVector(total_size);
-    Rcpp::NumericVector new_values = Rcpp::NumericVector(has_values? total_size : 0);
+    VectorConstructorArgs args;
+    args.as_integer = true; args.size = total_size;
+    Rcpp::IntegerVector new_indices = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    args.as_integer = false; args.size = has_values? total_size : 0;
+    Rcpp::NumericVector new_values = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
     int *restrict ptr_new_indices = new_indices.begin();
     auto *restrict ptr_new_values = new_values.begin();
 
-    int curr = 0;
-    for (int row = 0; row < (int)rows_take.size(); row++)
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(ptr_indptr, ptr_indices, ptr_values, ptr_rows_take, \
+                   ptr_new_indptr, ptr_new_indices, ptr_new_values)
+    #endif
+    for (int row = 0; row < n_take; row++)
     {
-        for (int ix = ptr_indptr[rows_take[row]]; ix < ptr_indptr[rows_take[row] + 1]; ix++)
+        int curr = ptr_new_indptr[row];
+        if (curr == ptr_new_indptr[row + 1])
+            continue;
+        for (int ix = ptr_indptr[ptr_rows_take[row]]; ix < ptr_indptr[ptr_rows_take[row] + 1]; ix++)
         {
             if ((ptr_indices[ix] >= min_col) && (ptr_indices[ix] <= max_col))
             {
@@ -390,7 +506,8 @@ Rcpp::List copy_csr_rows_col_seq_numeric
     Rcpp::NumericVector values,
     Rcpp::IntegerVector rows_take,
     Rcpp::IntegerVector cols_take,
-    const bool index1
+    const bool index1,
+    int nthreads
 )
 {
     return copy_csr_rows_col_seq_template(
@@ -399,7 +516,8 @@ Rcpp::List copy_csr_rows_col_seq_numeric
         values,
         rows_take,
         cols_take,
-        index1
+        index1,
+        nthreads
     );
 }
 
@@ -411,7 +529,8 @@ Rcpp::List copy_csr_rows_col_seq_logical
     Rcpp::LogicalVector values,
     Rcpp::IntegerVector rows_take,
     Rcpp::IntegerVector cols_take,
-    const bool index1
+    const bool index1,
+    int nthreads
 )
 {
     return copy_csr_rows_col_seq_template(
@@ -420,7 +539,8 @@ Rcpp::List copy_csr_rows_col_seq_logical
         values,
         rows_take,
         cols_take,
-        index1
+        index1,
+        nthreads
     );
 }
 
@@ -431,7 +551,8 @@ Rcpp::List copy_csr_rows_col_seq_binary
     Rcpp::IntegerVector indices,
     Rcpp::IntegerVector rows_take,
     Rcpp::IntegerVector cols_take,
-    const bool index1
+    const bool index1,
+    int nthreads
 )
 {
     return copy_csr_rows_col_seq_template(
@@ -440,12 +561,16 @@ Rcpp::List copy_csr_rows_col_seq_binary
         Rcpp::NumericVector(),
         rows_take,
         cols_take,
-        index1
+        index1,
+        nthreads
     );
 }
 
-/* TODO: if the indices are sorted, this function could use std::lower_bound instead */
-
+/* The mapping from columns in the input to columns in the output is kept in
+   a CSR-like structure: each distinct column in 'cols_take' gets an entry
+   (found through a hash map), and its output positions are stored contiguously
+   in 'map_targets', from 'map_indptr[entry]' to 'map_indptr[entry+1]'. This
+   avoids allocating a separate vector for each repeated column. */
 template <class RcppVector, class InputDType, class CompileFlag>
 Rcpp::List copy_csr_arbitrary_template
 (
@@ -453,35 +578,37 @@ Rcpp::List copy_csr_arbitrary_template
     Rcpp::IntegerVector indices,
     RcppVector values,
     Rcpp::IntegerVector rows_take,
-    Rcpp::IntegerVector cols_take
+    Rcpp::IntegerVector cols_take,
+    int nthreads
 )
 {
-    Rcpp::IntegerVector new_indptr(rows_take.size()+1);
+    profile_kernel("copy_csr_arbitrary");
+    const bool has_values = std::is_same<CompileFlag, bool>::value;
+    const int n_take = rows_take.size();
+    const int n_cols_take = cols_take.size();
+    Rcpp::IntegerVector new_indptr(n_take + 1);
+    profile_count_allocation(new_indptr);
 
-    hashed_map<int, int> new_mapping;
-    new_mapping.reserve(cols_take.size());
-    for (int col = 0; col < (int)cols_take.size(); col++) new_mapping[cols_take[col]] = col;
-    hashed_map<int, int> n_repeats;
-    n_repeats.reserve(cols_take.size());
-    for (auto el : cols_take) n_repeats[el]++;
-    bool has_duplicates = false;
-    for (auto& el : n_repeats) {
-        if (el.second > 1) {
-            has_duplicates = true;
-            break;
-        }
+    hashed_map<int, int> col_to_entry;
+    col_to_entry.reserve(n_cols_take);
+    std::vector<int> map_indptr(1, 0);
+    for (int col = 0; col < n_cols_take; col++)
+    {
+        auto inserted = col_to_entry.insert({cols_take[col], (int)map_indptr.size() - 1});
+        if (inserted.second)
+            map_indptr.push_back(0);
+        map_indptr[inserted.first->second + 1]++;
     }
-    hashed_map<int, std::vector<int>> indices_rep;
-    if (has_duplicates) {
-        for (int col = 0; col < (int)cols_take.size(); col++) {
-            if (n_repeats[cols_take[col]] > 1) {
-                indices_rep[cols_take[col]].push_back(col);
-            }
-        }
+    std::partial_sum(map_indptr.begin(), map_indptr.end(), map_indptr.begin());
+    std::vector<int> map_targets(n_cols_take);
+    {
+        std::vector<int> map_curr(map_indptr.begin(), map_indptr.end() - 1);
+        for (int col = 0; col < n_cols_take; col++)
+            map_targets[map_curr[col_to_entry[cols_take[col]]]++] = col;
     }
 
     bool cols_are_sorted = true;
-    for (int ix = 1; ix < (int)cols_take.size(); ix++) {
+    for (int ix = 1; ix < n_cols_take; ix++) {
         if (cols_take[ix] < cols_take[ix - 1]) {
             cols_are_sorted = false;
             break;
@@ -491,89 +618,112 @@ Rcpp::List copy_csr_arbitrary_template
     const int min_j = *std::min_element(cols_take.begin(), cols_take.end());
     const int max_j = *std::max_element(cols_take.begin(), cols_take.end());
 
-    std::vector<int> new_indices;
-    std::vector<InputDType> new_values;
-
-    std::vector<int> argsort_cols(cols_take.size());
-    std::vector<int> temp_int(cols_take.size());
-    std::vector<InputDType> temp_double(values.size()? cols_take.size() : 0);
+    const int *restrict ptr_indptr = indptr.begin();
+    const int *restrict ptr_indices = indices.begin();
+    const InputDType *restrict ptr_values = has_values? (const InputDType*)values.begin() : nullptr;
+    const int *restrict ptr_rows_take = rows_take.begin();
+    int *restrict ptr_new_indptr = new_indptr.begin();
+    const int *restrict ptr_map_indptr = map_indptr.data();
+    const int *restrict ptr_map_targets = map_targets.data();
 
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(ptr_indptr, ptr_indices, ptr_rows_take, ptr_new_indptr, col_to_entry, ptr_map_indptr)
+    #endif
+    for (int row_ix = 0; row_ix < n_take; row_ix++)
+    {
+        const int row = ptr_rows_take[row_ix];
+        int n_this = 0;
+        for (int ix = ptr_indptr[row]; ix < ptr_indptr[row + 1]; ix++)
+        {
+            if (ptr_indices[ix] < min_j || ptr_indices[ix] > max_j)
+                continue;
+            auto match = col_to_entry.find(ptr_indices[ix]);
+            if (match != col_to_entry.end())
+                n_this += ptr_map_indptr[match->second + 1] - ptr_map_indptr[match->second];
+        }
+        ptr_new_indptr[row_ix + 1] = n_this;
+    }
+    const size_t total_size = cumsum_indptr_slice(ptr_new_indptr, n_take);
 
-    size_t size_reserve = get_size_reserve(indices.size(), rows_take.size(), cols_take.size());
-    new_indices.reserve(size_reserve);
-    if (std::is_same<CompileFlag, bool>::value) new_values.reserve(size_reserve);
+    VectorConstructorArgs args;
+    args.as_integer = true; args.size = total_size;
+    Rcpp::IntegerVector new_indices = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    RcppVector new_values;
+    if (has_values) {
+        args.as_integer = !std::is_same<RcppVector, Rcpp::NumericVector>::value;
+        args.as_logical = std::is_same<RcppVector, Rcpp::LogicalVector>::value;
+        new_values = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    }
+    int *restrict ptr_new_indices = new_indices.begin();
+    InputDType *restrict ptr_new_values = has_values? (InputDType*)new_values.begin() : nullptr;
 
-    int size_this = 0;
-    int row = 0;
-    hashed_map<int, int>::iterator match;
+    std::vector<int> argsort_cols;
+    std::vector<int> temp_int;
+    std::vector<InputDType> temp_values;
 
-    for (int row_ix = 0; row_ix < (int)rows_take.size(); row_ix++)
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+            shared(ptr_indptr, ptr_indices, ptr_values, ptr_rows_take, ptr_new_indptr, \
+                   ptr_new_indices, ptr_new_values, col_to_entry, ptr_map_indptr, ptr_map_targets) \
+            private(argsort_cols, temp_int, temp_values)
+    #endif
+    for (int row_ix = 0; row_ix < n_take; row_ix++)
     {
-        row = rows_take[row_ix];
-        for (int ix = indptr[row]; ix < indptr[row + 1]; ix++)
+        const int st_out = ptr_new_indptr[row_ix];
+        const int size_this = ptr_new_indptr[row_ix + 1] - st_out;
+        if (!size_this)
+            continue;
+
+        const int row = ptr_rows_take[row_ix];
+        int curr = st_out;
+        for (int ix = ptr_indptr[row]; ix < ptr_indptr[row + 1]; ix++)
         {
-            if (indices[ix] < min_j || indices[ix] > max_j)
+            if (ptr_indices[ix] < min_j || ptr_indices[ix] > max_j)
                 continue;
-
-            match = new_mapping.find(indices[ix]);
-            if (match != new_mapping.end())
+            auto match = col_to_entry.find(ptr_indices[ix]);
+            if (match != col_to_entry.end())
             {
-                if (has_duplicates && n_repeats[indices[ix]] > 1)
+                for (int el = ptr_map_indptr[match->second]; el < ptr_map_indptr[match->second + 1]; el++)
                 {
-                    for (const auto el : indices_rep[indices[ix]]) {
-                        new_indices.push_back(el);
-                        if (std::is_same<CompileFlag, bool>::value)
-                        new_values.push_back(values[ix]);
-                    }
-                }
-                else
-                {
-                    new_indices.push_back(match->second);
-                    if (std::is_same<CompileFlag, bool>::value)
-                    new_values.push_back(values[ix]);
+                    ptr_new_indices[curr] = ptr_map_targets[el];
+                    if (has_values)
+                    ptr_new_values[curr] = ptr_values[ix];
+                    curr++;
                 }
             }
         }
-        new_indptr[row_ix + 1] = new_indices.size();
-        if (!cols_are_sorted && new_indptr[row_ix + 1] > new_indptr[row_ix])
+
+        if (!cols_are_sorted && size_this > 1)
         {
-            size_this = new_indptr[row_ix + 1] - new_indptr[row_ix];
-            std::iota(argsort_cols.begin(), argsort_cols.begin() + size_this,
-                      new_indptr[row_ix]);
+            if ((int)argsort_cols.size() < size_this) {
+                argsort_cols.resize(size_this);
+                temp_int.resize(size_this);
+                if (has_values) temp_values.resize(size_this);
+            }
+            int *restrict row_indices = ptr_new_indices + st_out;
+            std::iota(argsort_cols.begin(), argsort_cols.begin() + size_this, 0);
             std::sort(argsort_cols.begin(), argsort_cols.begin() + size_this,
-                      [&new_indices](const int a, const int b) {
-                        return new_indices[a] < new_indices[b];
+                      [&row_indices](const int a, const int b) {
+                        return row_indices[a] < row_indices[b];
                     });
             for (int col = 0; col < size_this; col++) {
-                temp_int[col] = new_indices[argsort_cols[col]];
-                if (std::is_same<CompileFlag, bool>::value)
-                temp_double[col] = new_values[argsort_cols[col]];
+                temp_int[col] = row_indices[argsort_cols[col]];
+                if (has_values)
+                temp_values[col] = ptr_new_values[st_out + argsort_cols[col]];
             }
-            std::copy(temp_int.begin(), temp_int.begin() + size_this,
-                      new_indices.begin() + new_indptr[row_ix]);
-            if (std::is_same<CompileFlag, bool>::value)
-            std::copy(temp_double.begin(), temp_double.begin() + size_this,
-                      new_values.begin() + new_indptr[row_ix]);
+            std::copy(temp_int.begin(), temp_int.begin() + size_this, row_indices);
+            if (has_values)
+            std::copy(temp_values.begin(), temp_values.begin() + size_this,
+                      ptr_new_values + st_out);
         }
     }
 
     Rcpp::List out;
     out["indptr"] = new_indptr;
-    VectorConstructorArgs args;
-    args.as_integer = true; args.from_cpp_vec = true; args.int_vec_from = &new_indices;
-    out["indices"] = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    new_indices.clear();
-    if (values.size()) {
-        if (std::is_same<RcppVector, Rcpp::LogicalVector>::value) {
-            args.as_integer = true; args.from_cpp_vec = true; args.int_vec_from = &new_values;
-            args.as_logical = true;
-        } else if (std::is_same<RcppVector, Rcpp::IntegerVector>::value) {
-            args.as_integer = true; args.from_cpp_vec = true; args.int_vec_from = &new_values;
-        } else {
-            args.as_integer = false; args.from_cpp_vec = true; args.num_vec_from = &new_values;
-        }
-        out["values"] = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    }
+    out["indices"] = new_indices;
+    if (has_values)
+        out["values"] = new_values;
     return out;
 }
 
@@ -584,7 +734,8 @@ Rcpp::List copy_csr_arbitrary_numeric
     Rcpp::IntegerVector indices,
     Rcpp::NumericVector values,
     Rcpp::IntegerVector rows_take,
-    Rcpp::IntegerVector cols_take
+    Rcpp::IntegerVector cols_take,
+    int nthreads
 )
 {
     return copy_csr_arbitrary_template<Rcpp::NumericVector, double, bool>(
@@ -592,7 +743,8 @@ Rcpp::List copy_csr_arbitrary_numeric
         indices,
         values,
         rows_take,
-        cols_take
+        cols_take,
+        nthreads
     );
 }
 
@@ -603,7 +755,8 @@ Rcpp::List copy_csr_arbitrary_logical
     Rcpp::IntegerVector indices,
     Rcpp::LogicalVector values,
     Rcpp::IntegerVector rows_take,
-    Rcpp::IntegerVector cols_take
+    Rcpp::IntegerVector cols_take,
+    int nthreads
 )
 {
     return copy_csr_arbitrary_template<Rcpp::LogicalVector, int, bool>(
@@ -611,7 +764,8 @@ Rcpp::List copy_csr_arbitrary_logical
         indices,
         values,
         rows_take,
-        cols_take
+        cols_take,
+        nthreads
     );
 }
 
@@ -621,7 +775,8 @@ Rcpp::List copy_csr_arbitrary_binary
     Rcpp::IntegerVector indptr,
     Rcpp::IntegerVector indices,
     Rcpp::IntegerVector rows_take,
-    Rcpp::IntegerVector cols_take
+    Rcpp::IntegerVector cols_take,
+    int nthreads
 )
 {
     return copy_csr_arbitrary_template<Rcpp::NumericVector, double, int>(
@@ -629,7 +784,8 @@ Rcpp::List copy_csr_arbitrary_binary
         indices,
         Rcpp::NumericVector(),
         rows_take,
-        cols_take
+        cols_take,
+        nthreads
     );
 }
 
@@ -784,6 +940,93 @@ double extract_single_val_csr_binary
     );
 }
 
+/* Diagonal of a CSR matrix, looking up each entry within its row (see
+   'find_col_in_row' for how the rows are searched). Output is numeric for numeric matrices and
+   logical (as integers) otherwise, with 'values' passed as NULL for binary matrices. */
+template <class real_t, class RcppVector>
+static RcppVector extract_diag_csr
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    real_t *restrict values,
+    const int ndiag,
+    int nthreads
+)
+{
+    VectorConstructorArgs args;
+    args.as_integer = !std::is_same<real_t, double>::value;
+    args.as_logical = args.as_integer;
+    args.size = ndiag;
+    RcppVector out = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    if (!ndiag)
+        return out;
+
+    int *restrict indptr_ = INTEGER(indptr);
+    int *restrict indices_ = INTEGER(indices);
+    real_t *restrict out_ = std::is_same<real_t, double>::value? (real_t*)REAL(out) : (real_t*)LOGICAL(out);
+    nthreads = std::max(1, std::min(nthreads, ndiag / 256));
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads) \
+            shared(indptr_, indices_, values, out_)
+    #endif
+    for (int row = 0; row < ndiag; row++)
+    {
+        const int *end = indices_ + indptr_[row+1];
+        const int *res = find_col_in_row(indices_ + indptr_[row], end, row);
+        if (res == end)
+            out_[row] = 0;
+        else
+            out_[row] = values? values[res - indices_] : 1;
+    }
+
+    return out;
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::NumericVector extract_diag_csr_numeric
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    Rcpp::NumericVector values,
+    const int ndiag,
+    int nthreads
+)
+{
+    return extract_diag_csr<double, Rcpp::NumericVector>(
+        indptr, indices, REAL(values), ndiag, nthreads
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::LogicalVector extract_diag_csr_logical
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    Rcpp::LogicalVector values,
+    const int ndiag,
+    int nthreads
+)
+{
+    return extract_diag_csr<int, Rcpp::LogicalVector>(
+        indptr, indices, LOGICAL(values), ndiag, nthreads
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::LogicalVector extract_diag_csr_binary
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    const int ndiag,
+    int nthreads
+)
+{
+    return extract_diag_csr<int, Rcpp::LogicalVector>(
+        indptr, indices, (int*)nullptr, ndiag, nthreads
+    );
+}
+
 #ifdef __clang__
 #   pragma clang diagnostic pop
 #endif
@@ -70,85 +70,143 @@ bool slice_coo_single_binary
     );
 }
 
-void process_i_arbitrary
-(
-    Rcpp::IntegerVector rows_take_base1,
-    const bool all_i, const bool i_is_seq, const bool i_is_rev_seq,
-    const int first_i, const int last_i,
-    const int nrows,
-    int &min_i, int &max_i,
-    hashed_map<int, int> &i_mapping,
-    hashed_map<int, std::vector<int>> &i_indices_rep,
-    bool &i_has_duplicates
-)
+/* Mapping from the row (or column) indices of the input matrix to the
+   positions that they take in the output, without hashing:
+    - If taking all indices or a sequence (in either direction), the
+      position is calculated directly from the index.
+    - If the selection is dense relative to the dimension, uses an array
+      with one entry per index, telling where the positions for that index
+      start in a second array (thus handling duplicated indices too).
+    - Otherwise, does binary searches over the selected indices, which are
+      argsorted if they are not already in order.
+   In all cases, the positions for an index are given as a range [lo, hi)
+   over the array 'perm', or over the positions themselves if 'perm' is NULL.
+   Positions for the same index are always in increasing order. */
+constexpr const size_large coo_direct_lookup_ratio = 4;
+
+enum CooIndexMappingType {MapAll, MapSeq, MapRevSeq, MapDirect, MapSorted};
+
+struct CooIndexMapping
 {
-    if (all_i) {
-        min_i = 0;
-        max_i = nrows - 1;
-    } else if (i_is_seq) {
-        min_i = first_i;
-        max_i = last_i;
-    } else if (i_is_rev_seq) {
-        min_i = last_i;
-        max_i = first_i;
-    } else {
-        min_i = *std::min_element(rows_take_base1.begin(), rows_take_base1.end()) - 1;
-        max_i = *std::max_element(rows_take_base1.begin(), rows_take_base1.end()) - 1;
-    }
-
-
-    if (!all_i && !i_is_seq && !i_is_rev_seq)
+    CooIndexMappingType type;
+    int first;
+    int n_take;
+    const int *perm = nullptr;
+    const int *sorted = nullptr;
+    const int *offsets = nullptr;
+    std::unique_ptr<int[]> perm_;
+    std::unique_ptr<int[]> sorted_;
+    std::unique_ptr<int[]> offsets_;
+
+    inline void lookup(const int idx, int &lo, int &hi) const
     {
-        for (int ix = 0; ix < rows_take_base1.size(); ix++)
-            i_mapping[rows_take_base1[ix]-1] = ix;
-        i_has_duplicates = i_mapping.size() != (size_t)rows_take_base1.size();
-
-        if (i_has_duplicates)
+        switch (this->type)
         {
-            for (int ix = 0; ix < rows_take_base1.size(); ix++)
-                i_indices_rep[rows_take_base1[ix]-1].push_back(ix);
-        }        
+            case MapAll: {
+                lo = idx; hi = idx + 1;
+                return;
+            }
+            case MapSeq: {
+                lo = idx - this->first; hi = lo + 1;
+                if (lo < 0 || lo >= this->n_take) { lo = 0; hi = 0; }
+                return;
+            }
+            case MapRevSeq: {
+                lo = this->first - idx; hi = lo + 1;
+                if (lo < 0 || lo >= this->n_take) { lo = 0; hi = 0; }
+                return;
+            }
+            case MapDirect: {
+                lo = this->offsets[idx]; hi = this->offsets[idx + 1];
+                return;
+            }
+            case MapSorted: {
+                auto res = std::equal_range(this->sorted, this->sorted + this->n_take, idx);
+                lo = res.first - this->sorted; hi = res.second - this->sorted;
+                return;
+            }
+        }
     }
 
-    else {
-        i_has_duplicates = false;
+    inline int position(const int ix) const
+    {
+        return this->perm? this->perm[ix] : ix;
     }
-}
-
+};
 
-#ifdef __clang__
-#   pragma clang diagnostic push
-#   pragma clang diagnostic ignored "-Wpass-failed"
-#endif
-void post_process_seq
+static void build_coo_index_mapping
 (
-    int *restrict ii_out, size_t n,
-    const bool all_i, const bool i_is_seq, const bool i_is_rev_seq,
-    const int first_i, const int last_i
+    CooIndexMapping &mapping,
+    Rcpp::IntegerVector take_base1,
+    const bool take_all, const bool is_seq, const bool is_rev_seq,
+    const int dim, const size_t nnz
 )
 {
-    if (!all_i)
+    const int n_take = take_base1.size();
+    const int *restrict take = INTEGER(take_base1);
+    mapping.n_take = n_take;
+    mapping.first = take[0] - 1;
+
+    if (take_all) {
+        mapping.type = MapAll;
+        return;
+    }
+    if (is_seq) {
+        mapping.type = MapSeq;
+        return;
+    }
+    if (is_rev_seq) {
+        mapping.type = MapRevSeq;
+        return;
+    }
+
+    if ((size_large)dim <= coo_direct_lookup_ratio * ((size_large)nnz + (size_large)n_take))
     {
-        if (i_is_seq) {
-            #ifdef _OPENMP
-            #pragma omp simd
-            #endif
-            for (size_t ix = 0; ix < n; ix++)
-                ii_out[ix] -= first_i;
-        }
-        else if (i_is_rev_seq) {
-            #ifdef _OPENMP
-            #pragma omp simd
-            #endif
-            for (size_t ix = 0; ix < n; ix++)
-                ii_out[ix] = first_i - ii_out[ix];
-        }
+        mapping.type = MapDirect;
+        mapping.offsets_ = std::unique_ptr<int[]>(new int[(size_t)dim + 1]());
+        mapping.perm_ = std::unique_ptr<int[]>(new int[n_take]);
+        int *restrict offsets = mapping.offsets_.get();
+        int *restrict perm = mapping.perm_.get();
+        for (int ix = 0; ix < n_take; ix++)
+            offsets[take[ix] - 1]++;
+        for (int ix = 0; ix < dim; ix++)
+            offsets[ix + 1] += offsets[ix];
+        /* 'offsets[idx]' now marks the end of the positions for 'idx', so filling
+           in reverse leaves it at the beginning, with the positions in order */
+        for (int ix = n_take - 1; ix >= 0; ix--)
+            perm[--offsets[take[ix] - 1]] = ix;
+        mapping.offsets = offsets;
+        mapping.perm = perm;
+        return;
+    }
+
+    mapping.type = MapSorted;
+    if (std::is_sorted(take, take + n_take))
+    {
+        mapping.sorted_ = std::unique_ptr<int[]>(new int[n_take]);
+        for (int ix = 0; ix < n_take; ix++)
+            mapping.sorted_[ix] = take[ix] - 1;
     }
+
+    else
+    {
+        mapping.perm_ = std::unique_ptr<int[]>(new int[n_take]);
+        std::iota(mapping.perm_.get(), mapping.perm_.get() + n_take, 0);
+        std::stable_sort(mapping.perm_.get(), mapping.perm_.get() + n_take,
+                         [take](const int a, const int b){return take[a] < take[b];});
+        mapping.sorted_ = std::unique_ptr<int[]>(new int[n_take]);
+        for (int ix = 0; ix < n_take; ix++)
+            mapping.sorted_[ix] = take[mapping.perm_[ix]] - 1;
+        mapping.perm = mapping.perm_.get();
+    }
+    mapping.sorted = mapping.sorted_.get();
 }
-#ifdef __clang__
-#   pragma clang diagnostic pop
-#endif
 
+/* Done in two passes over contiguous chunks of the entries, one per thread:
+   the first counts how many outputs each chunk produces, and the second one
+   writes them into the (already allocated) output arrays at the offsets
+   given by the cumulative counts, which keeps the same order as if it were
+   done serially. */
 template <class RcppVector, class InputDType, class CompileFlag>
 Rcpp::List slice_coo_arbitrary_template
 (
@@ -160,468 +218,98 @@ Rcpp::List slice_coo_arbitrary_template
     bool all_i, bool all_j,
     bool i_is_seq, bool j_is_seq,
     bool i_is_rev_seq, bool j_is_rev_seq,
-    int nrows, int ncols
+    int nrows, int ncols,
+    int nthreads
 )
 {
-    size_t nnz = ii.size();
-    size_t size_reserve = get_size_reserve(nnz, rows_take_base1.size(), cols_take_base1.size());
-
-
-    size_t curr = 0;
-    int first_i = rows_take_base1[0] - 1;
-    int first_j = cols_take_base1[0] - 1;
-    int last_i  = rows_take_base1[rows_take_base1.size()-1] - 1;
-    int last_j  = cols_take_base1[cols_take_base1.size()-1] - 1;
-    std::unique_ptr<size_t[]> take;
-
-
-    if ((all_i || i_is_seq) && (all_j || j_is_seq))
-    {
-        take = std::unique_ptr<size_t[]>(new size_t[size_reserve]);
-        int min_i = std::min(first_i, last_i), max_i = std::max(first_i, last_i);
-        int min_j = std::min(first_j, last_j), max_j = std::max(first_j, last_j);
-
-        if (!all_i && !all_j) {
-            for (size_t ix = 0; ix < nnz; ix++) {
-                if (ii[ix] >= min_i && ii[ix] <= max_i && jj[ix] >= min_j && jj[ix] <= max_j)
-                    take[curr++] = ix;
-            }
-        }
-
-        else if (all_i) {
-            for (size_t ix = 0; ix < nnz; ix++) {
-                if (jj[ix] >= min_j && jj[ix] <= max_j)
-                    take[curr++] = ix;
-            }
-        }
-
-        else {
-            for (size_t ix = 0; ix < nnz; ix++) {
-                if (ii[ix] >= min_i && ii[ix] <= max_i)
-                    take[curr++] = ix;
-            }
-        }
-
-        goto easy_end;
-    }
-
-    else if ((all_i || i_is_seq || i_is_rev_seq) && (all_j || j_is_seq || j_is_rev_seq))
-    {
-        take = std::unique_ptr<size_t[]>(new size_t[size_reserve]);
-        int min_i = std::min(first_i, last_i), max_i = std::max(first_i, last_i);
-        int min_j = std::min(first_j, last_j), max_j = std::max(first_j, last_j);
-
-        if (all_i) {
-            for (size_t ix = 0; ix < nnz; ix++) {
-                if (jj[ix] >= min_j && jj[ix] <= max_j)
-                    take[curr++] = ix;
-            }
-        }
-
-        else if (all_j) {
-            for (size_t ix = 0; ix < nnz; ix++) {
-                if (ii[ix] >= min_i && ii[ix] <= max_i)
-                    take[curr++] = ix;
-            }
-        }
-
-        else if (i_is_seq) {
-            for (size_t ix = 0; ix < nnz; ix++) {
-                if (ii[ix] >= min_i && ii[ix] <= max_i && jj[ix] >= min_j && jj[ix] <= max_j)
-                    take[curr++] = ix;
-            }
-        }
+    const size_t nnz = ii.size();
+    const bool has_values = std::is_same<CompileFlag, bool>::value;
 
-        else if (j_is_seq) {
-            for (size_t ix = 0; ix < nnz; ix++) {
-                if (ii[ix] >= min_i && ii[ix] <= max_i && jj[ix] >= min_j && jj[ix] <= max_j)
-                    take[curr++] = ix;
-            }
-        }
+    CooIndexMapping i_mapping, j_mapping;
+    build_coo_index_mapping(i_mapping, rows_take_base1, all_i, i_is_seq, i_is_rev_seq, nrows, nnz);
+    build_coo_index_mapping(j_mapping, cols_take_base1, all_j, j_is_seq, j_is_rev_seq, ncols, nnz);
 
-        else {
-            for (size_t ix = 0; ix < nnz; ix++) {
-                if (ii[ix] >= min_i && ii[ix] <= max_i && jj[ix] >= min_j && jj[ix] <= max_j)
-                    take[curr++] = ix;
-            }
-        }
+    const int *restrict ii_ = INTEGER(ii);
+    const int *restrict jj_ = INTEGER(jj);
+    const InputDType *restrict xx_ = has_values? (const InputDType*)xx.begin() : nullptr;
 
-        goto easy_end;
-    }
+    const int nchunks = std::max(1, (int)std::min((size_t)nthreads, nnz / 1024 + 1));
+    std::unique_ptr<size_large[]> chunk_offsets(new size_large[nchunks + 1]());
 
-    if (false)
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nchunks) \
+            shared(ii_, jj_, i_mapping, j_mapping, chunk_offsets)
+    #endif
+    for (int chunk = 0; chunk < nchunks; chunk++)
     {
-        easy_end:
-        VectorConstructorArgs args;
-        args.as_integer = true; args.from_cpp_vec = false; args.as_logical = false; args.size = curr;
-        Rcpp::IntegerVector ii_out = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-        Rcpp::IntegerVector jj_out = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-        RcppVector xx_out;
-        if (std::is_same<CompileFlag, bool>::value)
+        const size_t st = (nnz * (size_t)chunk) / (size_t)nchunks;
+        const size_t end = (nnz * (size_t)(chunk + 1)) / (size_t)nchunks;
+        size_large n_this = 0;
+        int lo_i, hi_i, lo_j, hi_j;
+        for (size_t ix = st; ix < end; ix++)
         {
-            if (std::is_same<RcppVector, Rcpp::LogicalVector>::value) {
-                args.as_logical = true; args.as_integer = true;
-            }
-            else if (std::is_same<RcppVector, Rcpp::IntegerVector>::value) {
-                args.as_logical = false; args.as_integer = true;
-            } else {
-                args.as_integer = false;
-            }
-
-            xx_out = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+            i_mapping.lookup(ii_[ix], lo_i, hi_i);
+            if (lo_i == hi_i) continue;
+            j_mapping.lookup(jj_[ix], lo_j, hi_j);
+            n_this += (size_large)(hi_i - lo_i) * (size_large)(hi_j - lo_j);
         }
-
-        for (size_t ix = 0; ix < curr; ix++) ii_out[ix] = ii[take[ix]];
-        for (size_t ix = 0; ix < curr; ix++) jj_out[ix] = jj[take[ix]];
-        if (std::is_same<CompileFlag, bool>::value)
-        for (size_t ix = 0; ix < curr; ix++) xx_out[ix] = xx[take[ix]];
-
-        post_process_seq(
-            INTEGER(ii_out), curr,
-            all_i, i_is_seq, i_is_rev_seq,
-            first_i, last_i
-        );
-        post_process_seq(
-            INTEGER(jj_out), curr,
-            all_j, j_is_seq, j_is_rev_seq,
-            first_j, last_j
-        );
-
-        return Rcpp::List::create(
-            Rcpp::_["ii"] = ii_out,
-            Rcpp::_["jj"] = jj_out,
-            Rcpp::_["xx"] = xx_out
-        );
-    }
-
-
-
-
-    int min_i, max_i, min_j, max_j;
-    hashed_map<int, int> i_mapping, j_mapping;
-    hashed_map<int, std::vector<int>> i_indices_rep, j_indices_rep;
-    bool i_has_duplicates = false, j_has_duplicates = false;
-
-    process_i_arbitrary(
-        rows_take_base1,
-        all_i, i_is_seq, i_is_rev_seq,
-        first_i, last_i,
-        nrows,
-        min_i, max_i,
-        i_mapping,
-        i_indices_rep,
-        i_has_duplicates
-    );
-
-    process_i_arbitrary(
-        cols_take_base1,
-        all_j, j_is_seq, j_is_rev_seq,
-        first_j, last_j,
-        ncols,
-        min_j, max_j,
-        j_mapping,
-        j_indices_rep,
-        j_has_duplicates
-    );
-
-    curr = 0;
-    std::vector<int> ii_out;
-    std::vector<int> jj_out;
-    std::vector<InputDType> xx_out;
-    std::unique_ptr<int[]> ii_out_;
-    std::unique_ptr<int[]> jj_out_;
-    std::unique_ptr<InputDType[]> xx_out_;
-    bool use_vectors = false;
-
-    if (!i_has_duplicates && !j_has_duplicates) {
-        use_vectors = false;
-        ii_out_ = std::unique_ptr<int[]>(new int[size_reserve]);
-        jj_out_ = std::unique_ptr<int[]>(new int[size_reserve]);
-        if (std::is_same<CompileFlag, bool>::value)
-        xx_out_ = std::unique_ptr<InputDType[]>(new InputDType[size_reserve]);
+        chunk_offsets[chunk + 1] = n_this;
     }
 
-    else {
-        use_vectors = true;
-        ii_out.reserve(size_reserve);
-        jj_out.reserve(size_reserve);
-        if (std::is_same<CompileFlag, bool>::value)
-        xx_out.reserve(size_reserve);
-    }
-
-    hashed_map<int, int>::iterator res_i, res_j;
-    hashed_map<int, std::vector<int>>::iterator res_in, res_jn;
-    bool post_process = false;
-
-    if ((all_i || i_is_seq || i_is_rev_seq) && !j_has_duplicates) {
-
-        for (size_t ix = 0; ix < nnz; ix++)
-        {
-            if (ii[ix] >= min_i && ii[ix] <= max_i && jj[ix] >= min_j && jj[ix] <= max_j)
-            {
-                res_j = j_mapping.find(jj[ix]);
-                if (res_j != j_mapping.end())
-                {
-                    ii_out_[curr] = ii[ix];
-                    jj_out_[curr] = res_j->second;
-                    if (std::is_same<CompileFlag, bool>::value)
-                    xx_out_[curr] = xx[ix];
-                    curr++;
-                }
-            }
-        }
-
-        post_process = true;
+    for (int chunk = 0; chunk < nchunks; chunk++)
+        chunk_offsets[chunk + 1] += chunk_offsets[chunk];
+    const size_large total_size = chunk_offsets[nchunks];
+    if (total_size > (size_large)INT_MAX)
+        Rcpp::stop("Error: resulting matrix would be larger than INT_MAX limit.\n");
 
+    VectorConstructorArgs args;
+    args.as_integer = true; args.size = total_size;
+    Rcpp::IntegerVector ii_out = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    Rcpp::IntegerVector jj_out = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    RcppVector xx_out;
+    if (has_values)
+    {
+        args.as_integer = !std::is_same<RcppVector, Rcpp::NumericVector>::value;
+        args.as_logical = std::is_same<RcppVector, Rcpp::LogicalVector>::value;
+        xx_out = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
     }
-
-    else if ((all_j || j_is_seq || j_is_rev_seq) && !i_has_duplicates) {
-
-        for (size_t ix = 0; ix < nnz; ix++)
+    int *restrict ii_out_ = INTEGER(ii_out);
+    int *restrict jj_out_ = INTEGER(jj_out);
+    InputDType *restrict xx_out_ = has_values? (InputDType*)xx_out.begin() : nullptr;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nchunks) \
+            shared(ii_, jj_, xx_, i_mapping, j_mapping, chunk_offsets, ii_out_, jj_out_, xx_out_)
+    #endif
+    for (int chunk = 0; chunk < nchunks; chunk++)
+    {
+        const size_t st = (nnz * (size_t)chunk) / (size_t)nchunks;
+        const size_t end = (nnz * (size_t)(chunk + 1)) / (size_t)nchunks;
+        size_t curr = chunk_offsets[chunk];
+        int lo_i, hi_i, lo_j, hi_j;
+        for (size_t ix = st; ix < end; ix++)
         {
-            if (ii[ix] >= min_i && ii[ix] <= max_i && jj[ix] >= min_j && jj[ix] <= max_j)
+            i_mapping.lookup(ii_[ix], lo_i, hi_i);
+            if (lo_i == hi_i) continue;
+            j_mapping.lookup(jj_[ix], lo_j, hi_j);
+            for (int pos_i = lo_i; pos_i < hi_i; pos_i++)
             {
-                res_i = i_mapping.find(ii[ix]);
-                if (res_i != i_mapping.end())
+                for (int pos_j = lo_j; pos_j < hi_j; pos_j++)
                 {
-                    ii_out_[curr] = res_i->second;
-                    jj_out_[curr] = jj[ix];
-                    if (std::is_same<CompileFlag, bool>::value)
-                    xx_out_[curr] = xx[ix];
+                    ii_out_[curr] = i_mapping.position(pos_i);
+                    jj_out_[curr] = j_mapping.position(pos_j);
+                    if (has_values)
+                        xx_out_[curr] = xx_[ix];
                     curr++;
                 }
             }
         }
-
-        post_process = true;
-
-    }
-
-    else if (!i_has_duplicates && !j_has_duplicates) {
-        
-        for (size_t ix = 0; ix < nnz; ix++)
-        {
-            if (ii[ix] >= min_i && ii[ix] <= max_i && jj[ix] >= min_j && jj[ix] <= max_j)
-            {
-                res_i = i_mapping.find(ii[ix]);
-                if (res_i != i_mapping.end())
-                {
-                    res_j = j_mapping.find(jj[ix]);
-                    if (res_j != j_mapping.end())
-                    {
-                        ii_out_[curr] = res_i->second;
-                        jj_out_[curr] = res_j->second;
-                        if (std::is_same<CompileFlag, bool>::value)
-                        xx_out_[curr] = xx[ix];
-                        curr++;
-                    }
-                }
-            }
-        }
-
-    }
-
-    else if (!i_has_duplicates) {
-
-        if (all_i || i_is_seq || i_is_rev_seq)
-        {
-            post_process = true;
-            for (size_t ix = 0; ix < nnz; ix++)
-            {
-                if (ii[ix] >= min_i && ii[ix] <= max_i && jj[ix] >= min_j && jj[ix] <= max_j)
-                {
-                    res_jn = j_indices_rep.find(jj[ix]);
-                    if (res_jn != j_indices_rep.end())
-                    {
-                        for (auto el : res_jn->second)
-                        {
-                            ii_out.push_back(ii[ix]);
-                            jj_out.push_back(el);
-                            if (std::is_same<CompileFlag, bool>::value)
-                            xx_out.push_back(xx[ix]);
-                        }
-                    }
-                }
-            }
-        }
-
-        else
-        {
-            for (size_t ix = 0; ix < nnz; ix++)
-            {
-                if (ii[ix] >= min_i && ii[ix] <= max_i && jj[ix] >= min_j && jj[ix] <= max_j)
-                {
-                    res_i = i_mapping.find(ii[ix]);
-                    if (res_i != i_mapping.end())
-                    {
-                        res_jn = j_indices_rep.find(jj[ix]);
-                        if (res_jn != j_indices_rep.end())
-                        {
-                            for (auto el : res_jn->second)
-                            {
-                                ii_out.push_back(res_i->second);
-                                jj_out.push_back(el);
-                                if (std::is_same<CompileFlag, bool>::value)
-                                xx_out.push_back(xx[ix]);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    else if (!j_has_duplicates) {
-
-        if (all_j || j_is_seq || j_is_rev_seq)
-        {
-            post_process = true;
-            for (size_t ix = 0; ix < nnz; ix++)
-            {
-                if (ii[ix] >= min_i && ii[ix] <= max_i && jj[ix] >= min_j && jj[ix] <= max_j)
-                {
-                    res_in = i_indices_rep.find(ii[ix]);
-                    if (res_in != i_indices_rep.end())
-                    {
-                        for (auto el : res_in->second)
-                        {
-                            ii_out.push_back(el);
-                            jj_out.push_back(jj[ix]);
-                            if (std::is_same<CompileFlag, bool>::value)
-                            xx_out.push_back(xx[ix]);
-                        }
-                    }
-                }
-            }
-        }
-
-        else
-        {
-            for (size_t ix = 0; ix < nnz; ix++)
-            {
-                if (ii[ix] >= min_i && ii[ix] <= max_i && jj[ix] >= min_j && jj[ix] <= max_j)
-                {
-                    res_j = j_mapping.find(jj[ix]);
-                    if (res_j != j_mapping.end())
-                    {
-                        res_in = i_indices_rep.find(ii[ix]);
-                        if (res_in != i_indices_rep.end())
-                        {
-                            for (auto el : res_in->second)
-                            {
-                                ii_out.push_back(el);
-                                jj_out.push_back(res_j->second);
-                                if (std::is_same<CompileFlag, bool>::value)
-                                xx_out.push_back(xx[ix]);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
     }
 
-    else { /* both have duplicates */
-
-        for (size_t ix = 0; ix < nnz; ix++)
-        {
-            if (ii[ix] >= min_i && ii[ix] <= max_i && jj[ix] >= min_j && jj[ix] <= max_j)
-            {
-                res_in = i_indices_rep.find(ii[ix]);
-                if (res_in != i_indices_rep.end())
-                {
-                    res_jn = j_indices_rep.find(jj[ix]);
-                    if (res_jn != j_indices_rep.end())
-                    {
-                        for (auto el_i : res_in->second)
-                        {
-                            for (auto el_j : res_jn->second)
-                            {
-                                ii_out.push_back(el_i);
-                                jj_out.push_back(el_j);
-                                if (std::is_same<CompileFlag, bool>::value)
-                                xx_out.push_back(xx[ix]);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-    }
-
-
-    if (i_has_duplicates || j_has_duplicates)
-        curr = ii_out.size();
-
-
-    if (post_process)
-    {
-        if (!i_has_duplicates)
-            post_process_seq(
-                use_vectors? ii_out.data() : ii_out_.get(), curr,
-                all_i, i_is_seq, i_is_rev_seq,
-                first_i, last_i
-            );
-
-        if (!j_has_duplicates)
-            post_process_seq(
-                use_vectors? jj_out.data() : jj_out_.get(), curr,
-                all_j, j_is_seq, j_is_rev_seq,
-                first_j, last_j
-            );
-    }
-
-    VectorConstructorArgs args;
-    args.as_integer = true; args.as_logical = false;
-    args.size = curr; args.cpp_lim_size = true;
-
-    if (use_vectors) {
-        args.from_cpp_vec = true;
-        args.int_vec_from = &ii_out;
-    } else {
-        args.from_cpp_vec = false;
-        args.from_pointer = true;
-        args.int_pointer_from = ii_out_.get();
-    }
-    Rcpp::IntegerVector ii_out__ = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    ii_out.clear(); ii_out.shrink_to_fit(); ii_out_.reset();
-    args.int_vec_from = &jj_out; args.int_pointer_from = jj_out_.get();
-    Rcpp::IntegerVector jj_out__ = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    jj_out.clear(); jj_out.shrink_to_fit(); jj_out_.reset();
-    RcppVector xx_out__;
-    if (std::is_same<CompileFlag, bool>::value)
-    {
-        if (std::is_same<RcppVector, Rcpp::LogicalVector>::value) {
-            args.as_integer = true; args.as_logical = true;
-            if (use_vectors)
-                args.int_vec_from = &xx_out;
-            else
-                args.int_pointer_from = xx_out_.get();
-        }
-        else if (std::is_same<RcppVector, Rcpp::IntegerVector>::value) {
-            args.as_integer = true; args.as_logical = false;
-            if (use_vectors)
-                args.int_vec_from = &xx_out;
-            else
-                args.int_pointer_from = xx_out_.get();
-        }
-        else {
-            args.as_integer = false; args.as_logical = false;
-            if (use_vectors)
-                args.num_vec_from = &xx_out;
-            else
-                args.num_pointer_from = xx_out_.get();
-        }
-        xx_out__ = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
-    }
-
-
     return Rcpp::List::create(
-        Rcpp::_["ii"] = ii_out__,
-        Rcpp::_["jj"] = jj_out__,
-        Rcpp::_["xx"] = xx_out__
+        Rcpp::_["ii"] = ii_out,
+        Rcpp::_["jj"] = jj_out,
+        Rcpp::_["xx"] = xx_out
     );
 }
 
@@ -636,7 +324,8 @@ Rcpp::List slice_coo_arbitrary_numeric
     bool all_i, bool all_j,
     bool i_is_seq, bool j_is_seq,
     bool i_is_rev_seq, bool j_is_rev_seq,
-    int nrows, int ncols
+    int nrows, int ncols,
+    int nthreads
 )
 {
     return slice_coo_arbitrary_template<Rcpp::NumericVector, double, bool>(
@@ -648,7 +337,8 @@ Rcpp::List slice_coo_arbitrary_numeric
         all_i, all_j,
         i_is_seq, j_is_seq,
         i_is_rev_seq, j_is_rev_seq,
-        nrows, ncols
+        nrows, ncols,
+        nthreads
     );
 }
 
@@ -663,7 +353,8 @@ Rcpp::List slice_coo_arbitrary_logical
     bool all_i, bool all_j,
     bool i_is_seq, bool j_is_seq,
     bool i_is_rev_seq, bool j_is_rev_seq,
-    int nrows, int ncols
+    int nrows, int ncols,
+    int nthreads
 )
 {
     return slice_coo_arbitrary_template<Rcpp::LogicalVector, int, bool>(
@@ -675,7 +366,8 @@ Rcpp::List slice_coo_arbitrary_logical
         all_i, all_j,
         i_is_seq, j_is_seq,
         i_is_rev_seq, j_is_rev_seq,
-        nrows, ncols
+        nrows, ncols,
+        nthreads
     );
 }
 
@@ -689,7 +381,8 @@ Rcpp::List slice_coo_arbitrary_binary
     bool all_i, bool all_j,
     bool i_is_seq, bool j_is_seq,
     bool i_is_rev_seq, bool j_is_rev_seq,
-    int nrows, int ncols
+    int nrows, int ncols,
+    int nthreads
 )
 {
     return slice_coo_arbitrary_template<Rcpp::NumericVector, double, int>(
@@ -701,7 +394,8 @@ Rcpp::List slice_coo_arbitrary_binary
         all_i, all_j,
         i_is_seq, j_is_seq,
         i_is_rev_seq, j_is_rev_seq,
-        nrows, ncols
+        nrows, ncols,
+        nthreads
     );
 }
 
@@ -0,0 +1,79 @@
+#include "MatrixExtra.h"
+#ifndef _WIN32
+#   include <unistd.h>
+#endif
+
+/* Decides how many threads a kernel should actually use, given the number
+   that was requested through the package options and a measure of the work
+   that it would do (typically the number of multiply-adds).
+
+   Starting a parallel region has a fixed cost which is larger than the whole
+   computation for small inputs (e.g. scoring a single row), so the matrix
+   multiplication kernels define a minimum amount of work per thread below
+   which it doesn't pay off to add more threads. These minimums can be scaled
+   (e.g. after calibrating them for a given machine, see
+   'calibrate_serial_cutoffs').
+
+   Independently of the work size, a single thread is used when called from
+   inside an OpenMP parallel region (which would otherwise oversubscribe the
+   CPU), or from a process that was forked from the one that loaded the library
+   (e.g. 'parallel::mclapply'), since each fork already runs in parallel with
+   the others, and the OpenMP runtime is not guaranteed to work after a fork if
+   the parent process had already used it. This part applies to all of the
+   kernels, as the R code obtains the number of threads to pass to any of them
+   through 'restrict_nthreads' (see 'get_nthreads'). */
+
+static double serial_cutoff_scale = 1.0;
+
+#ifndef _WIN32
+static const pid_t pid_at_load = getpid();
+#endif
+
+static bool is_forked_process()
+{
+    #ifndef _WIN32
+    return getpid() != pid_at_load;
+    #else
+    return false;
+    #endif
+}
+
+int get_effective_nthreads(int nthreads, const double work, const double min_work_per_thread)
+{
+    if (nthreads <= 1)
+        return 1;
+    if (omp_in_parallel() || is_forked_process())
+        return 1;
+    const double min_work = min_work_per_thread * serial_cutoff_scale;
+    if (min_work > 0 && work < min_work * (double)nthreads)
+        nthreads = (int)std::max(1., std::floor(work / min_work));
+    return nthreads;
+}
+
+/* Without passing a work size, this only applies the restrictions that do not
+   depend on it (parallel regions and forks). */
+// [[Rcpp::export(rng = false)]]
+int restrict_nthreads(int nthreads, double work = 0, double min_work_per_thread = 0)
+{
+    return get_effective_nthreads(nthreads, work, min_work_per_thread);
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List get_serial_cutoffs_cpp()
+{
+    return Rcpp::List::create(
+        Rcpp::_["scale"] = Rcpp::wrap(serial_cutoff_scale),
+        Rcpp::_["min_work_per_thread_gemm"] = Rcpp::wrap(min_work_per_thread_gemm),
+        Rcpp::_["min_work_per_thread_sddmm"] = Rcpp::wrap(min_work_per_thread_sddmm),
+        Rcpp::_["min_work_per_thread_matvec"] = Rcpp::wrap(min_work_per_thread_matvec),
+        Rcpp::_["min_work_per_thread_spgemm"] = Rcpp::wrap(min_work_per_thread_spgemm)
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+void set_serial_cutoff_scale_cpp(double scale)
+{
+    if (ISNAN(scale) || scale < 0)
+        Rcpp::stop("Invalid cutoff scale.");
+    serial_cutoff_scale = scale;
+}
@@ -0,0 +1,675 @@
+#include "MatrixExtra.h"
+
+/* Transposes a CSR matrix into CSR (equivalently, a CSC matrix into CSC, or
+   converts between CSR and CSC of the same matrix), through a counting sort
+   of the column indices:
+    - Histogram of the indices (number of entries per column).
+    - Cumulative sum of the histogram, which becomes the output 'indptr'.
+    - Scatter of the entries into their positions in the output.
+
+   When using multiple threads, the rows are divided into contiguous blocks
+   with roughly the same number of non-zeros, and each thread keeps its own
+   histogram, which after the cumulative sum will hold the starting position
+   of each column for that block. Since the rows are traversed in order, the
+   output will have its indices sorted, regardless of whether the input's
+   indices were sorted or not.
+
+   If the matrix is binary, 'values' should be passed as NULL. */
+template <class RcppVector, class InputDType>
+Rcpp::List transpose_csr
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    const InputDType *restrict values,
+    const int ncols,
+    int nthreads
+)
+{
+    profile_kernel("transpose_csr");
+    const int nrows = indptr.size() - 1;
+    const int *restrict indptr_in = INTEGER(indptr);
+    const int *restrict indices_in = INTEGER(indices);
+    const size_t nnz = (nrows > 0)? indptr_in[nrows] : 0;
+
+    Rcpp::IntegerVector out_indptr(ncols+1);
+    profile_count_allocation(out_indptr);
+    int *restrict indptr_out = INTEGER(out_indptr);
+
+    VectorConstructorArgs args;
+    args.as_integer = true; args.size = nnz;
+    Rcpp::IntegerVector out_indices = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    RcppVector out_values;
+    if (values) {
+        args.as_integer = std::is_same<InputDType, int>::value;
+        args.as_logical = std::is_same<RcppVector, Rcpp::LogicalVector>::value;
+        out_values = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    }
+    int *restrict indices_out = INTEGER(out_indices);
+    InputDType *restrict values_out = nullptr;
+    if (values)
+        values_out = std::is_same<InputDType, double>::value?
+            (InputDType*)REAL(out_values) : (InputDType*)LOGICAL(out_values);
+
+    if (!nnz || ncols <= 0)
+        goto output;
+
+    {
+    /* Per-thread histograms take memory proportional to 'ncols', so
+       when the matrix is very wide compared to its number of non-zeros,
+       it's better to use fewer threads. */
+    nthreads = std::max(1, std::min(nthreads, nrows));
+    if (nthreads > 1 && (size_t)nthreads * (size_t)ncols > 4 * nnz)
+        nthreads = std::max((size_t)1, (4 * nnz) / (size_t)ncols);
+
+    std::unique_ptr<int[]> row_st(new int[nthreads+1]);
+    row_st[0] = 0;
+    row_st[nthreads] = nrows;
+    for (int tid = 1; tid < nthreads; tid++)
+    {
+        const int nnz_st = (int)(((size_large)nnz * (size_large)tid) / (size_large)nthreads);
+        row_st[tid] = std::lower_bound(indptr_in, indptr_in + nrows, nnz_st) - indptr_in;
+        row_st[tid] = std::max(row_st[tid], row_st[tid-1]);
+    }
+
+    std::unique_ptr<int[]> counts(new int[(size_t)nthreads * (size_t)ncols]());
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+            shared(indptr_in, indices_in, counts, row_st)
+    #endif
+    for (int tid = 0; tid < nthreads; tid++)
+    {
+        int *restrict counts_this = counts.get() + (size_t)tid * (size_t)ncols;
+        for (int ix = indptr_in[row_st[tid]]; ix < indptr_in[row_st[tid+1]]; ix++)
+            counts_this[indices_in[ix]]++;
+    }
+
+    if (nthreads == 1)
+    {
+        int *restrict counts_this = counts.get();
+        for (int col = 0; col < ncols; col++)
+        {
+            indptr_out[col+1] = indptr_out[col] + counts_this[col];
+            counts_this[col] = indptr_out[col];
+        }
+    }
+
+    else
+    {
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) num_threads(nthreads) \
+                shared(counts, indptr_out)
+        #endif
+        for (int col = 0; col < ncols; col++)
+        {
+            int total = 0;
+            for (int tid = 0; tid < nthreads; tid++)
+                total += counts[(size_t)tid * (size_t)ncols + (size_t)col];
+            indptr_out[col+1] = total;
+        }
+
+        for (int col = 0; col < ncols; col++)
+            indptr_out[col+1] += indptr_out[col];
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) num_threads(nthreads) \
+                shared(counts, indptr_out)
+        #endif
+        for (int col = 0; col < ncols; col++)
+        {
+            int curr = indptr_out[col];
+            for (int tid = 0; tid < nthreads; tid++)
+            {
+                const size_t ix = (size_t)tid * (size_t)ncols + (size_t)col;
+                const int n_this = counts[ix];
+                counts[ix] = curr;
+                curr += n_this;
+            }
+        }
+    }
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+            shared(indptr_in, indices_in, values, counts, row_st, indices_out, values_out)
+    #endif
+    for (int tid = 0; tid < nthreads; tid++)
+    {
+        int *restrict counts_this = counts.get() + (size_t)tid * (size_t)ncols;
+        for (int row = row_st[tid]; row < row_st[tid+1]; row++)
+        {
+            for (int ix = indptr_in[row]; ix < indptr_in[row+1]; ix++)
+            {
+                const int pos = counts_this[indices_in[ix]]++;
+                indices_out[pos] = row;
+                if (values) values_out[pos] = values[ix];
+            }
+        }
+    }
+    }
+
+    output:
+    if (values)
+        return Rcpp::List::create(
+            Rcpp::_["indptr"] = out_indptr,
+            Rcpp::_["indices"] = out_indices,
+            Rcpp::_["values"] = out_values
+        );
+    else
+        return Rcpp::List::create(
+            Rcpp::_["indptr"] = out_indptr,
+            Rcpp::_["indices"] = out_indices
+        );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List transpose_csr_numeric
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    Rcpp::NumericVector values,
+    const int ncols,
+    int nthreads
+)
+{
+    return transpose_csr<Rcpp::NumericVector, double>(
+        indptr,
+        indices,
+        REAL(values),
+        ncols,
+        nthreads
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List transpose_csr_logical
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    Rcpp::LogicalVector values,
+    const int ncols,
+    int nthreads
+)
+{
+    return transpose_csr<Rcpp::LogicalVector, int>(
+        indptr,
+        indices,
+        LOGICAL(values),
+        ncols,
+        nthreads
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List transpose_csr_binary
+(
+    Rcpp::IntegerVector indptr,
+    Rcpp::IntegerVector indices,
+    const int ncols,
+    int nthreads
+)
+{
+    return transpose_csr<Rcpp::LogicalVector, int>(
+        indptr,
+        indices,
+        (int*)nullptr,
+        ncols,
+        nthreads
+    );
+}
+
+/* Converts a COO matrix into CSR with sorted indices, combining the entries
+   that have the same row and column, in a counting-sort fashion like the
+   transpose above:
+    - Histogram of the row indices, computed on contiguous blocks of the
+      entries by each thread.
+    - Cumulative sum and scatter of the entries into their rows, keeping
+      the same order in which they appear in the input.
+    - Sorting of the entries within each row by column, after which the
+      duplicates are contiguous and get combined by either summing them
+      (logical values are combined through an OR), or by taking the one that
+      comes last in the input. If passing 'drop_zeros', entries that are
+      (or sum to) zero are removed at this point.
+    - Compaction of the rows into the output arrays.
+
+   Row and column indices are zero-based. If the matrix is binary, 'values'
+   should be passed as NULL. */
+template <class RcppVector, class InputDType>
+Rcpp::List coo_to_csr
+(
+    Rcpp::IntegerVector ii,
+    Rcpp::IntegerVector jj,
+    const InputDType *restrict values,
+    const int nrows,
+    const bool sum_duplicates,
+    const bool drop_zeros,
+    int nthreads
+)
+{
+    profile_kernel("coo_to_csr");
+    const size_t nnz = ii.size();
+    const int *restrict ii_in = INTEGER(ii);
+    const int *restrict jj_in = INTEGER(jj);
+    const bool is_logical = std::is_same<RcppVector, Rcpp::LogicalVector>::value;
+    const int nthreads_rows = std::max(1, std::min(nthreads, nrows));
+
+    Rcpp::IntegerVector out_indptr(nrows+1);
+    profile_count_allocation(out_indptr);
+    int *restrict indptr_out = INTEGER(out_indptr);
+    std::unique_ptr<int[]> row_st(new int[nrows+1]());
+    std::unique_ptr<int[]> indices_temp(new int[nnz]);
+    std::unique_ptr<InputDType[]> values_temp(values? new InputDType[nnz] : nullptr);
+
+    if (nnz && nrows > 0)
+    {
+        nthreads = std::max(1, std::min(nthreads, (int)std::min(nnz, (size_t)INT_MAX)));
+        if (nthreads > 1 && (size_t)nthreads * (size_t)nrows > 4 * nnz)
+            nthreads = std::max((size_t)1, (4 * nnz) / (size_t)nrows);
+
+        std::unique_ptr<int[]> counts(new int[(size_t)nthreads * (size_t)nrows]());
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+                shared(ii_in, counts)
+        #endif
+        for (int tid = 0; tid < nthreads; tid++)
+        {
+            int *restrict counts_this = counts.get() + (size_t)tid * (size_t)nrows;
+            const size_t st = (nnz * (size_t)tid) / (size_t)nthreads;
+            const size_t end = (nnz * (size_t)(tid+1)) / (size_t)nthreads;
+            for (size_t ix = st; ix < end; ix++)
+                counts_this[ii_in[ix]]++;
+        }
+
+        /* After this, 'row_st' holds the positions at which each row starts
+           in the temporary arrays, and 'counts' the positions at which each
+           thread starts writing its part of each row. */
+        for (int row = 0; row < nrows; row++)
+        {
+            int curr = row_st[row];
+            for (int tid = 0; tid < nthreads; tid++)
+            {
+                const size_t ix = (size_t)tid * (size_t)nrows + (size_t)row;
+                const int n_this = counts[ix];
+                counts[ix] = curr;
+                curr += n_this;
+            }
+            row_st[row+1] = curr;
+        }
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+                shared(ii_in, jj_in, values, counts, indices_temp, values_temp)
+        #endif
+        for (int tid = 0; tid < nthreads; tid++)
+        {
+            int *restrict counts_this = counts.get() + (size_t)tid * (size_t)nrows;
+            const size_t st = (nnz * (size_t)tid) / (size_t)nthreads;
+            const size_t end = (nnz * (size_t)(tid+1)) / (size_t)nthreads;
+            for (size_t ix = st; ix < end; ix++)
+            {
+                const int pos = counts_this[ii_in[ix]]++;
+                indices_temp[pos] = jj_in[ix];
+                if (values) values_temp[pos] = values[ix];
+            }
+        }
+
+        #ifdef _OPENMP
+        #pragma omp parallel num_threads(nthreads_rows) \
+                shared(row_st, indices_temp, values_temp, indptr_out)
+        #endif
+        {
+            std::vector<std::pair<int, int>> row_entries;
+            std::vector<InputDType> row_values;
+
+            #ifdef _OPENMP
+            #pragma omp for schedule(dynamic, 64)
+            #endif
+            for (int row = 0; row < nrows; row++)
+            {
+                const int n_this = row_st[row+1] - row_st[row];
+                int *restrict indices_this = indices_temp.get() + row_st[row];
+                InputDType *restrict values_this = values? values_temp.get() + row_st[row] : nullptr;
+
+                bool is_sorted = true;
+                for (int ix = 1; ix < n_this; ix++)
+                {
+                    if (indices_this[ix] <= indices_this[ix-1])
+                    {
+                        is_sorted = false;
+                        break;
+                    }
+                }
+
+                int n_out = 0;
+                if (is_sorted)
+                {
+                    if (!drop_zeros || !values)
+                    {
+                        n_out = n_this;
+                    }
+
+                    else
+                    {
+                        for (int ix = 0; ix < n_this; ix++)
+                        {
+                            if (values_this[ix] != 0)
+                            {
+                                indices_this[n_out] = indices_this[ix];
+                                values_this[n_out] = values_this[ix];
+                                n_out++;
+                            }
+                        }
+                    }
+                    indptr_out[row+1] = n_out;
+                    continue;
+                }
+
+                /* The entries are in the same order as in the input, so using
+                   the position as tie-breaker leaves the last duplicate last. */
+                row_entries.resize(n_this);
+                for (int ix = 0; ix < n_this; ix++)
+                    row_entries[ix] = {indices_this[ix], ix};
+                std::sort(row_entries.begin(), row_entries.end());
+                if (values)
+                    row_values.assign(values_this, values_this + n_this);
+
+                int ix = 0;
+                while (ix < n_this)
+                {
+                    const int col = row_entries[ix].first;
+                    InputDType val = values? row_values[row_entries[ix].second] : (InputDType)1;
+                    for (ix++; ix < n_this && row_entries[ix].first == col; ix++)
+                    {
+                        if (!values)
+                            continue;
+                        const InputDType val_next = row_values[row_entries[ix].second];
+                        if (!sum_duplicates)
+                            val = val_next;
+                        else if (!is_logical)
+                            val += val_next;
+                        else if (val != (InputDType)true)
+                        {
+                            if (val_next == NA_LOGICAL)
+                                val = NA_LOGICAL;
+                            else if (val_next)
+                                val = true;
+                        }
+                    }
+
+                    if (drop_zeros && values && val == 0)
+                        continue;
+                    indices_this[n_out] = col;
+                    if (values) values_this[n_out] = val;
+                    n_out++;
+                }
+                indptr_out[row+1] = n_out;
+            }
+        }
+
+        for (int row = 0; row < nrows; row++)
+            indptr_out[row+1] += indptr_out[row];
+    }
+
+    const size_t nnz_out = (nrows > 0)? indptr_out[nrows] : 0;
+    VectorConstructorArgs args;
+    args.as_integer = true; args.size = nnz_out;
+    Rcpp::IntegerVector out_indices = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    RcppVector out_values;
+    if (values) {
+        args.as_integer = std::is_same<InputDType, int>::value;
+        args.as_logical = is_logical;
+        out_values = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    }
+    int *restrict indices_out = INTEGER(out_indices);
+    InputDType *restrict values_out = nullptr;
+    if (values)
+        values_out = std::is_same<InputDType, double>::value?
+            (InputDType*)REAL(out_values) : (InputDType*)LOGICAL(out_values);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads_rows) \
+            shared(row_st, indptr_out, indices_temp, values_temp, indices_out, values_out)
+    #endif
+    for (int row = 0; row < nrows; row++)
+    {
+        const int n_this = indptr_out[row+1] - indptr_out[row];
+        std::copy(indices_temp.get() + row_st[row],
+                  indices_temp.get() + row_st[row] + n_this,
+                  indices_out + indptr_out[row]);
+        if (values)
+            std::copy(values_temp.get() + row_st[row],
+                      values_temp.get() + row_st[row] + n_this,
+                      values_out + indptr_out[row]);
+    }
+
+    if (values)
+        return Rcpp::List::create(
+            Rcpp::_["indptr"] = out_indptr,
+            Rcpp::_["indices"] = out_indices,
+            Rcpp::_["values"] = out_values
+        );
+    else
+        return Rcpp::List::create(
+            Rcpp::_["indptr"] = out_indptr,
+            Rcpp::_["indices"] = out_indices
+        );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List coo_to_csr_numeric
+(
+    Rcpp::IntegerVector ii,
+    Rcpp::IntegerVector jj,
+    Rcpp::NumericVector values,
+    const int nrows,
+    const bool sum_duplicates,
+    const bool drop_zeros,
+    int nthreads
+)
+{
+    return coo_to_csr<Rcpp::NumericVector, double>(
+        ii,
+        jj,
+        REAL(values),
+        nrows,
+        sum_duplicates,
+        drop_zeros,
+        nthreads
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List coo_to_csr_logical
+(
+    Rcpp::IntegerVector ii,
+    Rcpp::IntegerVector jj,
+    Rcpp::LogicalVector values,
+    const int nrows,
+    const bool sum_duplicates,
+    const bool drop_zeros,
+    int nthreads
+)
+{
+    return coo_to_csr<Rcpp::LogicalVector, int>(
+        ii,
+        jj,
+        LOGICAL(values),
+        nrows,
+        sum_duplicates,
+        drop_zeros,
+        nthreads
+    );
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List coo_to_csr_binary
+(
+    Rcpp::IntegerVector ii,
+    Rcpp::IntegerVector jj,
+    const int nrows,
+    int nthreads
+)
+{
+    return coo_to_csr<Rcpp::LogicalVector, int>(
+        ii,
+        jj,
+        (int*)nullptr,
+        nrows,
+        true,
+        false,
+        nthreads
+    );
+}
+
+/* Converts a dense column-major matrix into CSR, in two passes over the
+   input: one to count the non-zeros in each row, and one to fill the
+   indices and values. Each thread handles a contiguous block of rows,
+   going over the columns in order (so the indices come out sorted), which
+   makes it read a contiguous piece of each column.
+
+   Entries that are NA/NaN are non-zero and are kept in the output. If
+   the output is binary, 'OutputDType' is irrelevant and the values are
+   not filled. */
+template <class RcppVector, class InputDType, class OutputDType>
+Rcpp::List dense_to_csr
+(
+    const InputDType *restrict X,
+    const int nrows,
+    const int ncols,
+    const bool binary,
+    int nthreads
+)
+{
+    profile_kernel("dense_to_csr");
+    const bool output_logical = std::is_same<RcppVector, Rcpp::LogicalVector>::value;
+    Rcpp::IntegerVector out_indptr(nrows+1);
+    profile_count_allocation(out_indptr);
+    int *restrict indptr_out = INTEGER(out_indptr);
+    nthreads = std::max(1, std::min(nthreads, nrows));
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+            shared(X, indptr_out)
+    #endif
+    for (int tid = 0; tid < nthreads; tid++)
+    {
+        const int row_st = (int)(((size_large)nrows * (size_large)tid) / (size_large)nthreads);
+        const int row_end = (int)(((size_large)nrows * (size_large)(tid+1)) / (size_large)nthreads);
+        int *restrict counts = indptr_out + 1;
+        for (int col = 0; col < ncols; col++)
+        {
+            const InputDType *restrict X_col = X + (size_t)col * (size_t)nrows;
+            for (int row = row_st; row < row_end; row++)
+                counts[row] += X_col[row] != 0;
+        }
+    }
+
+    size_large nnz = 0;
+    for (int row = 0; row < nrows; row++)
+    {
+        nnz += indptr_out[row+1];
+        if (nnz >= (size_large)INT_MAX)
+            Rcpp::stop("Error: resulting matrix would have too many entries for a sparse CSR representation (int overflow).");
+        indptr_out[row+1] = (int)nnz;
+    }
+
+    VectorConstructorArgs args;
+    args.as_integer = true; args.size = nnz;
+    Rcpp::IntegerVector out_indices = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    RcppVector out_values;
+    if (!binary) {
+        args.as_integer = output_logical;
+        args.as_logical = output_logical;
+        out_values = Rcpp::unwindProtect(SafeRcppVector, (void*)&args);
+    }
+    int *restrict indices_out = INTEGER(out_indices);
+    OutputDType *restrict values_out = nullptr;
+    if (!binary)
+        values_out = output_logical? (OutputDType*)LOGICAL(out_values) : (OutputDType*)REAL(out_values);
+
+    if (nnz)
+    {
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static, 1) num_threads(nthreads) \
+                shared(X, indptr_out, indices_out, values_out)
+        #endif
+        for (int tid = 0; tid < nthreads; tid++)
+        {
+            const int row_st = (int)(((size_large)nrows * (size_large)tid) / (size_large)nthreads);
+            const int row_end = (int)(((size_large)nrows * (size_large)(tid+1)) / (size_large)nthreads);
+            std::unique_ptr<int[]> pos(new int[row_end - row_st]);
+            std::copy(indptr_out + row_st, indptr_out + row_end, pos.get());
+            int *restrict pos_this = pos.get() - row_st;
+
+            for (int col = 0; col < ncols; col++)
+            {
+                const InputDType *restrict X_col = X + (size_t)col * (size_t)nrows;
+                for (int row = row_st; row < row_end; row++)
+                {
+                    const InputDType val = X_col[row];
+                    if (val == 0) continue;
+                    const int ix = pos_this[row]++;
+                    indices_out[ix] = col;
+                    if (binary) continue;
+
+                    if (std::is_same<InputDType, double>::value)
+                    {
+                        if (output_logical)
+                            values_out[ix] = ISNAN((double)val)? NA_LOGICAL : (OutputDType)true;
+                        else
+                            values_out[ix] = val;
+                    }
+
+                    else
+                    {
+                        if (val == NA_INTEGER)
+                            values_out[ix] = output_logical? (OutputDType)NA_LOGICAL : (OutputDType)NA_REAL;
+                        else
+                            values_out[ix] = output_logical? (OutputDType)true : (OutputDType)val;
+                    }
+                }
+            }
+        }
+    }
+
+    if (!binary)
+        return Rcpp::List::create(
+            Rcpp::_["indptr"] = out_indptr,
+            Rcpp::_["indices"] = out_indices,
+            Rcpp::_["values"] = out_values
+        );
+    else
+        return Rcpp::List::create(
+            Rcpp::_["indptr"] = out_indptr,
+            Rcpp::_["indices"] = out_indices
+        );
+}
+
+/* Input is a base R matrix of type numeric, integer, or logical. Integer
+   inputs are converted to numeric in the output. */
+// [[Rcpp::export(rng = false)]]
+Rcpp::List dense_to_csr_numeric(SEXP X, const int nrows, const int ncols, int nthreads)
+{
+    if (TYPEOF(X) == REALSXP)
+        return dense_to_csr<Rcpp::NumericVector, double, double>(REAL(X), nrows, ncols, false, nthreads);
+    else
+        return dense_to_csr<Rcpp::NumericVector, int, double>(INTEGER(X), nrows, ncols, false, nthreads);
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List dense_to_csr_logical(SEXP X, const int nrows, const int ncols, int nthreads)
+{
+    if (TYPEOF(X) == REALSXP)
+        return dense_to_csr<Rcpp::LogicalVector, double, int>(REAL(X), nrows, ncols, false, nthreads);
+    else
+        return dense_to_csr<Rcpp::LogicalVector, int, int>(INTEGER(X), nrows, ncols, false, nthreads);
+}
+
+// [[Rcpp::export(rng = false)]]
+Rcpp::List dense_to_csr_binary(SEXP X, const int nrows, const int ncols, int nthreads)
+{
+    if (TYPEOF(X) == REALSXP)
+        return dense_to_csr<Rcpp::LogicalVector, double, int>(REAL(X), nrows, ncols, true, nthreads);
+    else
+        return dense_to_csr<Rcpp::LogicalVector, int, int>(INTEGER(X), nrows, ncols, true, nthreads);
+}